@@ -0,0 +1,49 @@
+#include "bench.hpp"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// Replaces the global allocation functions for the whole process, the zmath shared library included.
+// new[] goes through operator new, and the default memory resource Matrix buffers come from uses the aligned
+// form, so every Matrix buffer and std::vector growth is counted.
+static std::atomic<unsigned long> allocations{0};
+
+void *operator new(std::size_t size)
+{
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	if (void *ptr = std::malloc(size ? size : 1))
+		return ptr;
+	throw std::bad_alloc();
+}
+void *operator new(std::size_t size, std::align_val_t alignment)
+{
+	allocations.fetch_add(1, std::memory_order_relaxed);
+	size_t align = static_cast<size_t>(alignment);
+	// aligned_alloc wants a multiple of the alignment
+	if (void *ptr = std::aligned_alloc(align, ((size ? size : 1) + align - 1) / align * align))
+		return ptr;
+	throw std::bad_alloc();
+}
+void operator delete(void *ptr) noexcept
+{
+	std::free(ptr);
+}
+void operator delete(void *ptr, std::size_t) noexcept
+{
+	std::free(ptr);
+}
+void operator delete(void *ptr, std::align_val_t) noexcept
+{
+	std::free(ptr);
+}
+void operator delete(void *ptr, std::size_t, std::align_val_t) noexcept
+{
+	std::free(ptr);
+}
+
+namespace ZMathLib_Graphics::Bench {
+unsigned long allocation_count()
+{
+	return allocations.load(std::memory_order_relaxed);
+}
+}
@@ -0,0 +1,112 @@
+#ifndef BENCH_HPP
+#define BENCH_HPP
+
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+namespace ZMathLib_Graphics::Bench {
+	// Number of operator new / new[] calls made so far, counted in bench/allocations.cpp
+	unsigned long allocation_count();
+
+	// Keeps the compiler from optimizing away a result that is otherwise unused
+	template <typename T>
+	inline void keep(T const &value)
+	{
+		asm volatile("" : : "r,m"(value) : "memory");
+	}
+
+	struct Measurement {
+		double seconds;
+		double allocations;
+	};
+
+	// Calls func() repeatedly until at least minSeconds have passed, returns the average time and allocations per call
+	template <typename F>
+	Measurement measure(F &&func, double minSeconds = 0.25)
+	{
+		using Clock = std::chrono::steady_clock;
+		// warm up caches and the allocator
+		func();
+		unsigned long calls = 0;
+		unsigned long allocationsBefore = allocation_count();
+		Clock::time_point start = Clock::now();
+		double elapsed = 0;
+		// growing batches between clock reads, so reading the clock doesn't dominate nanosecond-scale operations
+		unsigned long batch = 1;
+		do {
+			for (unsigned long i = 0; i < batch; ++i)
+				func();
+			calls += batch;
+			batch = batch < 4096 ? batch * 2 : batch;
+			elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+		} while (elapsed < minSeconds);
+		return Measurement{ elapsed / calls, (double) (allocation_count() - allocationsBefore) / calls };
+	}
+
+	// Calls func() repeatedly until at least minSeconds have passed, returns the average seconds per call
+	template <typename F>
+	double seconds_per_call(F &&func, double minSeconds = 0.25)
+	{
+		return measure(func, minSeconds).seconds;
+	}
+
+	// Per-operation suite: one ns/op and allocs/op row per operation and size, printed as a table,
+	// and optionally collected for JSON output
+	struct Suite {
+		double minSeconds = 0.02;
+		// only run operations whose name contains this
+		std::string filter;
+		bool printTable = true;
+
+		struct Result {
+			std::string op;
+			unsigned int size;
+			double nsPerOp;
+			double allocsPerOp;
+		};
+		std::vector<Result> results;
+
+		template <typename F>
+		void run(std::string const &op, unsigned int size, F &&func)
+		{
+			if (!filter.empty() && op.find(filter) == std::string::npos)
+				return;
+			Measurement m = measure(func, minSeconds);
+			results.push_back(Result{ op, size, m.seconds * 1e9, m.allocations });
+			if (printTable)
+				printf("%-44s %8u %14.1f %10.2f\n", op.c_str(), size, m.seconds * 1e9, m.allocations);
+		}
+		void print_header() const
+		{
+			if (printTable)
+				printf("%-44s %8s %14s %10s\n", "op", "size", "ns/op", "allocs/op");
+		}
+		// {"mathtype_bytes": 4, "results": [{"op": ..., "size": ..., "ns_per_op": ..., "allocs_per_op": ...}, ...]}
+		// with one result per line, so runs can be diffed or loaded with any JSON tool
+		void write_json(FILE *out) const;
+	};
+
+	void bench_ops(Suite &suite);
+
+	void bench_gemm();
+	void bench_elementwise();
+	void bench_determinant();
+	void bench_inverse();
+	void bench_transform();
+	void bench_soa();
+	void bench_slerp();
+	void bench_memory();
+	void bench_layout();
+	void bench_io();
+	void bench_strassen();
+	void bench_sparse();
+	void bench_packed();
+	void bench_lstsq();
+	void bench_eigen();
+	// scaling from 1 to maxThreads threads
+	void bench_threads(unsigned int maxThreads);
+}
+
+#endif
@@ -0,0 +1,56 @@
+#include "bench.hpp"
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+namespace ZMathLib_Graphics::Bench {
+static MATHTYPE rand_cell(unsigned int, unsigned int, MATHTYPE)
+{
+	return 2 * (MATHTYPE) rand() / RAND_MAX - 1;
+}
+
+// The previous Matrix::determinant(): Laplace expansion with a heap-allocated minor per level
+static MATHTYPE reference_determinant(Matrix const &mtx)
+{
+	if (mtx.width == 1)
+		return mtx.get(0, 0);
+	if (mtx.width == 2)
+		return mtx.get(0, 0) * mtx.get(1, 1) - mtx.get(1, 0) * mtx.get(0, 1);
+	int sign = 1;
+	MATHTYPE ret = 0;
+	for (unsigned int x = 0; x < mtx.width; ++x) {
+		MATHTYPE multiplier = sign * mtx.get(x, 0);
+		sign = -sign;
+		if (multiplier == 0)
+			continue;
+		Matrix sub(mtx.width - 1, mtx.height - 1);
+		for (unsigned int sy = 1; sy < mtx.height; ++sy)
+			for (unsigned int sx = 0, i = 0; sx < mtx.width; ++sx)
+				if (sx != x)
+					sub.set(i++, sy - 1, mtx.get(sx, sy));
+		ret += multiplier * reference_determinant(sub);
+	}
+	return ret;
+}
+
+void bench_determinant()
+{
+	printf("%-10s %14s %14s %14s\n", "det n", "ns", "previous ns", "lu() ns");
+	for (unsigned int n : {2u, 3u, 4u, 5u, 8u, 9u, 16u, 64u, 128u, 256u, 512u}) {
+		Matrix mtx(n);
+		mtx.map_cells(rand_cell);
+		volatile MATHTYPE sink = 0;
+		double current = seconds_per_call([&] { sink = mtx.determinant(); });
+		double factorize = seconds_per_call([&] { sink = mtx.lu().determinant(); });
+		printf("%-10u %14.0f", n, current * 1e9);
+		// factorial time, 10x10 already takes seconds
+		if (n <= 9)
+			printf(" %14.0f", seconds_per_call([&] { sink = reference_determinant(mtx); }) * 1e9);
+		else
+			printf(" %14s", "-");
+		printf(" %14.0f\n", factorize * 1e9);
+		(void) sink;
+	}
+}
+}
@@ -0,0 +1,53 @@
+#include "bench.hpp"
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include "matrix_threads.hpp"
+#include "static_matrix.hpp"
+#include "vector.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace ZMathLib_Graphics::Bench {
+static MATHTYPE rand_cell(unsigned int, unsigned int, MATHTYPE)
+{
+	return 2 * (MATHTYPE) rand() / RAND_MAX - 1;
+}
+
+// Symmetric 3x3 eigen decompositions in nanoseconds per matrix over a batch of 2^20: the closed form for values
+// only and with vectors, on one thread and on the pool, against Jacobi through Matrix::eigen_symmetric().
+// Then Jacobi on n x n in milliseconds.
+void bench_eigen()
+{
+	size_t const count = 1 << 20;
+	std::vector<Matrix3> matrices(count);
+	for (Matrix3 &mtx : matrices)
+		for (unsigned int y = 0; y < 3; ++y)
+			for (unsigned int x = 0; x <= y; ++x)
+				mtx(x, y) = mtx(y, x) = rand_cell(0, 0, 0);
+	std::vector<Vec3> values(count), vectors(3 * count);
+
+	printf("%-10s %14s %14s %14s\n", "3x3", "1 thread", "pool", "jacobi");
+	unsigned int threads = thread_count();
+	auto per_matrix = [&](auto &&func) {
+		return seconds_per_call(func) * 1e9 / count;
+	};
+	set_thread_count(1);
+	double valuesSingle = per_matrix([&] { eigen_symmetric3(matrices, values); keep(values.data()); });
+	double vectorsSingle = per_matrix([&] { eigen_symmetric3(matrices, values, vectors); keep(vectors.data()); });
+	set_thread_count(threads);
+	double valuesPool = per_matrix([&] { eigen_symmetric3(matrices, values); keep(values.data()); });
+	double vectorsPool = per_matrix([&] { eigen_symmetric3(matrices, values, vectors); keep(vectors.data()); });
+	Matrix dense = matrices[0].to_matrix();
+	double jacobi = seconds_per_call([&] { keep(dense.eigen_symmetric()); }) * 1e9;
+	printf("%-10s %14.2f %14.2f %14.2f\n", "values", valuesSingle, valuesPool, jacobi);
+	printf("%-10s %14.2f %14.2f %14.2f\n", "vectors", vectorsSingle, vectorsPool, jacobi);
+
+	printf("%-10s %14s\n", "n", "jacobi");
+	for (unsigned int n : {32u, 128u}) {
+		Matrix cells = Matrix(n).mapped_cells(rand_cell);
+		Matrix symmetric = cells + cells.transposed();
+		printf("%-10u %14.3f\n", n, seconds_per_call([&] { keep(symmetric.eigen_symmetric()); }) * 1e3);
+	}
+}
+}
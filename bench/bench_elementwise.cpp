@@ -0,0 +1,46 @@
+#include "bench.hpp"
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+
+namespace ZMathLib_Graphics::Bench {
+static MATHTYPE rand_cell(unsigned int, unsigned int, MATHTYPE)
+{
+	return (MATHTYPE) rand() / RAND_MAX;
+}
+
+// The previous Matrix + Matrix: copy-free, but column-major traversal of a row-major buffer
+static Matrix reference_add(Matrix const &a, Matrix const &b)
+{
+	Matrix ret(a.width, a.height);
+	MATHTYPE *out = ret.data();
+	MATHTYPE const *pa = a.data();
+	MATHTYPE const *pb = b.data();
+	for (unsigned int x = 0; x < a.width; ++x)
+		for (unsigned int y = 0; y < a.height; ++y)
+			out[y * a.width + x] = pa[y * a.width + x] + pb[y * a.width + x];
+	return ret;
+}
+
+void bench_elementwise()
+{
+	printf("%-10s %12s %12s %12s %12s\n", "add n", "GB/s", "previous", "in-place", "scalar *");
+	for (unsigned int n : {64u, 256u, 1024u, 4096u}) {
+		Matrix a(n, n), b(n, n);
+		a.map_cells(rand_cell);
+		b.map_cells(rand_cell);
+		// two reads and a write per cell
+		double bytes = 3.0 * sizeof(MATHTYPE) * n * n;
+		double vectorized = seconds_per_call([&] { Matrix c = a + b; });
+		double previous = seconds_per_call([&] { Matrix c = reference_add(a, b); });
+		Matrix accumulator(a);
+		double inPlace = seconds_per_call([&] { accumulator = std::move(accumulator) + b; });
+		double scalar = seconds_per_call([&] { accumulator = std::move(accumulator) * (MATHTYPE) 1.0001; });
+		printf("%-10u %12.2f %12.2f %12.2f %12.2f\n", n,
+			bytes / vectorized * 1e-9, bytes / previous * 1e-9,
+			bytes / inPlace * 1e-9, bytes * 2 / 3 / scalar * 1e-9);
+	}
+}
+}
@@ -0,0 +1,49 @@
+#include "bench.hpp"
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+namespace ZMathLib_Graphics::Bench {
+static MATHTYPE rand_cell(unsigned int, unsigned int, MATHTYPE)
+{
+	return (MATHTYPE) rand() / RAND_MAX - (MATHTYPE) 0.5;
+}
+
+// The previous Matrix::operator*: a column copy per output column and a row copy per output cell
+static Matrix reference_multiply(Matrix const &a, Matrix const &b)
+{
+	Matrix ret(b.width, a.height);
+	for (unsigned int x = 0; x < ret.width; ++x) {
+		Matrix column = b.get_column(x);
+		for (unsigned int y = 0; y < ret.height; ++y) {
+			Matrix row = a.get_row(y);
+			MATHTYPE dot = 0;
+			for (unsigned int i = 0; i < column.height; ++i)
+				dot += row.get(i, 0) * column.get(0, i);
+			ret.set(x, y, dot);
+		}
+	}
+	return ret;
+}
+
+void bench_gemm()
+{
+	printf("%-10s %14s %14s %10s\n", "gemm n", "blocked GF/s", "previous GF/s", "speedup");
+	for (unsigned int n : {32u, 64u, 128u, 256u, 512u, 1024u, 2048u}) {
+		Matrix a(n, n), b(n, n);
+		a.map_cells(rand_cell);
+		b.map_cells(rand_cell);
+		double flops = 2.0 * n * n * n;
+		double blocked = seconds_per_call([&] { Matrix c = a * b; });
+		printf("%-10u %14.2f", n, flops / blocked * 1e-9);
+		// the previous implementation takes minutes past this size
+		if (n <= 512) {
+			double previous = seconds_per_call([&] { Matrix c = reference_multiply(a, b); });
+			printf(" %14.2f %9.1fx\n", flops / previous * 1e-9, previous / blocked);
+		} else {
+			printf(" %14s %10s\n", "-", "-");
+		}
+	}
+}
+}
@@ -0,0 +1,41 @@
+#include "bench.hpp"
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include "static_matrix.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+namespace ZMathLib_Graphics::Bench {
+static MATHTYPE rand_cell(unsigned int, unsigned int, MATHTYPE)
+{
+	return 2 * (MATHTYPE) rand() / RAND_MAX - 1;
+}
+
+void bench_inverse()
+{
+	Matrix affine = Matrix::translate3(1, -2, 3) * Matrix::scale4(2, 0.5, 3, 1);
+	Matrix4 affine4(affine);
+	volatile MATHTYPE sink = 0;
+	printf("%-28s %14s\n", "4x4 inverse", "ns");
+	printf("%-28s %14.1f\n", "Matrix::inverted()",
+		seconds_per_call([&] { sink = affine.inverted().get(3, 0); }) * 1e9);
+	printf("%-28s %14.1f\n", "Matrix::inverted_affine()",
+		seconds_per_call([&] { sink = affine.inverted_affine().get(3, 0); }) * 1e9);
+	printf("%-28s %14.1f\n", "Matrix4::inverted()",
+		seconds_per_call([&] { sink = affine4.inverted().get(3, 0); }) * 1e9);
+	printf("%-28s %14.1f\n", "Matrix4::inverted_affine()",
+		seconds_per_call([&] { sink = affine4.inverted_affine().get(3, 0); }) * 1e9);
+
+	printf("%-10s %14s %14s %14s\n", "solve n", "inverse * B us", "solve us", "lu() reuse us");
+	for (unsigned int n : {8u, 64u, 256u}) {
+		Matrix a = Matrix::Identity(n) * (MATHTYPE) n + Matrix(n).mapped_cells(rand_cell);
+		Matrix b = Matrix(4, n).mapped_cells(rand_cell);
+		LUDecomposition factors = a.lu();
+		double viaInverse = seconds_per_call([&] { sink = (a.inverted() * b).get(0, 0); });
+		double solve = seconds_per_call([&] { sink = Matrix::solve(a, b).get(0, 0); });
+		double reuse = seconds_per_call([&] { sink = factors.solve(b).get(0, 0); });
+		printf("%-10u %14.2f %14.2f %14.2f\n", n, viaInverse * 1e6, solve * 1e6, reuse * 1e6);
+	}
+	(void) sink;
+}
+}
@@ -0,0 +1,43 @@
+#include "bench.hpp"
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include "matrix_io.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <string>
+
+namespace ZMathLib_Graphics::Bench {
+static MATHTYPE rand_cell(unsigned int, unsigned int, MATHTYPE)
+{
+	return 2 * (MATHTYPE) rand() / RAND_MAX - 1;
+}
+
+static MATHTYPE sum_cells(MatrixConstView mtx)
+{
+	MATHTYPE sum = 0;
+	for (unsigned int y = 0; y < mtx.height; ++y)
+		for (unsigned int x = 0; x < mtx.width; ++x)
+			sum += mtx.data[y * mtx.stride + x];
+	return sum;
+}
+
+// Milliseconds to load an n x n matrix file: Matrix::read copies every cell up front, MappedMatrix only maps
+// the file and leaves the pages to be faulted in on first touch. The file is in the page cache after the first
+// call, so this is the parse and copy cost of a load rather than the disk's.
+void bench_io()
+{
+	std::string path = (std::filesystem::temp_directory_path() / "zmath_bench.zmtx").string();
+	printf("%-6s %10s %12s %12s %16s %16s\n", "n", "write", "read", "map", "read + sum", "map + sum");
+	for (unsigned int n : {256u, 1024u, 4096u}) {
+		Matrix mtx = Matrix(n).mapped_cells(rand_cell);
+		double write = seconds_per_call([&] { mtx.write(path); }, 0.2);
+		double read = seconds_per_call([&] { keep(Matrix::read(path)); }, 0.2);
+		double map = seconds_per_call([&] { keep(MappedMatrix(path).data()); }, 0.2);
+		double readSum = seconds_per_call([&] { keep(sum_cells(Matrix::read(path))); }, 0.2);
+		double mapSum = seconds_per_call([&] { keep(sum_cells(MappedMatrix(path))); }, 0.2);
+		printf("%-6u %10.3f %12.3f %12.3f %16.3f %16.3f\n", n, write * 1e3, read * 1e3, map * 1e3, readSum * 1e3, mapSum * 1e3);
+	}
+	std::filesystem::remove(path);
+}
+}
@@ -0,0 +1,47 @@
+#include "bench.hpp"
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include "matrix_expr.hpp"
+#include <cstdio>
+#include <cstdlib>
+
+namespace ZMathLib_Graphics::Bench {
+static MATHTYPE rand_cell(unsigned int, unsigned int, MATHTYPE)
+{
+	return 2 * (MATHTYPE) rand() / RAND_MAX - 1;
+}
+
+static Matrix with_layout(unsigned int n, size_t alignment)
+{
+	Matrix ret = alignment ? Matrix(n, n, Matrix::RowAlignment{ alignment }) : Matrix(n, n);
+	ret.map_cells(rand_cell);
+	return ret;
+}
+
+// Microseconds per operation on odd-width n x n matrices, whose unpadded rows start at every possible alignment,
+// against the same matrices with rows padded to 32 and 64 bytes. The elementwise rows write into an existing
+// matrix, so they time the kernels rather than how the allocator treats large aligned blocks.
+void bench_layout()
+{
+	printf("%-6s %-14s %12s %12s %12s\n", "n", "op", "packed", "32-byte rows", "64-byte rows");
+	for (unsigned int n : {127u, 1023u}) {
+		struct Op {
+			char const *name;
+			double seconds[3];
+		};
+		Op ops[] = { { "A += B", {} }, { "A *= scalar", {} }, { "A*2 + B (lazy)", {} }, { "transposed", {} }, { "A * B", {} } };
+		size_t alignments[3] = { 0, 32, 64 };
+		for (unsigned int layout = 0; layout < 3; ++layout) {
+			Matrix a = with_layout(n, alignments[layout]), b = with_layout(n, alignments[layout]);
+			Matrix target = with_layout(n, alignments[layout]);
+			ops[0].seconds[layout] = seconds_per_call([&] { target.view() += b; keep(target); }, 0.1);
+			ops[1].seconds[layout] = seconds_per_call([&] { target.view() *= MATHTYPE(0.9999); keep(target); }, 0.1);
+			ops[2].seconds[layout] = seconds_per_call([&] { target = lazy(a) * 2 + b; keep(target); }, 0.1);
+			ops[3].seconds[layout] = seconds_per_call([&] { keep(a.transposed()); }, 0.1);
+			ops[4].seconds[layout] = seconds_per_call([&] { keep(a * b); }, 0.1);
+		}
+		for (Op const &op : ops)
+			printf("%-6u %-14s %12.1f %12.1f %12.1f\n", n, op.name, op.seconds[0] * 1e6, op.seconds[1] * 1e6, op.seconds[2] * 1e6);
+	}
+}
+}
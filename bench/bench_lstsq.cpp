@@ -0,0 +1,48 @@
+#include "bench.hpp"
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include "vector.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <span>
+#include <vector>
+
+namespace ZMathLib_Graphics::Bench {
+static MATHTYPE rand_cell(unsigned int, unsigned int, MATHTYPE)
+{
+	return 2 * (MATHTYPE) rand() / RAND_MAX - 1;
+}
+
+// Microseconds per least squares fit of one right-hand side, m x n: the normal equations through LU, a
+// QRDecomposition kept and solved, lstsq returning a Matrix, lstsq into a view, and the Vec3/Vec4 rows.
+void bench_lstsq()
+{
+	printf("%-12s %12s %12s %12s %12s %12s\n", "m x n", "normal eq", "qr().solve", "lstsq", "lstsq view", "vec rows");
+	unsigned int const shapes[][2] = { {200, 3}, {200, 4}, {200, 6}, {1000, 64}, {2000, 256} };
+	for (auto const &shape : shapes) {
+		unsigned int m = shape[0], n = shape[1];
+		Matrix a = Matrix(n, m).mapped_cells(rand_cell), b = Matrix(1, m).mapped_cells(rand_cell), x(1, n);
+		std::vector<Vec3> rows3;
+		std::vector<Vec4> rows4;
+		for (unsigned int y = 0; y < m && n <= 4; ++y) {
+			rows3.push_back(Vec3(a(0, y), a(1, y), a(2, y)));
+			rows4.push_back(Vec4(a(0, y), a(1, y), a(2, y), n == 4 ? a(3, y) : 0));
+		}
+		std::span<MATHTYPE const> rhs(b.data(), m);
+
+		double vecRows = 0;
+		if (n == 3)
+			vecRows = seconds_per_call([&] { keep(Matrix::lstsq(std::span<Vec3 const>(rows3), rhs)); });
+		else if (n == 4)
+			vecRows = seconds_per_call([&] { keep(Matrix::lstsq(std::span<Vec4 const>(rows4), rhs)); });
+		char label[32];
+		snprintf(label, sizeof label, "%ux%u", m, n);
+		printf("%-12s %12.3f %12.3f %12.3f %12.3f %12.3f\n", label,
+			seconds_per_call([&] { Matrix at = a.transposed(); keep(Matrix::solve(at * a, at * b)); }) * 1e6,
+			seconds_per_call([&] { keep(a.qr().solve(b)); }) * 1e6,
+			seconds_per_call([&] { keep(Matrix::lstsq(a, b)); }) * 1e6,
+			seconds_per_call([&] { Matrix::lstsq(a.view(), b.view(), x.view()); keep(x.data()); }) * 1e6,
+			vecRows * 1e6);
+	}
+}
+}
@@ -0,0 +1,65 @@
+#include "bench.hpp"
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include "matrix_memory.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <memory_resource>
+#include <vector>
+
+namespace ZMathLib_Graphics::Bench {
+static MATHTYPE rand_cell(unsigned int, unsigned int, MATHTYPE)
+{
+	return 2 * (MATHTYPE) rand() / RAND_MAX - 1;
+}
+
+// One frame of a scene graph: a model matrix per object, built from temporaries, folded into a checksum
+static MATHTYPE frame(std::vector<Matrix> const &rotations, Matrix const &viewProjection, unsigned int size)
+{
+	MATHTYPE sum = 0;
+	for (unsigned int i = 0; i < rotations.size(); ++i) {
+		Matrix model = Matrix::translate3(i, 1, -1) * rotations[i] * Matrix::scale4(2);
+		Matrix mvp = viewProjection * model;
+		sum += mvp.data()[i % (size * size)];
+	}
+	return sum;
+}
+
+// Time and allocations per frame with the default resource, a size-class pool, and an arena reset every frame.
+// "heap allocs" counts operator new calls, "matrix allocs" every Matrix buffer (allocation_stats()).
+void bench_memory()
+{
+	printf("%-10s %-10s %14s %14s %14s\n", "objects", "resource", "us/frame", "heap allocs", "matrix allocs");
+	for (unsigned int objects : {64u, 1024u}) {
+		std::vector<Matrix> rotations;
+		for (unsigned int i = 0; i < objects; ++i)
+			rotations.push_back(Matrix(4).mapped_cells(rand_cell));
+		Matrix viewProjection = Matrix(4).mapped_cells(rand_cell);
+		std::pmr::unsynchronized_pool_resource pool;
+		ArenaResource arena;
+
+		struct Row {
+			char const *name;
+			std::pmr::memory_resource *resource;
+			bool reset;
+		};
+		for (Row const &row : { Row{ "default", nullptr, false }, Row{ "pool", &pool, false }, Row{ "arena", &arena, true } }) {
+			volatile MATHTYPE sink = 0;
+			reset_allocation_stats();
+			unsigned long frames = 0;
+			Measurement m = measure([&] {
+				{
+					ScopedMatrixResource scope(row.resource ? row.resource : matrix_resource());
+					sink = frame(rotations, viewProjection, 4);
+				}
+				if (row.reset)
+					arena.reset();
+				++frames;
+			});
+			printf("%-10u %-10s %14.2f %14.2f %14.2f\n", objects, row.name, m.seconds * 1e6, m.allocations,
+				(double) allocation_stats().allocations / frames);
+			(void) sink;
+		}
+	}
+}
+}
@@ -0,0 +1,336 @@
+#include "bench.hpp"
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include "matrix_expr.hpp"
+#include "quaternion.hpp"
+#include "vector.hpp"
+#include "vector_soa.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+// One row per public operation and size. Sizes are n for n x n matrices, the element count for bulk operations,
+// and 1 for single vectors and quaternions.
+
+namespace ZMathLib_Graphics::Bench {
+static MATHTYPE rand_component()
+{
+	return 2 * (MATHTYPE) rand() / RAND_MAX - 1;
+}
+static MATHTYPE rand_cell(unsigned int, unsigned int, MATHTYPE)
+{
+	return rand_component();
+}
+static MATHTYPE identity_cell(unsigned int, unsigned int, MATHTYPE cell)
+{
+	return cell;
+}
+static Matrix identity_row(unsigned int, Matrix row)
+{
+	return row;
+}
+static MATHTYPE sum_row(unsigned int, Matrix row)
+{
+	MATHTYPE sum = 0;
+	for (unsigned int i = 0; i < row.width * row.height; ++i)
+		sum += row.data()[i];
+	return sum;
+}
+
+static MATHTYPE sum_view(unsigned int, StridedConstView line)
+{
+	MATHTYPE sum = 0;
+	for (MATHTYPE cell : line)
+		sum += cell;
+	return sum;
+}
+
+static void bench_matrix_ops(Suite &suite)
+{
+	for (unsigned int n : {2u, 3u, 4u, 8u, 16u, 64u, 256u}) {
+		Matrix a(n), b(n), c(n), d(n);
+		a.map_cells(rand_cell);
+		b.map_cells(rand_cell);
+		c.map_cells(rand_cell);
+		d.map_cells(rand_cell);
+		// well conditioned, for inverse and solve
+		Matrix invertible = Matrix::Identity(n) * (MATHTYPE) n + a;
+		Matrix rhs(1, n);
+		rhs.map_cells(rand_cell);
+		Matrix target(n);
+		MATHTYPE scalar = 1.0001;
+
+		suite.run("Matrix::Zero", n, [&] { keep(Matrix::Zero(n)); });
+		suite.run("Matrix::Identity", n, [&] { keep(Matrix::Identity(n)); });
+		suite.run("Matrix(Matrix const &)", n, [&] { Matrix copy(a); keep(copy); });
+		suite.run("Matrix = Matrix const &", n, [&] { target = a; keep(target); });
+		suite.run("Matrix::get", n, [&] { keep(a.get(n - 1, n / 2)); });
+		suite.run("Matrix::set", n, [&] { target.set(n - 1, n / 2, scalar); keep(target); });
+		// summing every cell: checked get(), unchecked operator(), and the raw buffer
+		suite.run("sum of Matrix::get", n, [&] {
+			MATHTYPE sum = 0;
+			for (unsigned int y = 0; y < n; ++y)
+				for (unsigned int x = 0; x < n; ++x)
+					sum += a.get(x, y);
+			keep(sum);
+		});
+		suite.run("sum of Matrix::operator()", n, [&] {
+			Matrix const &cells = a;
+			MATHTYPE sum = 0;
+			for (unsigned int y = 0; y < n; ++y)
+				for (unsigned int x = 0; x < n; ++x)
+					sum += cells(x, y);
+			keep(sum);
+		});
+		suite.run("sum of Matrix::data", n, [&] {
+			MATHTYPE const *cells = a.data();
+			MATHTYPE sum = 0;
+			for (unsigned int i = 0; i < n * n; ++i)
+				sum += cells[i];
+			keep(sum);
+		});
+		suite.run("Matrix::get_row", n, [&] { keep(a.get_row(n / 2)); });
+		suite.run("Matrix::get_column", n, [&] { keep(a.get_column(n / 2)); });
+		suite.run("Matrix::get_row_mut", n, [&] { MathTypePointerList row = target.get_row_mut(n / 2); keep(row[0]); });
+		suite.run("Matrix::get_column_mut", n, [&] { MathTypePointerList column = target.get_column_mut(n / 2); keep(column[0]); });
+		suite.run("Matrix::row", n, [&] { keep(target.row(n / 2)); });
+		suite.run("Matrix::column", n, [&] { keep(target.column(n / 2)); });
+		suite.run("Matrix::submatrix", n, [&] { keep(target.submatrix(n / 4, n / 4, n / 2, n / 2)); });
+		// walking a column: one pointer per cell and a checked double indirection, against a strided view
+		suite.run("sum of get_column_mut", n, [&] {
+			MathTypePointerList column = target.get_column_mut(n / 2);
+			MATHTYPE sum = 0;
+			for (size_t i = 0; i < column.length; ++i)
+				sum += *column[i];
+			keep(sum);
+		});
+		suite.run("sum of column", n, [&] {
+			MATHTYPE sum = 0;
+			for (MATHTYPE cell : target.column(n / 2))
+				sum += cell;
+			keep(sum);
+		});
+		// top-left block of target from the bottom-right block of a
+		unsigned int half = n / 2;
+		suite.run("MatrixView += MatrixView", n, [&] {
+			target.submatrix(0, 0, half, half) += a.submatrix(n - half, n - half, half, half);
+			keep(target);
+		});
+		suite.run("MatrixView * MatrixView", n, [&] { keep(a.submatrix(0, 0, half, half) * b.submatrix(n - half, 0, half, half)); });
+
+		suite.run("-Matrix", n, [&] { keep(-a); });
+		suite.run("Matrix + Matrix", n, [&] { keep(a + b); });
+		suite.run("Matrix - Matrix", n, [&] { keep(a - b); });
+		suite.run("Matrix&& + Matrix", n, [&] { target = std::move(target) + b; keep(target); });
+		suite.run("Matrix * Matrix", n, [&] { keep(a * b); });
+		suite.run("Matrix + scalar", n, [&] { keep(a + scalar); });
+		suite.run("Matrix * scalar", n, [&] { keep(a * scalar); });
+		suite.run("Matrix / scalar", n, [&] { keep(a / scalar); });
+		suite.run("Matrix&& * scalar", n, [&] { target = std::move(target) * scalar; keep(target); });
+		suite.run("Matrix == Matrix", n, [&] { keep(a == b); });
+		// eager temporaries against lazy evaluation into an existing matrix (fused pass + gemm accumulate)
+		suite.run("A*B + C*2 - D", n, [&] { target = a * b + c * 2 - d; keep(target); });
+		suite.run("A*B + C*2 - D (lazy)", n, [&] { target = lazy(a) * b + lazy(c) * 2 - d; keep(target); });
+		suite.run("A*2 + B - C/4 + D", n, [&] { target = a * 2 + b - c / 4 + d; keep(target); });
+		suite.run("A*2 + B - C/4 + D (lazy)", n, [&] { target = lazy(a) * 2 + b - lazy(c) / 4 + d; keep(target); });
+
+		suite.run("Matrix::transpose", n, [&] { target.transpose(); keep(target); });
+		suite.run("Matrix::transposed", n, [&] { keep(a.transposed()); });
+		suite.run("Matrix::determinant", n, [&] { keep(a.determinant()); });
+		suite.run("Matrix::lu", n, [&] { keep(a.lu()); });
+		suite.run("Matrix::inverted", n, [&] { keep(invertible.inverted()); });
+		suite.run("Matrix::solve", n, [&] { keep(Matrix::solve(invertible, rhs)); });
+
+		suite.run("Matrix::map_cells", n, [&] { target.map_cells(identity_cell); keep(target); });
+		suite.run("Matrix::mapped_cells", n, [&] { keep(a.mapped_cells(identity_cell)); });
+		suite.run("Matrix::map_rows", n, [&] { target.map_rows(identity_row); keep(target); });
+		suite.run("Matrix::map_columns", n, [&] { target.map_columns(identity_row); keep(target); });
+		suite.run("Matrix::mapped_rows", n, [&] { keep(a.mapped_rows(identity_row)); });
+		suite.run("Matrix::mapped_columns", n, [&] { keep(a.mapped_columns(identity_row)); });
+		suite.run("Matrix::reduced_rows", n, [&] { keep(a.reduced_rows(sum_row)); });
+		suite.run("Matrix::reduced_columns", n, [&] { keep(a.reduced_columns(sum_row)); });
+		// the same operations through the callable overloads: inlined body, rows and columns as views
+		MATHTYPE factor = 1;
+		suite.run("Matrix::map_cells(lambda)", n, [&] {
+			target.map_cells([factor](unsigned int, unsigned int, MATHTYPE cell) { return cell * factor; });
+			keep(target);
+		});
+		suite.run("Matrix::map_rows(lambda)", n, [&] {
+			target.map_rows([factor](unsigned int, StridedView row) { for (MATHTYPE &cell : row) cell *= factor; });
+			keep(target);
+		});
+		suite.run("Matrix::map_columns(lambda)", n, [&] {
+			target.map_columns([factor](unsigned int, StridedView column) { for (MATHTYPE &cell : column) cell *= factor; });
+			keep(target);
+		});
+		suite.run("Matrix::reduced_rows(lambda)", n, [&] { keep(a.reduced_rows(sum_view)); });
+		suite.run("Matrix::reduced_columns(lambda)", n, [&] { keep(a.reduced_columns(sum_view)); });
+	}
+
+	// large transposes, where walking a column misses the cache and the TLB on every cell
+	for (unsigned int n : {1024u, 4096u}) {
+		Matrix square(n), wide(n, n / 2);
+		suite.run("Matrix::transpose", n, [&] { square.transpose(); keep(square); });
+		suite.run("Matrix::transposed", n, [&] { keep(square.transposed()); });
+		suite.run("Matrix::transpose (n x n/2)", n, [&] { wide.transpose(); keep(wide); });
+	}
+
+	Matrix m2 = Matrix::rotate2(0.3), m3 = Matrix::rotate3Z(0.3), m4 = Matrix::translate3(1, 2, 3);
+	Vec2 v2(1, 2);
+	Vec3 v3(1, 2, 3);
+	Vec4 v4(1, 2, 3, 1);
+	suite.run("Matrix * Vec2", 2, [&] { keep(m2 * v2); });
+	suite.run("Matrix * Vec3", 3, [&] { keep(m3 * v3); });
+	suite.run("Matrix * Vec4", 4, [&] { keep(m4 * v4); });
+	suite.run("Matrix::to_vec3", 3, [&] { keep(v3.to_column().to_vec3()); });
+	suite.run("Matrix::inverted_affine", 4, [&] { keep(m4.inverted_affine()); });
+	suite.run("Matrix::translate3", 4, [&] { keep(Matrix::translate3(1, 2, 3)); });
+	suite.run("Matrix::scale4", 4, [&] { keep(Matrix::scale4(1, 2, 3, 1)); });
+	suite.run("Matrix::rotate3X", 3, [&] { keep(Matrix::rotate3X(0.3)); });
+}
+
+static void bench_bulk_ops(Suite &suite)
+{
+	Matrix m3 = Matrix::rotate3Z(0.3);
+	Matrix m4 = Matrix::translate3(1, 2, 3);
+	for (unsigned int n : {16u, 1024u, 65536u}) {
+		std::vector<Vec3> in3, out3(n);
+		std::vector<Vec4> in4, out4(n);
+		for (unsigned int i = 0; i < n; ++i) {
+			in3.emplace_back(rand_component(), rand_component(), rand_component() + 2);
+			in4.emplace_back(rand_component(), rand_component(), rand_component(), 1);
+		}
+		Vec3SoA soa(in3), other(in3);
+		std::vector<MATHTYPE> out(n);
+
+		suite.run("Matrix::transform(Vec3)", n, [&] { m3.transform(in3, out3); keep(out3[0]); });
+		suite.run("Matrix::transform(Vec4)", n, [&] { m4.transform(in4, out4); keep(out4[0]); });
+		suite.run("Matrix::transform_points", n, [&] { m4.transform_points(in3, out3); keep(out3[0]); });
+		suite.run("Matrix::transform_directions", n, [&] { m4.transform_directions(in3, out3); keep(out3[0]); });
+
+		Quaternion rotation = Quaternion::from_euler(0.3, -1.2, 2.5);
+		suite.run("Quaternion::rotate(span<Vec3>)", n, [&] { rotation.rotate(in3, out3); keep(out3[0]); });
+
+		suite.run("dot(Vec3SoA)", n, [&] { dot(soa, other, out); keep(out[0]); });
+		suite.run("cross(Vec3SoA)", n, [&] { cross(soa, other, soa); keep(soa.x[0]); });
+		suite.run("length(Vec3SoA)", n, [&] { length(soa, out); keep(out[0]); });
+		suite.run("normalize(Vec3SoA)", n, [&] { normalize(soa); keep(soa.x[0]); });
+		suite.run("clamp(Vec3SoA)", n, [&] { clamp(soa, -0.5, 0.5); keep(soa.x[0]); });
+		suite.run("limit_length(Vec3SoA)", n, [&] { limit_length(soa, 0.8, 0.2); keep(soa.x[0]); });
+		suite.run("normalize(Vec3 span)", n, [&] { normalize(out3); keep(out3[0]); });
+		suite.run("Vec3SoA(Vec3 span)", n, [&] { Vec3SoA copy(in3); keep(copy.x[0]); });
+	}
+}
+
+// Vec2, Vec3 and Vec4 share most of their interface
+template <typename V>
+static void bench_vec_ops(Suite &suite, std::string const &name, V a, V b)
+{
+	MATHTYPE s = 1.0001;
+	suite.run(name + "(Vec const &)", 1, [&] { V copy(a); keep(copy); });
+	suite.run("-" + name, 1, [&] { keep(-a); });
+	suite.run(name + " + " + name, 1, [&] { keep(a + b); });
+	suite.run(name + " - " + name, 1, [&] { keep(a - b); });
+	suite.run(name + " * " + name, 1, [&] { keep(a * b); });
+	suite.run(name + " / " + name, 1, [&] { keep(a / b); });
+	suite.run(name + " % " + name, 1, [&] { keep(a % b); });
+	suite.run(name + " += " + name, 1, [&] { keep(a += b); });
+	suite.run(name + " + scalar", 1, [&] { keep(a + s); });
+	suite.run(name + " * scalar", 1, [&] { keep(a * s); });
+	suite.run(name + " / scalar", 1, [&] { keep(a / s); });
+	suite.run(name + " *= scalar", 1, [&] { keep(a *= s); });
+	suite.run(name + " == " + name, 1, [&] { keep(a == b); });
+	suite.run(name + "::length", 1, [&] { keep(a.length()); });
+	suite.run(name + "::length_squared", 1, [&] { keep(a.length_squared()); });
+	suite.run(name + "::normalize", 1, [&] { a.normalize(); keep(a); });
+	suite.run(name + "::normalized", 1, [&] { keep(b.normalized()); });
+	suite.run(name + "::scaled", 1, [&] { keep(b.scaled(s)); });
+	suite.run(name + "::limited_length", 1, [&] { keep(b.limited_length(0.8, 0.2)); });
+	suite.run(name + "::clamped", 1, [&] { keep(b.clamped(-0.5, 0.5)); });
+	suite.run(name + "::dot", 1, [&] { keep(a.dot(b)); });
+	suite.run(name + "::projected_length", 1, [&] { keep(a.projected_length(b)); });
+	suite.run(name + "::projected", 1, [&] { keep(a.projected(b)); });
+	suite.run(name + "::rejected", 1, [&] { keep(a.rejected(b)); });
+	suite.run(name + "::angle", 1, [&] { keep(a.angle(b)); });
+	suite.run(name + "::to_row", 1, [&] { keep(a.to_row()); });
+	suite.run(name + "::to_column", 1, [&] { keep(a.to_column()); });
+	suite.run(name + "::shortened", 1, [&] { keep(a.shortened()); });
+}
+
+static void bench_quaternion_ops(Suite &suite)
+{
+	Quaternion a(1, 0.5, -0.25, 0.125), b(0.5, 1, 2, -1);
+	MATHTYPE s = 1.0001;
+	suite.run("Quaternion(Quaternion const &)", 1, [&] { Quaternion copy(a); keep(copy); });
+	suite.run("-Quaternion", 1, [&] { keep(-a); });
+	suite.run("Quaternion::conjugated", 1, [&] { keep(a.conjugated()); });
+	suite.run("Quaternion + Quaternion", 1, [&] { keep(a + b); });
+	suite.run("Quaternion - Quaternion", 1, [&] { keep(a - b); });
+	suite.run("Quaternion * Quaternion", 1, [&] { keep(a * b); });
+	suite.run("Quaternion / Quaternion", 1, [&] { keep(a / b); });
+	suite.run("Quaternion * scalar", 1, [&] { keep(a * s); });
+	suite.run("Quaternion / scalar", 1, [&] { keep(a / s); });
+	suite.run("Quaternion::length", 1, [&] { keep(a.length()); });
+	suite.run("Quaternion::normalized", 1, [&] { keep(b.normalized()); });
+	suite.run("Quaternion::limited_length", 1, [&] { keep(b.limited_length(0.8, 0.2)); });
+	suite.run("Quaternion::clamped", 1, [&] { keep(b.clamped(-0.5, 0.5)); });
+	suite.run("Quaternion::to_column", 1, [&] { keep(a.to_column()); });
+
+	Quaternion rotation = Quaternion::from_euler(0.3, -1.2, 2.5);
+	Matrix rotationMatrix = rotation.to_matrix3();
+	Vec3 v(1, -2, 0.5);
+	suite.run("Quaternion::from_axis_angle", 1, [&] { keep(Quaternion::from_axis_angle(Vec3(1, 2, 3), 0.3)); });
+	suite.run("Quaternion::from_euler", 1, [&] { keep(Quaternion::from_euler(0.3, -1.2, 2.5)); });
+	suite.run("Quaternion::from_matrix", 1, [&] { keep(Quaternion::from_matrix(rotationMatrix)); });
+	suite.run("Quaternion::to_matrix3", 1, [&] { keep(rotation.to_matrix3()); });
+	suite.run("Quaternion::to_matrix4", 1, [&] { keep(rotation.to_matrix4()); });
+	suite.run("Quaternion::rotate(Vec3)", 1, [&] { keep(rotation.rotate(v)); });
+	// what rotating an object took before: three rotation matrices chained per object
+	suite.run("rotate3Z * rotate3Y * rotate3X * Vec3", 1, [&] {
+		keep(Matrix::rotate3Z(2.5) * Matrix::rotate3Y(-1.2) * Matrix::rotate3X(0.3) * v);
+	});
+	suite.run("Quaternion::from_euler + rotate(Vec3)", 1, [&] { keep(Quaternion::from_euler(0.3, -1.2, 2.5).rotate(v)); });
+	suite.run("Quaternion::to_vec4", 1, [&] { keep(a.to_vec4()); });
+
+	Quaternion keyframe = Quaternion::from_euler(-1.1, 0.4, 0.9);
+	suite.run("Quaternion::nlerp", 1, [&] { keep(rotation.nlerp(keyframe, 0.3)); });
+	suite.run("Quaternion::slerp", 1, [&] { keep(rotation.slerp(keyframe, 0.3)); });
+	suite.run("Quaternion::slerp_fast", 1, [&] { keep(rotation.slerp_fast(keyframe, 0.3)); });
+}
+
+void bench_ops(Suite &suite)
+{
+	suite.print_header();
+	bench_matrix_ops(suite);
+	bench_bulk_ops(suite);
+	bench_vec_ops(suite, "Vec2", Vec2(1, 2), Vec2(0.5, -0.25));
+	bench_vec_ops(suite, "Vec3", Vec3(1, 2, 3), Vec3(0.5, -0.25, 2));
+	bench_vec_ops(suite, "Vec4", Vec4(1, 2, 3, 4), Vec4(0.5, -0.25, 2, 1));
+	suite.run("Vec3::crossed", 1, [] { keep(Vec3(1, 2, 3).crossed(Vec3(0.5, -0.25, 2))); });
+	bench_quaternion_ops(suite);
+}
+
+static void write_json_string(FILE *out, std::string const &text)
+{
+	fputc('"', out);
+	for (char c : text) {
+		if (c == '"' || c == '\\')
+			fputc('\\', out);
+		fputc(c, out);
+	}
+	fputc('"', out);
+}
+
+void Suite::write_json(FILE *out) const
+{
+	fprintf(out, "{\n\t\"mathtype_bytes\": %zu,\n\t\"results\": [\n", sizeof(MATHTYPE));
+	for (size_t i = 0; i < results.size(); ++i) {
+		fprintf(out, "\t\t{\"op\": ");
+		write_json_string(out, results[i].op);
+		fprintf(out, ", \"size\": %u, \"ns_per_op\": %.3f, \"allocs_per_op\": %.3f}%s\n",
+			results[i].size, results[i].nsPerOp, results[i].allocsPerOp, i + 1 < results.size() ? "," : "");
+	}
+	fprintf(out, "\t]\n}\n");
+}
+}
@@ -0,0 +1,45 @@
+#include "bench.hpp"
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include "packed_matrix.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace ZMathLib_Graphics::Bench {
+static MATHTYPE rand_cell(unsigned int, unsigned int, MATHTYPE)
+{
+	return 2 * (MATHTYPE) rand() / RAND_MAX - 1;
+}
+
+// Milliseconds per product with a vector and solve for 16 right-hand sides, n x n dense (LU) against the
+// packed triangular, symmetric (Cholesky) and tridiagonal forms, and the cells each stores
+void bench_packed()
+{
+	printf("%-6s %-14s %12s %12s %12s %12s\n", "n", "op", "dense", "triangular", "symmetric", "tridiagonal");
+	for (unsigned int n : {512u, 2048u}) {
+		Matrix dense = Matrix(n).mapped_cells(rand_cell);
+		for (unsigned int i = 0; i < n; ++i)
+			dense(i, i) += n;
+		Matrix spd = dense.transposed() * dense;
+		TriangularMatrix triangular(dense);
+		SymmetricMatrix symmetric(spd);
+		BandedMatrix tridiagonal(dense, 1, 1);
+		Matrix x = Matrix(1, n).mapped_cells(rand_cell), rhs = Matrix(16, n).mapped_cells(rand_cell);
+		std::vector<MATHTYPE> xCells(n, 1), y(n);
+
+		printf("%-6u %-14s %12zu %12zu %12zu %12zu\n", n, "cells", size_t(n) * n, triangular.cells().size(),
+			symmetric.cells().size(), tridiagonal.cells().size());
+		printf("%-6u %-14s %12.3f %12.3f %12.3f %12.3f\n", n, "x vector",
+			seconds_per_call([&] { keep(dense * x); }) * 1e3,
+			seconds_per_call([&] { triangular.multiply(xCells, y); keep(y.data()); }) * 1e3,
+			seconds_per_call([&] { symmetric.multiply(xCells, y); keep(y.data()); }) * 1e3,
+			seconds_per_call([&] { tridiagonal.multiply(xCells, y); keep(y.data()); }) * 1e3);
+		printf("%-6u %-14s %12.3f %12.3f %12.3f %12.3f\n", n, "solve 16",
+			seconds_per_call([&] { keep(Matrix::solve(dense, rhs)); }) * 1e3,
+			seconds_per_call([&] { keep(triangular.solve(rhs)); }) * 1e3,
+			seconds_per_call([&] { keep(symmetric.solve(rhs)); }) * 1e3,
+			seconds_per_call([&] { keep(tridiagonal.solve(rhs)); }) * 1e3);
+	}
+}
+}
@@ -0,0 +1,57 @@
+#include "bench.hpp"
+#include "mathtype.hpp"
+#include "quaternion.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace ZMathLib_Graphics::Bench {
+static MATHTYPE rand_angle()
+{
+	return 6 * (MATHTYPE) rand() / RAND_MAX - 3;
+}
+
+// Textbook slerp, one acos and three sin per quaternion
+static Quaternion naive_slerp(Quaternion const &a, Quaternion const &to, MATHTYPE t)
+{
+	MATHTYPE cosine = a.r() * to.r() + a.i() * to.i() + a.j() * to.j() + a.k() * to.k();
+	// shortest arc
+	Quaternion b = cosine < 0 ? -to : to;
+	cosine = std::abs(cosine);
+	if (cosine > MATHTYPE(0.9995))
+		return (a * (1 - t) + b * t).normalized();
+	MATHTYPE theta = std::acos(cosine);
+	MATHTYPE sinTheta = std::sin(theta);
+	return a * (std::sin((1 - t) * theta) / sinTheta) + b * (std::sin(t * theta) / sinTheta);
+}
+
+// Millions of joints per second, blending one pose of random keyframe pairs by per-joint t values
+void bench_slerp()
+{
+	printf("%-10s %14s %14s %14s %14s\n", "joints", "naive slerp", "slerp", "nlerp batch", "fast batch");
+	for (unsigned int n : {1024u, 50000u, 1u << 20}) {
+		std::vector<Quaternion> from, to, out(n);
+		std::vector<MATHTYPE> t;
+		for (unsigned int i = 0; i < n; ++i) {
+			from.push_back(Quaternion::from_euler(rand_angle(), rand_angle(), rand_angle()));
+			to.push_back(Quaternion::from_euler(rand_angle(), rand_angle(), rand_angle()));
+			t.push_back((MATHTYPE) rand() / RAND_MAX);
+		}
+		volatile MATHTYPE sink = 0;
+		// Quaternion has no working assignment (Vec4::operator= doesn't assign), the loops keep each result instead
+		double naive = seconds_per_call([&] {
+			for (unsigned int i = 0; i < n; ++i)
+				keep(naive_slerp(from[i], to[i], t[i]));
+		});
+		double exact = seconds_per_call([&] {
+			for (unsigned int i = 0; i < n; ++i)
+				keep(from[i].slerp(to[i], t[i]));
+		});
+		double nlerp = seconds_per_call([&] { Quaternion::nlerp(from, to, t, out); sink = out[0].r(); });
+		double fast = seconds_per_call([&] { Quaternion::slerp_fast(from, to, t, out); sink = out[0].r(); });
+		printf("%-10u %14.1f %14.1f %14.1f %14.1f\n", n, n / naive / 1e6, n / exact / 1e6, n / nlerp / 1e6, n / fast / 1e6);
+		(void) sink;
+	}
+}
+}
@@ -0,0 +1,62 @@
+#include "bench.hpp"
+#include "mathtype.hpp"
+#include "vector.hpp"
+#include "vector_soa.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace ZMathLib_Graphics::Bench {
+static MATHTYPE rand_component()
+{
+	return 2 * (MATHTYPE) rand() / RAND_MAX - 1;
+}
+
+// Millions of vectors per second: a loop over the Vec3 methods, the bulk kernels on a Vec3 array viewed in place,
+// and the bulk kernels on Vec3SoA lanes
+void bench_soa()
+{
+	printf("%-10s %-14s %14s %14s %14s\n", "vectors", "op", "Vec3 loop", "AoS view", "Vec3SoA");
+	for (unsigned int n : {4096u, 1u << 20, 10000000u}) {
+		std::vector<Vec3> aos, other;
+		for (unsigned int i = 0; i < n; ++i) {
+			aos.emplace_back(rand_component(), rand_component(), rand_component() + 2);
+			other.emplace_back(rand_component(), rand_component(), rand_component());
+		}
+		Vec3SoA soa(aos), otherSoa(other), crossedSoa(n);
+		std::vector<Vec3> crossed(aos);
+		std::vector<MATHTYPE> out(n);
+		volatile MATHTYPE sink = 0;
+		auto report = [&](char const *name, double loop, double view, double lanes) {
+			printf("%-10u %-14s %14.1f %14.1f %14.1f\n", n, name, n / loop / 1e6, n / view / 1e6, n / lanes / 1e6);
+		};
+		report("normalize",
+			seconds_per_call([&] { for (Vec3 &v : aos) v.normalize(); sink = aos[0].x; }),
+			seconds_per_call([&] { normalize(aos); sink = aos[0].x; }),
+			seconds_per_call([&] { normalize(soa); sink = soa.x[0]; }));
+		report("length",
+			seconds_per_call([&] { for (unsigned int i = 0; i < n; ++i) out[i] = aos[i].length(); sink = out[0]; }),
+			seconds_per_call([&] { length(aos, out); sink = out[0]; }),
+			seconds_per_call([&] { length(soa, out); sink = out[0]; }));
+		report("dot",
+			seconds_per_call([&] { for (unsigned int i = 0; i < n; ++i) out[i] = aos[i].dot(other[i]); sink = out[0]; }),
+			seconds_per_call([&] { dot(aos, other, out); sink = out[0]; }),
+			seconds_per_call([&] { dot(soa, otherSoa, out); sink = out[0]; }));
+		report("cross",
+			seconds_per_call([&] {
+				for (unsigned int i = 0; i < n; ++i) {
+					Vec3 v = aos[i].crossed(other[i]);
+					crossed[i].x = v.x; crossed[i].y = v.y; crossed[i].z = v.z;
+				}
+				sink = crossed[0].x;
+			}),
+			seconds_per_call([&] { cross(aos, other, crossed); sink = crossed[0].x; }),
+			seconds_per_call([&] { cross(soa, otherSoa, crossedSoa); sink = crossedSoa.x[0]; }));
+		report("limit_length",
+			seconds_per_call([&] { for (Vec3 &v : aos) v.limit_length(0.8, 0.2); sink = aos[0].x; }),
+			seconds_per_call([&] { limit_length(aos, 0.8, 0.2); sink = aos[0].x; }),
+			seconds_per_call([&] { limit_length(soa, 0.8, 0.2); sink = soa.x[0]; }));
+		(void) sink;
+	}
+}
+}
@@ -0,0 +1,38 @@
+#include "bench.hpp"
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include "sparse_matrix.hpp"
+#include "vector.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace ZMathLib_Graphics::Bench {
+// Microseconds per product of an n x n matrix with about 1% of its cells set, stored dense and as CSR/CSC,
+// by a vector, by n Vec3 and by an n x 16 matrix
+void bench_sparse()
+{
+	printf("%-6s %-12s %12s %12s %12s\n", "n", "op", "dense", "CSR", "CSC");
+	for (unsigned int n : {1024u, 4096u}) {
+		Matrix dense = Matrix(n).mapped_cells([](unsigned int, unsigned int, MATHTYPE) {
+			return rand() % 100 == 0 ? 2 * (MATHTYPE) rand() / RAND_MAX - 1 : MATHTYPE(0);
+		});
+		SparseMatrix csr(dense), csc(dense, SparseMatrix::CSC);
+		Matrix x(1, n), columns(16, n);
+		std::vector<MATHTYPE> xCells(n, 1), y(n);
+		std::vector<Vec3> points(n, Vec3(1, 2, 3)), moved(n);
+
+		double denseVector = seconds_per_call([&] { keep(dense * x); });
+		double csrVector = seconds_per_call([&] { csr.multiply(xCells, y); keep(y.data()); });
+		double cscVector = seconds_per_call([&] { csc.multiply(xCells, y); keep(y.data()); });
+		printf("%-6u %-12s %12.1f %12.1f %12.1f\n", n, "x vector", denseVector * 1e6, csrVector * 1e6, cscVector * 1e6);
+		double csrPoints = seconds_per_call([&] { csr.multiply(points, moved); keep(moved.data()); });
+		double cscPoints = seconds_per_call([&] { csc.multiply(points, moved); keep(moved.data()); });
+		printf("%-6u %-12s %12s %12.1f %12.1f\n", n, "x Vec3", "", csrPoints * 1e6, cscPoints * 1e6);
+		double denseColumns = seconds_per_call([&] { keep(dense * columns); });
+		double csrColumns = seconds_per_call([&] { keep(csr * columns); });
+		double cscColumns = seconds_per_call([&] { keep(csc * columns); });
+		printf("%-6u %-12s %12.1f %12.1f %12.1f\n", n, "x n x 16", denseColumns * 1e6, csrColumns * 1e6, cscColumns * 1e6);
+	}
+}
+}
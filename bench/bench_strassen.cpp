@@ -0,0 +1,48 @@
+#include "bench.hpp"
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace ZMathLib_Graphics::Bench {
+static MATHTYPE rand_cell(unsigned int, unsigned int, MATHTYPE)
+{
+	return 2 * (MATHTYPE) rand() / RAND_MAX - 1;
+}
+
+// largest difference from the blocked product, relative to its largest cell
+static double relative_error(Matrix const &product, Matrix const &reference)
+{
+	double error = 0, scale = 0;
+	for (unsigned int y = 0; y < reference.height; ++y)
+		for (unsigned int x = 0; x < reference.width; ++x) {
+			error = std::max(error, (double) std::abs(product(x, y) - reference(x, y)));
+			scale = std::max(scale, (double) std::abs(reference(x, y)));
+		}
+	return error / scale;
+}
+
+// Milliseconds per n x n product, blocked against Strassen-Winograd with each crossover, and the error of
+// the latter against the former. The default crossover is the fastest one here.
+void bench_strassen()
+{
+	unsigned int const crossovers[] = { 128, 256, 512, 1024 };
+	printf("%-6s %10s", "n", "blocked");
+	for (unsigned int crossover : crossovers)
+		printf("   SW %4u (err)", crossover);
+	printf("\n");
+	for (unsigned int n : {1024u, 2048u, 4096u}) {
+		Matrix a = Matrix(n).mapped_cells(rand_cell), b = Matrix(n).mapped_cells(rand_cell);
+		Matrix reference = a * b;
+		printf("%-6u %10.1f", n, seconds_per_call([&] { keep(a * b); }, 0.5) * 1e3);
+		for (unsigned int crossover : crossovers) {
+			MultiplyPolicy policy{ MultiplyPolicy::StrassenWinograd, crossover };
+			double seconds = seconds_per_call([&] { keep(a.multiply(b, policy)); }, 0.5);
+			printf(" %7.1f (%.0e)", seconds * 1e3, relative_error(a.multiply(b, policy), reference));
+		}
+		printf("\n");
+	}
+}
+}
@@ -0,0 +1,64 @@
+#include "bench.hpp"
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include "matrix_threads.hpp"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <vector>
+
+namespace ZMathLib_Graphics::Bench {
+static MATHTYPE rand_cell(unsigned int, unsigned int, MATHTYPE)
+{
+	return 2 * (MATHTYPE) rand() / RAND_MAX - 1;
+}
+
+// Scaling of the threaded operations: milliseconds per call at 1, 2, 4, ... threads up to maxThreads,
+// and the speedup over one thread
+void bench_threads(unsigned int maxThreads)
+{
+	std::vector<unsigned int> counts;
+	for (unsigned int threads = 1; threads < maxThreads; threads *= 2)
+		counts.push_back(threads);
+	counts.push_back(maxThreads);
+
+	Matrix a512 = Matrix(512).mapped_cells(rand_cell), b512 = Matrix(512).mapped_cells(rand_cell);
+	Matrix a1024 = Matrix(1024).mapped_cells(rand_cell), b1024 = Matrix(1024).mapped_cells(rand_cell);
+	Matrix a2048 = Matrix(2048).mapped_cells(rand_cell), b2048 = Matrix(2048).mapped_cells(rand_cell);
+	Matrix target(2048);
+	struct Op {
+		char const *name;
+		std::function<void()> run;
+	};
+	Op ops[] = {
+		{ "A * B 512", [&] { keep(a512 * b512); } },
+		{ "A * B 1024", [&] { keep(a1024 * b1024); } },
+		{ "A + B 2048", [&] { target = a2048 + b2048; keep(target); } },
+		{ "A * scalar 2048", [&] { target = a2048 * MATHTYPE(1.0001); keep(target); } },
+		{ "transposed 2048", [&] { keep(a2048.transposed()); } },
+		{ "map_cells_parallel 1024", [&] {
+			a1024.map_cells_parallel([](unsigned int, unsigned int, MATHTYPE cell) { return std::sin(cell); });
+			keep(a1024);
+		} },
+	};
+
+	printf("%-24s", "op (ms, speedup)");
+	for (unsigned int threads : counts)
+		printf(" %8u thr", threads);
+	printf("\n");
+	for (Op const &op : ops) {
+		printf("%-24s", op.name);
+		double single = 0;
+		for (unsigned int threads : counts) {
+			set_thread_count(threads);
+			double seconds = seconds_per_call(op.run, 0.2);
+			if (threads == 1)
+				single = seconds;
+			printf(" %7.2f %4.1fx", seconds * 1e3, single / seconds);
+		}
+		printf("\n");
+	}
+	set_thread_count(0);
+}
+}
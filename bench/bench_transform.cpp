@@ -0,0 +1,95 @@
+#include "bench.hpp"
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include "vector.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+namespace ZMathLib_Graphics::Bench {
+static MATHTYPE rand_component()
+{
+	return 2 * (MATHTYPE) rand() / RAND_MAX - 1;
+}
+
+// Throughput in millions of vertices per second: batched span API vs one operator* per vertex,
+// and vs the previous operator*, which went through to_column() and a Matrix * Matrix product
+void bench_transform()
+{
+	Matrix m3 = Matrix::rotate3Z(0.3) * Matrix::scale3(2, -1, 0.5);
+	Matrix m4 = Matrix::translate3(1, 2, 3) * Matrix::scale4(2, 3, 4, 1);
+	Matrix perspective = Matrix::Identity(4);
+	perspective.set(2, 3, -1);
+	perspective.set(3, 3, 0);
+	printf("%-10s %-22s %14s %14s %14s\n", "vertices", "op", "Mvert/s", "per-vertex", "previous");
+	for (unsigned int n : {64u, 4096u, 262144u}) {
+		std::vector<Vec3> in3, out3(n);
+		std::vector<Vec4> in4, out4(n);
+		for (unsigned int i = 0; i < n; ++i) {
+			in3.emplace_back(rand_component(), rand_component(), rand_component() + 2);
+			in4.emplace_back(rand_component(), rand_component(), rand_component(), 1);
+		}
+		volatile MATHTYPE sink = 0;
+		auto report = [&](char const *name, double batched, double single, double previous) {
+			printf("%-10u %-22s %14.1f %14.1f", n, name, n / batched / 1e6, n / single / 1e6);
+			if (previous > 0)
+				printf(" %14.1f\n", n / previous / 1e6);
+			else
+				printf(" %14s\n", "-");
+		};
+		report("transform(Vec3)",
+			seconds_per_call([&] { m3.transform(in3, out3); sink = out3[0].x; }),
+			seconds_per_call([&] {
+				for (unsigned int i = 0; i < n; ++i) {
+					Vec3 v = m3 * in3[i];
+					out3[i].x = v.x; out3[i].y = v.y; out3[i].z = v.z;
+				}
+				sink = out3[0].x;
+			}),
+			n > 4096 ? 0 : seconds_per_call([&] {
+				for (unsigned int i = 0; i < n; ++i) {
+					Vec3 v = (m3 * in3[i].to_column()).to_vec3();
+					out3[i].x = v.x; out3[i].y = v.y; out3[i].z = v.z;
+				}
+				sink = out3[0].x;
+			}));
+		report("transform(Vec4)",
+			seconds_per_call([&] { m4.transform(in4, out4); sink = out4[0].x; }),
+			seconds_per_call([&] {
+				for (unsigned int i = 0; i < n; ++i) {
+					Vec4 v = m4 * in4[i];
+					out4[i].x = v.x; out4[i].y = v.y; out4[i].z = v.z; out4[i].w = v.w;
+				}
+				sink = out4[0].x;
+			}), 0);
+		report("transform_points",
+			seconds_per_call([&] { m4.transform_points(in3, out3); sink = out3[0].x; }),
+			seconds_per_call([&] {
+				for (unsigned int i = 0; i < n; ++i) {
+					Vec4 v = m4 * in3[i].extended(1);
+					out3[i].x = v.x; out3[i].y = v.y; out3[i].z = v.z;
+				}
+				sink = out3[0].x;
+			}), 0);
+		report("transform_points proj",
+			seconds_per_call([&] { perspective.transform_points(in3, out3); sink = out3[0].x; }),
+			seconds_per_call([&] {
+				for (unsigned int i = 0; i < n; ++i) {
+					Vec4 v = perspective * in3[i].extended(1);
+					out3[i].x = v.x / v.w; out3[i].y = v.y / v.w; out3[i].z = v.z / v.w;
+				}
+				sink = out3[0].x;
+			}), 0);
+		report("transform_directions",
+			seconds_per_call([&] { m4.transform_directions(in3, out3); sink = out3[0].x; }),
+			seconds_per_call([&] {
+				for (unsigned int i = 0; i < n; ++i) {
+					Vec4 v = m4 * in3[i].extended(0);
+					out3[i].x = v.x; out3[i].y = v.y; out3[i].z = v.z;
+				}
+				sink = out3[0].x;
+			}), 0);
+		(void) sink;
+	}
+}
+}
@@ -0,0 +1,80 @@
+#include "bench.hpp"
+#include "matrix_threads.hpp"
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+
+static void usage(char const *argv0)
+{
+	fprintf(stderr,
+		"usage: %s [--ops] [--json FILE] [--filter TEXT] [--min-time SECONDS] [--max-threads N]\n"
+		"  --ops               only run the per-operation suite, skip the kernel comparison tables\n"
+		"  --json FILE         write the per-operation results as JSON to FILE, - for stdout (implies --ops)\n"
+		"  --filter TEXT       only run operations whose name contains TEXT\n"
+		"  --min-time SECONDS  minimum time spent measuring each operation (default 0.02)\n"
+		"  --max-threads N     thread counts the scaling table goes up to (default: the pool's size)\n",
+		argv0);
+}
+
+int main(int argc, char **argv)
+{
+	ZMathLib_Graphics::Bench::Suite suite;
+	bool opsOnly = false;
+	char const *jsonPath = nullptr;
+	unsigned int maxThreads = ZMathLib_Graphics::thread_count();
+	for (int i = 1; i < argc; ++i) {
+		bool hasValue = i + 1 < argc;
+		if (strcmp(argv[i], "--ops") == 0) {
+			opsOnly = true;
+		} else if (strcmp(argv[i], "--json") == 0 && hasValue) {
+			jsonPath = argv[++i];
+			opsOnly = true;
+		} else if (strcmp(argv[i], "--filter") == 0 && hasValue) {
+			suite.filter = argv[++i];
+		} else if (strcmp(argv[i], "--min-time") == 0 && hasValue) {
+			suite.minSeconds = atof(argv[++i]);
+		} else if (strcmp(argv[i], "--max-threads") == 0 && hasValue && atoi(argv[i + 1]) > 0) {
+			maxThreads = atoi(argv[++i]);
+		} else {
+			usage(argv[0]);
+			return 2;
+		}
+	}
+	// keep stdout clean for the JSON document
+	suite.printTable = !(jsonPath && strcmp(jsonPath, "-") == 0);
+
+	srand(time(NULL));
+	if (!opsOnly) {
+		ZMathLib_Graphics::Bench::bench_gemm();
+		ZMathLib_Graphics::Bench::bench_elementwise();
+		ZMathLib_Graphics::Bench::bench_determinant();
+		ZMathLib_Graphics::Bench::bench_inverse();
+		ZMathLib_Graphics::Bench::bench_transform();
+		ZMathLib_Graphics::Bench::bench_soa();
+		ZMathLib_Graphics::Bench::bench_slerp();
+		ZMathLib_Graphics::Bench::bench_memory();
+		ZMathLib_Graphics::Bench::bench_layout();
+		ZMathLib_Graphics::Bench::bench_io();
+		ZMathLib_Graphics::Bench::bench_strassen();
+		ZMathLib_Graphics::Bench::bench_sparse();
+		ZMathLib_Graphics::Bench::bench_packed();
+		ZMathLib_Graphics::Bench::bench_lstsq();
+		ZMathLib_Graphics::Bench::bench_eigen();
+		ZMathLib_Graphics::Bench::bench_threads(maxThreads);
+	}
+	ZMathLib_Graphics::Bench::bench_ops(suite);
+
+	if (jsonPath) {
+		bool toStdout = strcmp(jsonPath, "-") == 0;
+		FILE *out = toStdout ? stdout : fopen(jsonPath, "w");
+		if (!out) {
+			perror(jsonPath);
+			return 1;
+		}
+		suite.write_json(out);
+		if (!toStdout)
+			fclose(out);
+	}
+	return 0;
+}
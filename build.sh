@@ -3,7 +3,7 @@ for f in src/*.cpp; do
 	if [ "$bf" = "main.cpp" ]; then
 		continue
 	fi
-	g++ -c -shared -fPIC "$f" -o "obj/$bf.o" -Wall -Wextra
+	g++ -std=c++20 -c -shared -fPIC "$f" -o "obj/$bf.o" -Wall -Wextra
 	echo "obj $f -> obj/$bf.o"
 done
 ld -shared obj/*.cpp.o -o lib/libzgm.so
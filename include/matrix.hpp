@@ -2,7 +2,18 @@
 #define MATRIX_HPP
 
 #include "mathtype.hpp"
+#include "matrix_memory.hpp"
+#include "matrix_threads.hpp"
+#include "matrix_view.hpp"
+#include <algorithm>
+#include <concepts>
 #include <cstddef>
+#include <iosfwd>
+#include <memory_resource>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
 
 namespace ZMathLib_Graphics {
 struct MathTypePointerList {
@@ -15,14 +26,61 @@ public:
 	MATHTYPE *&operator[](size_t index) const;
 };
 
+// Base of the lazy expressions in matrix_expr.hpp, which a Matrix can be built from or assigned
+namespace Expr {
+struct Expression {};
+}
+
 // forward declaration is needed!
 struct Vec2;
 struct Vec3;
 struct Vec4;
+struct LUDecomposition;
+struct QRDecomposition;
+struct SymmetricEigen;
+
+// How Matrix::multiply() computes a product. Blocked is what operator* does. StrassenWinograd does fewer
+// multiply-adds on products with every side past the crossover (n^2.81 instead of n^3), for somewhat larger
+// rounding errors that grow with each level of recursion. Below the crossover it is the blocked product.
+struct MultiplyPolicy {
+	enum Algorithm { Blocked, StrassenWinograd };
+	Algorithm algorithm = Blocked;
+	// Strassen-Winograd recurses until a side is at most this long, 0 for the default, 512, the fastest in
+	// bench_strassen with the smallest error of those close to it
+	unsigned int crossover = 0;
+};
 
 struct Matrix {
 private:
 	MATHTYPE *_array;
+	// where _array came from and goes back to, see matrix_memory.hpp
+	std::pmr::memory_resource *_resource;
+	// cell (x, y) is at _array[y * _stride + x]. _rowAlignment is 0 for unpadded rows (_stride == width)
+	size_t _stride;
+	size_t _rowAlignment;
+
+	// count cells from _resource, aligned to rowAlignment, counted in allocation_stats()
+	MATHTYPE *allocate_cells(size_t count, size_t rowAlignment) const;
+	// gives the height * _stride cells of _array back to _resource, leaves _array null
+	void release_cells();
+	// cells between the starts of two rows of `w` cells padded to `rowAlignment` bytes
+	static size_t padded_stride(unsigned int w, size_t rowAlignment);
+
+	// Allocates without zero-filling (padding aside), for results every cell of which is about to be overwritten.
+	// Results take the row alignment of their (left) operand.
+	struct Uninitialized {};
+	Matrix(unsigned int w, unsigned int h, Uninitialized, size_t rowAlignment=0);
+	// throws std::out_of_range unless (xColumn, yRow) is inside the matrix
+	void check_index(unsigned int xColumn, unsigned int yRow) const;
+	// i-th cell of a row or column vector, whichever the matrix is
+	MATHTYPE vector_cell(unsigned int i) const
+	{
+		return _array[width == 1 ? i * _stride : i];
+	}
+
+	friend Matrix operator+(MatrixConstView a, MatrixConstView b);
+	friend Matrix operator-(MatrixConstView a, MatrixConstView b);
+	friend Matrix operator*(MatrixConstView a, MatrixConstView b);
 public:
 	unsigned int width, height;
 
@@ -73,41 +131,140 @@ public:
 
 	Matrix(unsigned int size);
 	Matrix(unsigned int w, unsigned int h);
+	// Pads every row to a multiple of `bytes` and aligns the buffer to it, so each row starts on a boundary
+	// for aligned vector loads (32 for AVX, 64 for AVX-512 or a cache line, so threads writing neighbouring rows
+	// don't share one). bytes must be a power of two and a multiple of the cell size. Zero-filled.
+	// A stride that would be a multiple of 4096 bytes gets one more step, so columns don't alias in the cache.
+	struct RowAlignment {
+		size_t bytes;
+	};
+	Matrix(unsigned int w, unsigned int h, RowAlignment alignment);
 	Matrix(Matrix const &mtx);
+	// Copies the viewed block into a new Matrix
+	explicit Matrix(MatrixConstView view);
+	// Steals mtx's buffer (and its resource), leaving it empty (0x0)
+	Matrix(Matrix &&mtx) noexcept;
 	~Matrix();
 
-	Matrix operator+() const;
-	Matrix operator-() const;
+	Matrix &operator=(Matrix const &mtx);
+	// Steals mtx's buffer when both come from the same resource, copies the cells otherwise
+	Matrix &operator=(Matrix &&mtx);
+	// Evaluates a lazy expression (see matrix_expr.hpp), assignment reuses the buffer when the size matches
+	template <typename E>
+	requires std::derived_from<E, Expr::Expression>
+	Matrix(E const &expr);
+	template <typename E>
+	requires std::derived_from<E, Expr::Expression>
+	Matrix &operator=(E const &expr);
 
-	Matrix operator+(Matrix const &other) const;
-	Matrix operator-(Matrix const &other) const;
+	// The && overloads below reuse the buffer of a temporary left operand instead of allocating,
+	// so a chain like `a * b + c - d` only allocates for `a * b`.
+	Matrix operator+() const &;
+	Matrix operator+() &&;
+	Matrix operator-() const &;
+	Matrix operator-() &&;
+
+	Matrix operator+(Matrix const &other) const &;
+	Matrix operator+(Matrix const &other) &&;
+	Matrix operator-(Matrix const &other) const &;
+	Matrix operator-(Matrix const &other) &&;
 	Matrix operator*(Matrix const &other) const;
+	// this * other, by the policy's algorithm. Strassen-Winograd allocates one workspace besides the result.
+	Matrix multiply(Matrix const &other, MultiplyPolicy policy) const;
+	// C = alpha * A * B + beta * C, accumulating into an existing matrix or block instead of allocating.
+	// c must be A.height x B.width and must not overlap a or b. When beta == 0, C is only written
+	static void gemm(MATHTYPE alpha, MatrixConstView a, MatrixConstView b, MATHTYPE beta, MatrixView c);
 
+	// In place for square matrices, rectangular ones get a new buffer. transposed() allocates only its result,
+	// or nothing on an rvalue that can be transposed in place.
 	void transpose();
-	Matrix transposed() const;
+	Matrix transposed() const &;
+	Matrix transposed() &&;
 
+	// Closed form up to 4x4, LU factorization (O(n^3)) beyond that
 	MATHTYPE determinant() const;
+	// Partial-pivoting LU factorization, keep the result around to reuse it for several solves
+	LUDecomposition lu() const;
+	// Blocked Householder QR of a matrix at least as tall as it is wide, throws std::invalid_argument otherwise
+	QRDecomposition qr() const;
+	// Eigenvalues and eigenvectors of a symmetric matrix, reading its lower triangle, by cyclic Jacobi
+	// rotations. Throws std::invalid_argument unless square. See eigen_symmetric3() for batches of 3x3.
+	SymmetricEigen eigen_symmetric() const;
+
+	// Closed form up to 4x4, LU factorization beyond that. Throws std::invalid_argument if singular
+	void invert();
+	Matrix inverted() const;
+	// Inverse of a 3x3 or 4x4 affine transform (last row 0 ... 0 1), e.g. translate3() * scale4()
+	// Inverts only the linear block and back-substitutes the translation, cheaper than inverted()
+	void invert_affine();
+	Matrix inverted_affine() const;
+	// Solves A X = B for X, factoring A once for every column of B
+	static Matrix solve(Matrix const &a, Matrix const &b);
+	// Least squares: the X minimizing |A X - B| for A at least as tall as wide and of full column rank
+	// (std::invalid_argument otherwise), B any number of right-hand sides as columns. Factors A and B
+	// together with QR in a per-thread workspace that is kept between calls, x must be A.width x B.width.
+	// Repeated fits of the same size with A up to 32 columns wide allocate only the result, or nothing when
+	// writing into x. Wider A also allocates inside the blocked products that update B.
+	static Matrix lstsq(Matrix const &a, Matrix const &b);
+	static void lstsq(MatrixConstView a, MatrixConstView b, MatrixView x);
+	// The same for rows given as vectors, fitting x with dot(rows[i], x) ~ b[i]. Allocation free once warm.
+	static Vec3 lstsq(std::span<Vec3 const> rows, std::span<MATHTYPE const> b);
+	static Vec4 lstsq(std::span<Vec4 const> rows, std::span<MATHTYPE const> b);
 
-	Matrix operator+(MATHTYPE other) const;
-	Matrix operator-(MATHTYPE other) const;
-	Matrix operator*(MATHTYPE other) const;
-	Matrix operator/(MATHTYPE other) const;
+	Matrix operator+(MATHTYPE other) const &;
+	Matrix operator+(MATHTYPE other) &&;
+	Matrix operator-(MATHTYPE other) const &;
+	Matrix operator-(MATHTYPE other) &&;
+	Matrix operator*(MATHTYPE other) const &;
+	Matrix operator*(MATHTYPE other) &&;
+	Matrix operator/(MATHTYPE other) const &;
+	Matrix operator/(MATHTYPE other) &&;
 
-	bool operator==(Matrix other) const;
-	bool operator!=(Matrix other) const;
+	bool operator==(Matrix const &other) const;
+	bool operator!=(Matrix const &other) const;
 
 	//Matrix operator+(Matrix other) const;
 	//Matrix operator-(Matrix other) const;
 
+	// Always range checked, throw std::out_of_range
 	MATHTYPE  get(unsigned int xColumn, unsigned int yColumn) const;
 	MATHTYPE &get_mut(unsigned int xColumn, unsigned int yColumn);
 	void      set(unsigned int xColumn, unsigned int yColumn, MATHTYPE newValue);
+	// Fast path for element loops, inlined and only range checked when built with ZMATH_BOUNDS_CHECKS
+	// (the CMake option of the same name, on by default in Debug builds)
+	MATHTYPE &operator()(unsigned int xColumn, unsigned int yRow);
+	MATHTYPE  operator()(unsigned int xColumn, unsigned int yRow) const;
+
+	// Raw row-major storage, cell (x, y) lives at data()[y * stride() + x]
+	MATHTYPE       *data();
+	MATHTYPE const *data() const;
+	// Distance in cells between the starts of two rows: width, or more for a Matrix with a RowAlignment.
+	// Copies, and results computed from a matrix (reductions aside), keep its row alignment.
+	size_t stride() const;
+	// The memory resource the buffer was allocated from
+	std::pmr::memory_resource *resource() const;
 
 	Matrix get_column(unsigned int xColumn) const;
+	// Prefer column(), which doesn't allocate a pointer per cell
 	MathTypePointerList get_column_mut(unsigned int xColumn);
 	Matrix get_row(unsigned int yRow) const;
+	// Prefer row(), which doesn't allocate a pointer per cell
 	MathTypePointerList get_row_mut(unsigned int yRow);
 
+	// Non-owning views into the matrix, no copy. They stay valid until the matrix is destroyed, moved from or
+	// assigned a matrix of a different size. Out of range indices throw std::out_of_range
+	MatrixView view();
+	MatrixConstView view() const;
+	operator MatrixView() &;
+	operator MatrixConstView() const;
+	StridedView row(unsigned int yRow);
+	StridedConstView row(unsigned int yRow) const;
+	StridedView column(unsigned int xColumn);
+	StridedConstView column(unsigned int xColumn) const;
+	// w x h block with its top-left cell at (x, y)
+	MatrixView submatrix(unsigned int x, unsigned int y, unsigned int w, unsigned int h);
+	MatrixConstView submatrix(unsigned int x, unsigned int y, unsigned int w, unsigned int h) const;
+
 	// Maps each row to a new row, through func()
 	void map_rows(Matrix (*func)(unsigned int yRow, Matrix row));
 	// Maps each column to a new column, through func()
@@ -116,11 +273,14 @@ public:
 	void map_cells(MATHTYPE (*func)(unsigned int xColumn, unsigned int yRow, MATHTYPE cell));
 
 	// Maps each row to a new row, through func(), returns a new Matrix
-	Matrix mapped_rows(Matrix (*func)(unsigned int yRow, Matrix row)) const;
+	Matrix mapped_rows(Matrix (*func)(unsigned int yRow, Matrix row)) const &;
+	Matrix mapped_rows(Matrix (*func)(unsigned int yRow, Matrix row)) &&;
 	// Maps each column to a new column, through func(), returns a new Matrix
-	Matrix mapped_columns(Matrix (*func)(unsigned int xColumn, Matrix column)) const;
+	Matrix mapped_columns(Matrix (*func)(unsigned int xColumn, Matrix column)) const &;
+	Matrix mapped_columns(Matrix (*func)(unsigned int xColumn, Matrix column)) &&;
 	// Maps each column to a new column, through func(), returns a new Matrix
-	Matrix mapped_cells(MATHTYPE (*func)(unsigned int xColumn, unsigned int yRow, MATHTYPE cell)) const;
+	Matrix mapped_cells(MATHTYPE (*func)(unsigned int xColumn, unsigned int yRow, MATHTYPE cell)) const &;
+	Matrix mapped_cells(MATHTYPE (*func)(unsigned int xColumn, unsigned int yRow, MATHTYPE cell)) &&;
 
 	// Takes in a matrix dimensions CxR and produces a matrix 1xR, applying func() on each row of the matrix.
 	void reduce_rows(MATHTYPE (*func)(unsigned int yRow, Matrix row));
@@ -132,15 +292,275 @@ public:
 	// Takes in a matrix dimensions CxR and produces a matrix Cx1, applying func() on each column of the matrix. Returns a new Matrix.
 	Matrix reduced_columns(MATHTYPE (*func)(unsigned int xColumn, Matrix column)) const;
 
+	// Callable versions of the above, for lambdas and functors. They are templates so func() is inlined,
+	// and rows and columns are passed as views into the matrix instead of copies.
+	// map_rows / map_columns modify the view in place: func(yRow, StridedView row) -> void
+	template <typename F>
+	requires std::invocable<F &, unsigned int, StridedView>
+	void map_rows(F &&func);
+	template <typename F>
+	requires std::invocable<F &, unsigned int, StridedView>
+	void map_columns(F &&func);
+	// func(xColumn, yRow, cell) -> new cell
+	template <typename F>
+	requires std::invocable<F &, unsigned int, unsigned int, MATHTYPE>
+	void map_cells(F &&func);
+	// map_cells() spread over the thread pool, in blocks of rows. func is called concurrently and in no
+	// particular order, so it must not depend on other cells or share state without synchronizing it.
+	template <typename F>
+	requires std::invocable<F &, unsigned int, unsigned int, MATHTYPE>
+	void map_cells_parallel(F &&func);
+
+	template <typename F>
+	requires std::invocable<F &, unsigned int, StridedView>
+	Matrix mapped_rows(F &&func) const &;
+	template <typename F>
+	requires std::invocable<F &, unsigned int, StridedView>
+	Matrix mapped_rows(F &&func) &&;
+	template <typename F>
+	requires std::invocable<F &, unsigned int, StridedView>
+	Matrix mapped_columns(F &&func) const &;
+	template <typename F>
+	requires std::invocable<F &, unsigned int, StridedView>
+	Matrix mapped_columns(F &&func) &&;
+	template <typename F>
+	requires std::invocable<F &, unsigned int, unsigned int, MATHTYPE>
+	Matrix mapped_cells(F &&func) const &;
+	template <typename F>
+	requires std::invocable<F &, unsigned int, unsigned int, MATHTYPE>
+	Matrix mapped_cells(F &&func) &&;
+
+	// func(yRow, StridedConstView row) -> MATHTYPE
+	template <typename F>
+	requires std::invocable<F &, unsigned int, StridedConstView>
+	void reduce_rows(F &&func);
+	template <typename F>
+	requires std::invocable<F &, unsigned int, StridedConstView>
+	void reduce_columns(F &&func);
+	template <typename F>
+	requires std::invocable<F &, unsigned int, StridedConstView>
+	Matrix reduced_rows(F &&func) const;
+	template <typename F>
+	requires std::invocable<F &, unsigned int, StridedConstView>
+	Matrix reduced_columns(F &&func) const;
+
 	void print() const;
+	// Binary I/O in the format described in matrix_io.hpp. write keeps the row layout (stride and alignment),
+	// read converts from either cell type and byte order. Both throw std::runtime_error when the stream or file
+	// fails, read throws std::invalid_argument when the data isn't a matrix file, and write when the rows are
+	// aligned to more than 4096 bytes.
+	void write(std::ostream &out) const;
+	void write(std::string const &path) const;
+	static Matrix read(std::istream &in);
+	static Matrix read(std::string const &path);
 
 	Vec2 operator*(Vec2 const &other) const;
 	Vec3 operator*(Vec3 const &other) const;
 	Vec4 operator*(Vec4 const &other) const;
 
+	// Batched matrix * vector, out[i] = M * in[i]. Spans must be the same size, out may be the same span as in.
+	// 3x3 Matrix on Vec3
+	void transform(std::span<Vec3 const> in, std::span<Vec3> out) const;
+	// 4x4 Matrix on Vec4
+	void transform(std::span<Vec4 const> in, std::span<Vec4> out) const;
+	// 4x4 Matrix on Vec3 points (w = 1), divided by the resulting w unless the last row is 0 0 0 1
+	void transform_points(std::span<Vec3 const> in, std::span<Vec3> out) const;
+	// 4x4 Matrix on Vec3 directions (w = 0), so translation is ignored
+	void transform_directions(std::span<Vec3 const> in, std::span<Vec3> out) const;
+
 	// none of this unless C++23
 	//MATHTYPE &operator[](size_t xColumn, size_t yRow);
 };
+
+// PA = LU for a square matrix A, with P a row permutation, L unit lower triangular and U upper triangular
+struct LUDecomposition {
+	// L strictly below the diagonal (its unit diagonal is implicit), U on and above it
+	Matrix lu;
+	// row y of PA is row pivots[y] of A
+	std::vector<unsigned int> pivots;
+	// determinant of P, +1 or -1
+	int sign;
+	// a zero pivot was found, so A has no inverse
+	bool singular;
+
+	MATHTYPE determinant() const;
+	// Solves A X = B, B may hold any number of right-hand sides as columns
+	Matrix solve(Matrix const &b) const;
+	Matrix inverse() const;
+};
+
+// A = Q R with Q orthogonal, R upper triangular. Q is kept as the product of Householder reflectors
+// H_k = I - tau[k] v_k v_k^T, which is cheaper to apply than to form.
+struct QRDecomposition {
+	// R on and above the diagonal, v_k below the diagonal of column k (its leading 1 implicit)
+	Matrix qr;
+	std::vector<MATHTYPE> tau;
+
+	// the first A.width columns of Q, A.height x A.width
+	Matrix q() const;
+	// A.width x A.width
+	Matrix r() const;
+	// The least squares solution of A X = B, see Matrix::lstsq()
+	Matrix solve(Matrix const &b) const;
+};
+
+// A = V diag(values) V^T with V orthogonal
+struct SymmetricEigen {
+	// ascending
+	std::vector<MATHTYPE> values;
+	// column i is the unit eigenvector of values[i]
+	Matrix vectors;
+};
+
+inline MATHTYPE &Matrix::operator()(unsigned int xColumn, unsigned int yRow)
+{
+#ifdef ZMATH_BOUNDS_CHECKS
+	check_index(xColumn, yRow);
+#endif
+	return _array[yRow * _stride + xColumn];
+}
+inline MATHTYPE Matrix::operator()(unsigned int xColumn, unsigned int yRow) const
+{
+#ifdef ZMATH_BOUNDS_CHECKS
+	check_index(xColumn, yRow);
+#endif
+	return _array[yRow * _stride + xColumn];
+}
+
+// evaluate_expression and spine_products_read are found by argument-dependent lookup in matrix_expr.hpp
+template <typename E>
+requires std::derived_from<E, Expr::Expression>
+Matrix::Matrix(E const &expr) : Matrix(expr.width(), expr.height(), Uninitialized())
+{
+	evaluate_expression(expr, *this);
+}
+template <typename E>
+requires std::derived_from<E, Expr::Expression>
+Matrix &Matrix::operator=(E const &expr)
+{
+	// a product can't be accumulated into a matrix it reads from, nor into one about to be reallocated
+	if (width != expr.width() || height != expr.height() || spine_products_read(expr, _array)) {
+		Matrix fresh(expr);
+		return *this = std::move(fresh);
+	}
+	evaluate_expression(expr, *this);
+	return *this;
+}
+
+template <typename F>
+requires std::invocable<F &, unsigned int, StridedView>
+void Matrix::map_rows(F &&func)
+{
+	for (unsigned int rowIdx = 0; rowIdx < height; ++rowIdx)
+		func(rowIdx, StridedView(_array + rowIdx * _stride, width, 1));
+}
+template <typename F>
+requires std::invocable<F &, unsigned int, StridedView>
+void Matrix::map_columns(F &&func)
+{
+	for (unsigned int columnIdx = 0; columnIdx < width; ++columnIdx)
+		func(columnIdx, StridedView(_array + columnIdx, height, _stride));
+}
+template <typename F>
+requires std::invocable<F &, unsigned int, unsigned int, MATHTYPE>
+void Matrix::map_cells(F &&func)
+{
+	for (unsigned int rowIdx = 0; rowIdx < height; ++rowIdx) {
+		MATHTYPE *row = _array + rowIdx * _stride;
+		for (unsigned int columnIdx = 0; columnIdx < width; ++columnIdx)
+			row[columnIdx] = func(columnIdx, rowIdx, row[columnIdx]);
+	}
+}
+template <typename F>
+requires std::invocable<F &, unsigned int, unsigned int, MATHTYPE>
+void Matrix::map_cells_parallel(F &&func)
+{
+	// func's cost is unknown, so blocks are kept small enough to balance an expensive one
+	parallel_for(height, std::max<size_t>(1, 4096 / std::max(width, 1u)), [&](size_t begin, size_t end) {
+		for (unsigned int rowIdx = begin; rowIdx < end; ++rowIdx) {
+			MATHTYPE *row = _array + rowIdx * _stride;
+			for (unsigned int columnIdx = 0; columnIdx < width; ++columnIdx)
+				row[columnIdx] = func(columnIdx, rowIdx, row[columnIdx]);
+		}
+	});
+}
+
+template <typename F>
+requires std::invocable<F &, unsigned int, StridedView>
+Matrix Matrix::mapped_rows(F &&func) const &
+{
+	Matrix ret(*this);
+	ret.map_rows(func);
+	return ret;
+}
+template <typename F>
+requires std::invocable<F &, unsigned int, StridedView>
+Matrix Matrix::mapped_rows(F &&func) &&
+{
+	map_rows(func);
+	return std::move(*this);
+}
+template <typename F>
+requires std::invocable<F &, unsigned int, StridedView>
+Matrix Matrix::mapped_columns(F &&func) const &
+{
+	Matrix ret(*this);
+	ret.map_columns(func);
+	return ret;
+}
+template <typename F>
+requires std::invocable<F &, unsigned int, StridedView>
+Matrix Matrix::mapped_columns(F &&func) &&
+{
+	map_columns(func);
+	return std::move(*this);
+}
+template <typename F>
+requires std::invocable<F &, unsigned int, unsigned int, MATHTYPE>
+Matrix Matrix::mapped_cells(F &&func) const &
+{
+	Matrix ret(*this);
+	ret.map_cells(func);
+	return ret;
+}
+template <typename F>
+requires std::invocable<F &, unsigned int, unsigned int, MATHTYPE>
+Matrix Matrix::mapped_cells(F &&func) &&
+{
+	map_cells(func);
+	return std::move(*this);
+}
+
+template <typename F>
+requires std::invocable<F &, unsigned int, StridedConstView>
+void Matrix::reduce_rows(F &&func)
+{
+	*this = reduced_rows(func);
+}
+template <typename F>
+requires std::invocable<F &, unsigned int, StridedConstView>
+void Matrix::reduce_columns(F &&func)
+{
+	*this = reduced_columns(func);
+}
+template <typename F>
+requires std::invocable<F &, unsigned int, StridedConstView>
+Matrix Matrix::reduced_rows(F &&func) const
+{
+	Matrix ret(1, height, Uninitialized{});
+	for (unsigned int rowIdx = 0; rowIdx < height; ++rowIdx)
+		ret._array[rowIdx] = func(rowIdx, StridedConstView(_array + rowIdx * _stride, width, 1));
+	return ret;
+}
+template <typename F>
+requires std::invocable<F &, unsigned int, StridedConstView>
+Matrix Matrix::reduced_columns(F &&func) const
+{
+	Matrix ret(width, 1, Uninitialized{});
+	for (unsigned int columnIdx = 0; columnIdx < width; ++columnIdx)
+		ret._array[columnIdx] = func(columnIdx, StridedConstView(_array + columnIdx, height, _stride));
+	return ret;
+}
 }
 ZMathLib_Graphics::Matrix operator*(MATHTYPE other, ZMathLib_Graphics::Matrix mtx);
 
@@ -0,0 +1,129 @@
+#ifndef PACKED_MATRIX_HPP
+#define PACKED_MATRIX_HPP
+
+#include "mathtype.hpp"
+#include "matrix_view.hpp"
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Packed storage for square matrices known to be zero (or mirrored) outside some pattern. Only the cells that
+// can differ are stored, and products, solves and transposes only touch those:
+//  - TriangularMatrix stores one triangle, n(n+1)/2 cells.
+//  - SymmetricMatrix stores the lower triangle, also n(n+1)/2, and reads it mirrored above the diagonal.
+//  - BandedMatrix stores `lower` diagonals below the main one and `upper` above, n(lower + upper + 1) cells.
+// Converting from a Matrix copies the pattern's cells and ignores the rest, converting back fills the rest
+// with zeros (or the mirror), one pass over the stored cells either way.
+
+namespace ZMathLib_Graphics {
+struct Matrix;
+
+struct TriangularMatrix {
+	enum Part { Lower, Upper };
+
+	unsigned int size;
+
+	// size x size of zeros
+	TriangularMatrix(unsigned int size, Part part=Lower);
+	// part of dense, which must be square
+	explicit TriangularMatrix(MatrixConstView dense, Part part=Lower);
+
+	Part part() const;
+	// Always range checked, throw std::out_of_range. get() is 0 outside the triangle, set() throws there.
+	MATHTYPE get(unsigned int xColumn, unsigned int yRow) const;
+	void set(unsigned int xColumn, unsigned int yRow, MATHTYPE newValue);
+	// Lower: row y is cells()[y(y+1)/2 ...] up to the diagonal. Upper is stored as its transpose, column x of
+	// it being row x of that lower triangle, so transposing never moves a cell.
+	std::span<MATHTYPE const> cells() const;
+	std::span<MATHTYPE> cells();
+	Matrix to_dense() const;
+	// Flips the part, keeping the cells: copied here, moved on an rvalue
+	TriangularMatrix transposed() const &;
+	TriangularMatrix transposed() &&;
+
+	// this * dense, dense must be size tall
+	Matrix operator*(Matrix const &dense) const;
+	// y = this * x, both of size cells, not overlapping
+	void multiply(std::span<MATHTYPE const> x, std::span<MATHTYPE> y) const;
+	// Solves T X = B by substitution, B may hold any number of right-hand sides as columns.
+	// Throws std::invalid_argument if a diagonal cell is 0.
+	Matrix solve(Matrix const &b) const;
+private:
+	Part _part;
+	std::vector<MATHTYPE> _cells;
+
+	// the cell of (xColumn, yRow) in _cells, which must be inside the triangle
+	size_t index(unsigned int xColumn, unsigned int yRow) const;
+	bool stored(unsigned int xColumn, unsigned int yRow) const;
+	// out (size x cols, ldo apart) = this * in (size x cols, ldi apart)
+	void multiply_rows(MATHTYPE const *in, size_t ldi, size_t cols, MATHTYPE *out, size_t ldo) const;
+};
+
+struct SymmetricMatrix {
+	unsigned int size;
+
+	// size x size of zeros
+	explicit SymmetricMatrix(unsigned int size);
+	// The lower triangle of dense, which must be square, mirrored over the upper one
+	explicit SymmetricMatrix(MatrixConstView dense);
+
+	// Always range checked, throw std::out_of_range. set() sets the cell and its mirror.
+	MATHTYPE get(unsigned int xColumn, unsigned int yRow) const;
+	void set(unsigned int xColumn, unsigned int yRow, MATHTYPE newValue);
+	// The lower triangle, row y at cells()[y(y+1)/2 ...] up to the diagonal
+	std::span<MATHTYPE const> cells() const;
+	std::span<MATHTYPE> cells();
+	Matrix to_dense() const;
+	// A symmetric matrix is its own transpose, nothing to do beyond the copy
+	SymmetricMatrix transposed() const;
+
+	// this * dense, dense must be size tall. Each stored cell is read once for both of the cells it stands for.
+	Matrix operator*(Matrix const &dense) const;
+	void multiply(std::span<MATHTYPE const> x, std::span<MATHTYPE> y) const;
+	// L, lower triangular with L * transpose(L) = this.
+	// Throws std::invalid_argument unless the matrix is positive definite.
+	TriangularMatrix cholesky() const;
+	// Solves S X = B through cholesky(), for positive definite matrices (covariances, normal equations)
+	Matrix solve(Matrix const &b) const;
+private:
+	std::vector<MATHTYPE> _cells;
+
+	void multiply_rows(MATHTYPE const *in, size_t ldi, size_t cols, MATHTYPE *out, size_t ldo) const;
+};
+
+struct BandedMatrix {
+	unsigned int size;
+	// diagonals stored below and above the main one
+	unsigned int lower, upper;
+
+	// size x size of zeros
+	BandedMatrix(unsigned int size, unsigned int lower, unsigned int upper);
+	// The band of dense, which must be square
+	BandedMatrix(MatrixConstView dense, unsigned int lower, unsigned int upper);
+
+	// Always range checked, throw std::out_of_range. get() is 0 outside the band, set() throws there.
+	MATHTYPE get(unsigned int xColumn, unsigned int yRow) const;
+	void set(unsigned int xColumn, unsigned int yRow, MATHTYPE newValue);
+	// Row y is cells()[y * (lower + upper + 1) ...], its first cell in column y - lower. Slots of columns
+	// outside the matrix are kept at 0.
+	std::span<MATHTYPE const> cells() const;
+	std::span<MATHTYPE> cells();
+	Matrix to_dense() const;
+	// The band with lower and upper swapped
+	BandedMatrix transposed() const;
+
+	Matrix operator*(Matrix const &dense) const;
+	void multiply(std::span<MATHTYPE const> x, std::span<MATHTYPE> y) const;
+	// Solves A X = B by LU with partial pivoting inside the band, which only widens the upper band to
+	// lower + upper. Throws std::invalid_argument if the matrix is singular.
+	Matrix solve(Matrix const &b) const;
+private:
+	std::vector<MATHTYPE> _cells;
+
+	size_t row_length() const;
+	bool stored(unsigned int xColumn, unsigned int yRow) const;
+	void multiply_rows(MATHTYPE const *in, size_t ldi, size_t cols, MATHTYPE *out, size_t ldo) const;
+};
+}
+
+#endif
@@ -3,6 +3,7 @@
 
 #include "mathtype.hpp"
 #include "vector.hpp"
+#include <span>
 
 namespace ZMathLib_Graphics {
 struct Quaternion {
@@ -20,6 +21,39 @@ public:
 	// returns Quaternion with K component=1
 	static Quaternion K();
 
+	// Rotation by `angle` radians (Counter ClockWise) about `axis`, which doesn't need to be normalized.
+	// A zero axis gives the identity rotation, R().
+	static Quaternion from_axis_angle(Vec3 const &axis, MATHTYPE angle);
+	// Rotation about X, then Y, then Z (q = qz * qy * qx), same as rotate3Z(z) * rotate3Y(y) * rotate3X(x)
+	static Quaternion from_euler(MATHTYPE x, MATHTYPE y, MATHTYPE z);
+	// Rotation of a 3x3 rotation matrix, or of the upper-left 3x3 block of a 4x4 one
+	static Quaternion from_matrix(Matrix const &mtx);
+
+	// The rotation matrices below and rotate() expect a unit quaternion
+	// 3x3 rotation matrix
+	Matrix to_matrix3() const;
+	// 4x4 rotation matrix, for composing with translate3() and scale4()
+	Matrix to_matrix4() const;
+
+	// Rotates vec, without building a matrix
+	Vec3 rotate(Vec3 const &vec) const;
+	// Rotates every vector of in into out, spans must be the same size and may be the same span
+	void rotate(std::span<Vec3 const> in, std::span<Vec3> out) const;
+
+	// Interpolation from this (t = 0) to `to` (t = 1), along the shortest arc. Both should be unit quaternions
+	// Normalized linear interpolation, cheapest but doesn't move at a constant angular speed
+	Quaternion nlerp(Quaternion const &to, MATHTYPE t) const;
+	// Spherical linear interpolation, constant angular speed
+	Quaternion slerp(Quaternion const &to, MATHTYPE t) const;
+	// Polynomial approximation of slerp without acos/sin, components are within 3e-5 of slerp()
+	Quaternion slerp_fast(Quaternion const &to, MATHTYPE t) const;
+	// Batched versions, out[i] = from[i].nlerp(to[i], t[i]) (same for slerp_fast). Vectorized with SIMD.
+	// All spans must be the same size, out may be the same span as from or to
+	static void nlerp(std::span<Quaternion const> from, std::span<Quaternion const> to,
+		std::span<MATHTYPE const> t, std::span<Quaternion> out);
+	static void slerp_fast(std::span<Quaternion const> from, std::span<Quaternion const> to,
+		std::span<MATHTYPE const> t, std::span<Quaternion> out);
+
 	// Converts Quaternion to a 4x1 matrix
 	Matrix to_row() const;
 	// Converts Quaternion to a 1x4 matrix
@@ -0,0 +1,563 @@
+#ifndef STATIC_MATRIX_HPP
+#define STATIC_MATRIX_HPP
+
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include "vector.hpp"
+#include <cmath>
+#include <iostream>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <utility>
+
+#ifndef MIN_ERROR_EQUAL
+#define MIN_ERROR_EQUAL 0.0001
+#endif
+
+namespace ZMathLib_Graphics {
+// Fixed-size W x H matrix, stored inline (no heap allocation) with the same row-major layout as Matrix.
+// Sizes are compile-time constants, so every loop below has a constant trip count the compiler can unroll.
+template <unsigned int W, unsigned int H>
+struct StaticMatrix {
+	static_assert(W > 0, "Expected width > 0 for StaticMatrix");
+	static_assert(H > 0, "Expected height > 0 for StaticMatrix");
+private:
+	MATHTYPE _array[W * H];
+public:
+	static constexpr unsigned int width = W;
+	static constexpr unsigned int height = H;
+
+	static StaticMatrix Zero()
+	{
+		return StaticMatrix();
+	}
+	static StaticMatrix Identity() requires (W == H)
+	{
+		StaticMatrix ret;
+		for (unsigned int i = 0; i < W; ++i)
+			ret._array[i * W + i] = 1;
+		return ret;
+	}
+
+	// 3x3 translation matrix
+	static StaticMatrix translate2(MATHTYPE ox, MATHTYPE oy) requires (W == 3 && H == 3)
+	{
+		StaticMatrix ret = Identity();
+		ret._array[0 * 3 + 2] = ox;
+		ret._array[1 * 3 + 2] = oy;
+		return ret;
+	}
+	// 4x4 translation matrix
+	static StaticMatrix translate3(MATHTYPE ox, MATHTYPE oy, MATHTYPE oz) requires (W == 4 && H == 4)
+	{
+		StaticMatrix ret = Identity();
+		ret._array[0 * 4 + 3] = ox;
+		ret._array[1 * 4 + 3] = oy;
+		ret._array[2 * 4 + 3] = oz;
+		return ret;
+	}
+
+	// 2x2 scaling matrix
+	static StaticMatrix scale2(MATHTYPE scale) requires (W == 2 && H == 2)
+	{
+		return scale2(scale, scale);
+	}
+	// 2x2 scaling matrix
+	static StaticMatrix scale2(MATHTYPE sx, MATHTYPE sy) requires (W == 2 && H == 2)
+	{
+		StaticMatrix ret;
+		ret._array[0] = sx;
+		ret._array[3] = sy;
+		return ret;
+	}
+	// 3x3 scaling matrix
+	static StaticMatrix scale3(MATHTYPE scale) requires (W == 3 && H == 3)
+	{
+		return scale3(scale, scale, scale);
+	}
+	// 3x3 scaling matrix
+	static StaticMatrix scale3(MATHTYPE sx, MATHTYPE sy, MATHTYPE sz) requires (W == 3 && H == 3)
+	{
+		StaticMatrix ret;
+		ret._array[0] = sx;
+		ret._array[4] = sy;
+		ret._array[8] = sz;
+		return ret;
+	}
+	// 4x4 scaling matrix
+	static StaticMatrix scale4(MATHTYPE scale) requires (W == 4 && H == 4)
+	{
+		return scale4(scale, scale, scale, scale);
+	}
+	// 4x4 scaling matrix
+	static StaticMatrix scale4(MATHTYPE sx, MATHTYPE sy, MATHTYPE sz, MATHTYPE sw) requires (W == 4 && H == 4)
+	{
+		StaticMatrix ret;
+		ret._array[0] = sx;
+		ret._array[5] = sy;
+		ret._array[10] = sz;
+		ret._array[15] = sw;
+		return ret;
+	}
+
+	// 2x2 rotation matrix (Counter ClockWise)
+	static StaticMatrix rotate2(MATHTYPE angle) requires (W == 2 && H == 2)
+	{
+		MATHTYPE c = std::cos(angle), s = std::sin(angle);
+		StaticMatrix ret;
+		ret._array[0] = c; ret._array[1] = -s;
+		ret._array[2] = s; ret._array[3] =  c;
+		return ret;
+	}
+	// 2x2 rotation matrix (ClockWise)
+	static StaticMatrix rotate2CW(MATHTYPE angle) requires (W == 2 && H == 2)
+	{
+		return rotate2(-angle);
+	}
+	// 3x3 rotation matrix (Counter ClockWise) about the Z axis
+	static StaticMatrix rotate3Z(MATHTYPE angle) requires (W == 3 && H == 3)
+	{
+		MATHTYPE c = std::cos(angle), s = std::sin(angle);
+		StaticMatrix ret;
+		ret._array[0] = c; ret._array[1] = -s;
+		ret._array[3] = s; ret._array[4] =  c;
+		ret._array[8] = 1;
+		return ret;
+	}
+	// 3x3 rotation matrix (ClockWise) about the Z axis
+	static StaticMatrix rotate3ZCW(MATHTYPE angle) requires (W == 3 && H == 3)
+	{
+		return rotate3Z(-angle);
+	}
+	// 3x3 rotation matrix (Counter ClockWise) about the Y axis
+	static StaticMatrix rotate3Y(MATHTYPE angle) requires (W == 3 && H == 3)
+	{
+		MATHTYPE c = std::cos(angle), s = std::sin(angle);
+		StaticMatrix ret;
+		ret._array[0] =  c; ret._array[2] = s;
+		ret._array[4] =  1;
+		ret._array[6] = -s; ret._array[8] = c;
+		return ret;
+	}
+	// 3x3 rotation matrix (ClockWise) about the Y axis
+	static StaticMatrix rotate3YCW(MATHTYPE angle) requires (W == 3 && H == 3)
+	{
+		return rotate3Y(-angle);
+	}
+	// 3x3 rotation matrix (Counter ClockWise) about the X axis
+	static StaticMatrix rotate3X(MATHTYPE angle) requires (W == 3 && H == 3)
+	{
+		MATHTYPE c = std::cos(angle), s = std::sin(angle);
+		StaticMatrix ret;
+		ret._array[0] = 1;
+		ret._array[4] = c; ret._array[5] = -s;
+		ret._array[7] = s; ret._array[8] =  c;
+		return ret;
+	}
+	// 3x3 rotation matrix (ClockWise) about the X axis
+	static StaticMatrix rotate3XCW(MATHTYPE angle) requires (W == 3 && H == 3)
+	{
+		return rotate3X(-angle);
+	}
+
+	StaticMatrix() : _array{} {}
+	// Copies a Matrix of the same dimensions
+	explicit StaticMatrix(Matrix const &mtx)
+	{
+		if (mtx.width != W || mtx.height != H)
+			throw std::invalid_argument("StaticMatrix(Matrix) expects a Matrix of equal width and height");
+		MATHTYPE const *src = mtx.data();
+		for (unsigned int y = 0; y < H; ++y)
+			for (unsigned int x = 0; x < W; ++x)
+				_array[y * W + x] = src[y * mtx.stride() + x];
+	}
+	// Copies into a new heap-backed Matrix
+	Matrix to_matrix() const
+	{
+		Matrix ret(W, H);
+		MATHTYPE *dst = ret.data();
+		for (unsigned int i = 0; i < W * H; ++i)
+			dst[i] = _array[i];
+		return ret;
+	}
+
+	MATHTYPE *data() { return _array; }
+	MATHTYPE const *data() const { return _array; }
+
+	MATHTYPE get(unsigned int xColumn, unsigned int yRow) const
+	{
+		if (xColumn >= W)
+			throw std::out_of_range("Column index exceeded width of matrix");
+		if (yRow >= H)
+			throw std::out_of_range("Row index exceeded height of matrix");
+		return _array[yRow * W + xColumn];
+	}
+	MATHTYPE &get_mut(unsigned int xColumn, unsigned int yRow)
+	{
+		if (xColumn >= W)
+			throw std::out_of_range("Column index exceeded width of matrix");
+		if (yRow >= H)
+			throw std::out_of_range("Row index exceeded height of matrix");
+		return _array[yRow * W + xColumn];
+	}
+	void set(unsigned int xColumn, unsigned int yRow, MATHTYPE newValue)
+	{
+		get_mut(xColumn, yRow) = newValue;
+	}
+	// Only range checked when built with ZMATH_BOUNDS_CHECKS, see Matrix::operator()
+	MATHTYPE &operator()(unsigned int xColumn, unsigned int yRow)
+	{
+#ifdef ZMATH_BOUNDS_CHECKS
+		get_mut(xColumn, yRow);
+#endif
+		return _array[yRow * W + xColumn];
+	}
+	MATHTYPE operator()(unsigned int xColumn, unsigned int yRow) const
+	{
+#ifdef ZMATH_BOUNDS_CHECKS
+		get(xColumn, yRow);
+#endif
+		return _array[yRow * W + xColumn];
+	}
+
+	StaticMatrix operator+() const
+	{
+		return *this;
+	}
+	StaticMatrix operator-() const
+	{
+		StaticMatrix ret;
+		for (unsigned int i = 0; i < W * H; ++i)
+			ret._array[i] = -_array[i];
+		return ret;
+	}
+
+	StaticMatrix operator+(StaticMatrix const &other) const
+	{
+		StaticMatrix ret;
+		for (unsigned int i = 0; i < W * H; ++i)
+			ret._array[i] = _array[i] + other._array[i];
+		return ret;
+	}
+	StaticMatrix operator-(StaticMatrix const &other) const
+	{
+		StaticMatrix ret;
+		for (unsigned int i = 0; i < W * H; ++i)
+			ret._array[i] = _array[i] - other._array[i];
+		return ret;
+	}
+	// A (W x H) * B (W2 x W) produces a W2 x H matrix
+	template <unsigned int W2>
+	StaticMatrix<W2, H> operator*(StaticMatrix<W2, W> const &other) const
+	{
+		StaticMatrix<W2, H> ret;
+		MATHTYPE const *b = other.data();
+		MATHTYPE *out = ret.data();
+		for (unsigned int y = 0; y < H; ++y) {
+			for (unsigned int i = 0; i < W; ++i) {
+				MATHTYPE a = _array[y * W + i];
+				for (unsigned int x = 0; x < W2; ++x)
+					out[y * W2 + x] += a * b[i * W2 + x];
+			}
+		}
+		return ret;
+	}
+
+	StaticMatrix operator+(MATHTYPE other) const
+	{
+		StaticMatrix ret;
+		for (unsigned int i = 0; i < W * H; ++i)
+			ret._array[i] = _array[i] + other;
+		return ret;
+	}
+	StaticMatrix operator-(MATHTYPE other) const
+	{
+		StaticMatrix ret;
+		for (unsigned int i = 0; i < W * H; ++i)
+			ret._array[i] = _array[i] - other;
+		return ret;
+	}
+	StaticMatrix operator*(MATHTYPE other) const
+	{
+		StaticMatrix ret;
+		for (unsigned int i = 0; i < W * H; ++i)
+			ret._array[i] = _array[i] * other;
+		return ret;
+	}
+	StaticMatrix operator/(MATHTYPE other) const
+	{
+		StaticMatrix ret;
+		for (unsigned int i = 0; i < W * H; ++i)
+			ret._array[i] = _array[i] / other;
+		return ret;
+	}
+
+	bool operator==(StaticMatrix const &other) const
+	{
+		for (unsigned int i = 0; i < W * H; ++i)
+			if (std::fabs(_array[i] - other._array[i]) >= (MIN_ERROR_EQUAL))
+				return false;
+		return true;
+	}
+	bool operator!=(StaticMatrix const &other) const
+	{
+		return !(*this == other);
+	}
+
+	// Only square matrices can be transposed in place, use transposed() otherwise
+	void transpose() requires (W == H)
+	{
+		for (unsigned int y = 0; y < H; ++y)
+			for (unsigned int x = y + 1; x < W; ++x)
+				std::swap(_array[y * W + x], _array[x * W + y]);
+	}
+	StaticMatrix<H, W> transposed() const
+	{
+		StaticMatrix<H, W> ret;
+		MATHTYPE *out = ret.data();
+		for (unsigned int y = 0; y < H; ++y)
+			for (unsigned int x = 0; x < W; ++x)
+				out[x * H + y] = _array[y * W + x];
+		return ret;
+	}
+
+	MATHTYPE determinant() const requires (W == H)
+	{
+		MATHTYPE const *m = _array;
+		if constexpr (W == 1) {
+			return m[0];
+		} else if constexpr (W == 2) {
+			return m[0] * m[3] - m[1] * m[2];
+		} else if constexpr (W == 3) {
+			return m[0] * (m[4] * m[8] - m[5] * m[7])
+			     - m[1] * (m[3] * m[8] - m[5] * m[6])
+			     + m[2] * (m[3] * m[7] - m[4] * m[6]);
+		} else if constexpr (W == 4) {
+			// 2x2 minors of the bottom two rows
+			MATHTYPE s0 = m[8] * m[13] - m[9] * m[12];
+			MATHTYPE s1 = m[8] * m[14] - m[10] * m[12];
+			MATHTYPE s2 = m[8] * m[15] - m[11] * m[12];
+			MATHTYPE s3 = m[9] * m[14] - m[10] * m[13];
+			MATHTYPE s4 = m[9] * m[15] - m[11] * m[13];
+			MATHTYPE s5 = m[10] * m[15] - m[11] * m[14];
+			return m[0] * (m[5] * s5 - m[6] * s4 + m[7] * s3)
+			     - m[1] * (m[4] * s5 - m[6] * s2 + m[7] * s1)
+			     + m[2] * (m[4] * s4 - m[5] * s2 + m[7] * s0)
+			     - m[3] * (m[4] * s3 - m[5] * s1 + m[6] * s0);
+		} else {
+			// gaussian elimination with partial pivoting on a stack copy
+			StaticMatrix lu(*this);
+			MATHTYPE *a = lu._array;
+			MATHTYPE det = 1;
+			for (unsigned int k = 0; k < W; ++k) {
+				unsigned int pivot = k;
+				for (unsigned int y = k + 1; y < W; ++y)
+					if (std::fabs(a[y * W + k]) > std::fabs(a[pivot * W + k]))
+						pivot = y;
+				if (a[pivot * W + k] == 0)
+					return 0;
+				if (pivot != k) {
+					for (unsigned int x = 0; x < W; ++x)
+						std::swap(a[k * W + x], a[pivot * W + x]);
+					det = -det;
+				}
+				det *= a[k * W + k];
+				for (unsigned int y = k + 1; y < W; ++y) {
+					MATHTYPE factor = a[y * W + k] / a[k * W + k];
+					for (unsigned int x = k + 1; x < W; ++x)
+						a[y * W + x] -= factor * a[k * W + x];
+				}
+			}
+			return det;
+		}
+	}
+
+	// Throws std::invalid_argument if the matrix is singular
+	StaticMatrix inverted() const requires (W == H)
+	{
+		MATHTYPE const *m = _array;
+		StaticMatrix ret;
+		MATHTYPE *inv = ret._array;
+		if constexpr (W == 1) {
+			if (m[0] == 0)
+				throw std::invalid_argument("StaticMatrix::inverted() requires a non-singular matrix");
+			inv[0] = 1 / m[0];
+		} else if constexpr (W == 2) {
+			MATHTYPE det = determinant();
+			if (det == 0)
+				throw std::invalid_argument("StaticMatrix::inverted() requires a non-singular matrix");
+			MATHTYPE invDet = 1 / det;
+			inv[0] =  m[3] * invDet; inv[1] = -m[1] * invDet;
+			inv[2] = -m[2] * invDet; inv[3] =  m[0] * invDet;
+		} else if constexpr (W == 3) {
+			// adjugate / determinant
+			inv[0] = m[4] * m[8] - m[5] * m[7];
+			inv[1] = m[2] * m[7] - m[1] * m[8];
+			inv[2] = m[1] * m[5] - m[2] * m[4];
+			inv[3] = m[5] * m[6] - m[3] * m[8];
+			inv[4] = m[0] * m[8] - m[2] * m[6];
+			inv[5] = m[2] * m[3] - m[0] * m[5];
+			inv[6] = m[3] * m[7] - m[4] * m[6];
+			inv[7] = m[1] * m[6] - m[0] * m[7];
+			inv[8] = m[0] * m[4] - m[1] * m[3];
+			MATHTYPE det = m[0] * inv[0] + m[1] * inv[3] + m[2] * inv[6];
+			if (det == 0)
+				throw std::invalid_argument("StaticMatrix::inverted() requires a non-singular matrix");
+			MATHTYPE invDet = 1 / det;
+			for (unsigned int i = 0; i < 9; ++i)
+				inv[i] *= invDet;
+		} else if constexpr (W == 4) {
+			// 2x2 minors of the top (s) and bottom (c) row pairs, shared between all 16 cofactors
+			MATHTYPE s0 = m[0] * m[5] - m[4] * m[1];
+			MATHTYPE s1 = m[0] * m[6] - m[4] * m[2];
+			MATHTYPE s2 = m[0] * m[7] - m[4] * m[3];
+			MATHTYPE s3 = m[1] * m[6] - m[5] * m[2];
+			MATHTYPE s4 = m[1] * m[7] - m[5] * m[3];
+			MATHTYPE s5 = m[2] * m[7] - m[6] * m[3];
+			MATHTYPE c5 = m[10] * m[15] - m[14] * m[11];
+			MATHTYPE c4 = m[9] * m[15] - m[13] * m[11];
+			MATHTYPE c3 = m[9] * m[14] - m[13] * m[10];
+			MATHTYPE c2 = m[8] * m[15] - m[12] * m[11];
+			MATHTYPE c1 = m[8] * m[14] - m[12] * m[10];
+			MATHTYPE c0 = m[8] * m[13] - m[12] * m[9];
+			MATHTYPE det = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+			if (det == 0)
+				throw std::invalid_argument("StaticMatrix::inverted() requires a non-singular matrix");
+			MATHTYPE invDet = 1 / det;
+			inv[0]  = ( m[5] * c5 - m[6] * c4 + m[7] * c3) * invDet;
+			inv[1]  = (-m[1] * c5 + m[2] * c4 - m[3] * c3) * invDet;
+			inv[2]  = ( m[13] * s5 - m[14] * s4 + m[15] * s3) * invDet;
+			inv[3]  = (-m[9] * s5 + m[10] * s4 - m[11] * s3) * invDet;
+			inv[4]  = (-m[4] * c5 + m[6] * c2 - m[7] * c1) * invDet;
+			inv[5]  = ( m[0] * c5 - m[2] * c2 + m[3] * c1) * invDet;
+			inv[6]  = (-m[12] * s5 + m[14] * s2 - m[15] * s1) * invDet;
+			inv[7]  = ( m[8] * s5 - m[10] * s2 + m[11] * s1) * invDet;
+			inv[8]  = ( m[4] * c4 - m[5] * c2 + m[7] * c0) * invDet;
+			inv[9]  = (-m[0] * c4 + m[1] * c2 - m[3] * c0) * invDet;
+			inv[10] = ( m[12] * s4 - m[13] * s2 + m[15] * s0) * invDet;
+			inv[11] = (-m[8] * s4 + m[9] * s2 - m[11] * s0) * invDet;
+			inv[12] = (-m[4] * c3 + m[5] * c1 - m[6] * c0) * invDet;
+			inv[13] = ( m[0] * c3 - m[1] * c1 + m[2] * c0) * invDet;
+			inv[14] = (-m[12] * s3 + m[13] * s1 - m[14] * s0) * invDet;
+			inv[15] = ( m[8] * s3 - m[9] * s1 + m[10] * s0) * invDet;
+		} else {
+			// gauss-jordan with partial pivoting, reducing a stack copy to the identity
+			StaticMatrix a(*this);
+			ret = Identity();
+			for (unsigned int k = 0; k < W; ++k) {
+				unsigned int pivot = k;
+				for (unsigned int y = k + 1; y < W; ++y)
+					if (std::fabs(a._array[y * W + k]) > std::fabs(a._array[pivot * W + k]))
+						pivot = y;
+				if (a._array[pivot * W + k] == 0)
+					throw std::invalid_argument("StaticMatrix::inverted() requires a non-singular matrix");
+				for (unsigned int x = 0; x < W; ++x) {
+					std::swap(a._array[k * W + x], a._array[pivot * W + x]);
+					std::swap(inv[k * W + x], inv[pivot * W + x]);
+				}
+				MATHTYPE invPivot = 1 / a._array[k * W + k];
+				for (unsigned int x = 0; x < W; ++x) {
+					a._array[k * W + x] *= invPivot;
+					inv[k * W + x] *= invPivot;
+				}
+				for (unsigned int y = 0; y < W; ++y) {
+					MATHTYPE factor = a._array[y * W + k];
+					if (y == k || factor == 0)
+						continue;
+					for (unsigned int x = 0; x < W; ++x) {
+						a._array[y * W + x] -= factor * a._array[k * W + x];
+						inv[y * W + x] -= factor * inv[k * W + x];
+					}
+				}
+			}
+		}
+		return ret;
+	}
+	// Inverse of an affine transform [L t; 0 1], such as translate3() * scale4() products: [L^-1, -L^-1 t; 0 1]
+	// Throws std::invalid_argument if the last row isn't 0 ... 0 1, or L is singular
+	StaticMatrix inverted_affine() const requires (W == H && (W == 3 || W == 4))
+	{
+		constexpr unsigned int N = W - 1;
+		for (unsigned int x = 0; x < N; ++x)
+			if (_array[N * W + x] != 0)
+				throw std::invalid_argument("StaticMatrix::inverted_affine() expects the last row to be 0 ... 0 1");
+		if (_array[N * W + N] != 1)
+			throw std::invalid_argument("StaticMatrix::inverted_affine() expects the last row to be 0 ... 0 1");
+		StaticMatrix<N, N> linear;
+		MATHTYPE *l = linear.data();
+		for (unsigned int y = 0; y < N; ++y)
+			for (unsigned int x = 0; x < N; ++x)
+				l[y * N + x] = _array[y * W + x];
+		StaticMatrix<N, N> linearInverse = linear.inverted();
+		MATHTYPE const *li = linearInverse.data();
+		StaticMatrix ret;
+		for (unsigned int y = 0; y < N; ++y) {
+			MATHTYPE translation = 0;
+			for (unsigned int x = 0; x < N; ++x) {
+				ret._array[y * W + x] = li[y * N + x];
+				translation -= li[y * N + x] * _array[x * W + N];
+			}
+			ret._array[y * W + N] = translation;
+		}
+		ret._array[N * W + N] = 1;
+		return ret;
+	}
+
+	Vec2 operator*(Vec2 const &other) const requires (W == 2 && H == 2)
+	{
+		return Vec2(
+			_array[0] * other.x + _array[1] * other.y,
+			_array[2] * other.x + _array[3] * other.y
+		);
+	}
+	Vec3 operator*(Vec3 const &other) const requires (W == 3 && H == 3)
+	{
+		return Vec3(
+			_array[0] * other.x + _array[1] * other.y + _array[2] * other.z,
+			_array[3] * other.x + _array[4] * other.y + _array[5] * other.z,
+			_array[6] * other.x + _array[7] * other.y + _array[8] * other.z
+		);
+	}
+	Vec4 operator*(Vec4 const &other) const requires (W == 4 && H == 4)
+	{
+		return Vec4(
+			_array[0] * other.x + _array[1] * other.y + _array[2] * other.z + _array[3] * other.w,
+			_array[4] * other.x + _array[5] * other.y + _array[6] * other.z + _array[7] * other.w,
+			_array[8] * other.x + _array[9] * other.y + _array[10] * other.z + _array[11] * other.w,
+			_array[12] * other.x + _array[13] * other.y + _array[14] * other.z + _array[15] * other.w
+		);
+	}
+
+	void print() const
+	{
+		for (unsigned int y = 0; y < H; ++y) {
+			std::cout << "[ ";
+			for (unsigned int x = 0; x < W; ++x)
+				std::cout << _array[y * W + x] << " ";
+			std::cout << "]" << std::endl;
+		}
+		std::cout << std::endl;
+	}
+};
+
+using Matrix2 = StaticMatrix<2, 2>;
+using Matrix3 = StaticMatrix<3, 3>;
+using Matrix4 = StaticMatrix<4, 4>;
+
+// Eigenvalues and eigenvectors of many symmetric 3x3 matrices (inertia tensors, covariances), reading their
+// lower triangles: values[i] holds those of matrices[i] ascending (x <= y <= z), and vectors[3 * i + k] the
+// unit eigenvector of component k of values[i]. vectors may be empty to only compute values.
+// Closed form rather than Jacobi: trigonometric eigenvalues, then eigenvectors from cross products, with
+// selects instead of branches so every matrix runs the same instructions. Batches run on the thread pool.
+// Throws std::invalid_argument unless values holds one Vec3 per matrix and vectors none or three.
+void eigen_symmetric3(std::span<Matrix3 const> matrices, std::span<Vec3> values, std::span<Vec3> vectors={});
+}
+
+template <unsigned int W, unsigned int H>
+ZMathLib_Graphics::StaticMatrix<W, H> operator*(MATHTYPE other, ZMathLib_Graphics::StaticMatrix<W, H> const &mtx)
+{
+	return mtx * other;
+}
+
+#endif
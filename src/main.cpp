@@ -1,15 +1,37 @@
 #include "mathtype.hpp"
 #include "matrix.hpp"
+#include "matrix_expr.hpp"
+#include "matrix_io.hpp"
+#include "matrix_memory.hpp"
+#include "matrix_threads.hpp"
+#include "packed_matrix.hpp"
+#include "quaternion.hpp"
+#include "sparse_matrix.hpp"
+#include "static_matrix.hpp"
 #include "vector.hpp"
+#include "vector_soa.hpp"
 #include "tests.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <ctime>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory_resource>
 #include <ostream>
+#include <span>
+#include <sstream>
+#include <stdexcept>
 #include <string>
+#include <thread>
+#include <vector>
 
 MATHTYPE random_num()
 {
@@ -21,6 +43,11 @@ MATHTYPE rand_cell(unsigned int, unsigned int, MATHTYPE)
 	return 100 * (MATHTYPE) rand() / RAND_MAX;
 }
 
+MATHTYPE unit_cell(unsigned int, unsigned int, MATHTYPE)
+{
+	return 2 * (MATHTYPE) rand() / RAND_MAX - 1;
+}
+
 MATHTYPE indexed_cell(unsigned int x, unsigned int y, MATHTYPE)
 {
 	return x * 10 + y;
@@ -42,7 +69,13 @@ BEGIN_TEST(test_all)
 	test_vec3();
 	test_vec4();
 	test_mtx();
+	test_static_mtx();
+	test_sparse_mtx();
+	test_packed_mtx();
 	test_vec_conversions();
+	test_vec_soa();
+	test_quaternion_rotations();
+	test_quaternion_interp();
 	test_mtx_transforms();
 	std::cout << "\e[92mAll tests ok!" << std::endl;
 END_TEST()
@@ -207,6 +240,61 @@ BEGIN_TEST(test_mtx)
 	test_mtx_unary_ops();
 	test_mtx_mtx_ops();
 	test_mtx_vec_ops();
+	test_mtx_transform();
+	test_mtx_move_ops();
+	test_mtx_gemm();
+	test_mtx_strassen();
+	test_mtx_lu();
+	test_mtx_inverse();
+	test_mtx_views();
+	test_mtx_expr();
+	test_mtx_memory();
+	test_mtx_layout();
+	test_mtx_threads();
+	test_mtx_io();
+	test_mtx_qr();
+	test_mtx_eigen();
+END_TEST()
+
+BEGIN_TEST(test_static_mtx)
+	Matrix3 rotZ = Matrix3::rotate3Z(M_PI / 4.);
+	test_assert(rotZ * Vec3(1, 0, 0) == Vec3(M_SQRT1_2, M_SQRT1_2, 0));
+	test_assert(Matrix3(Matrix::rotate3Z(M_PI / 4.)) == rotZ);
+	test_assert(Matrix3::rotate3Y(M_PI / 4.) * Vec3(1, 0, 0) == Vec3(M_SQRT1_2, 0, -M_SQRT1_2));
+	test_assert(Matrix3::rotate3X(M_PI / 4.) * Vec3(0, 0, 1) == Vec3(0, -M_SQRT1_2, M_SQRT1_2));
+	test_assert(Matrix3::rotate3ZCW(M_PI / 4.) * Vec3(1, 0, 0) == Vec3(M_SQRT1_2, -M_SQRT1_2, 0));
+	test_assert(Matrix2::scale2(4, -2) * Vec2(9, 3) == Vec2(36, -6));
+	test_assert(Matrix4::translate3(1, 2, 3) * Vec4(1, 1, 1, 1) == Vec4(2, 3, 4, 1));
+
+	// round trip through the heap-backed Matrix
+	Matrix dyn(3, 2);
+	dyn.map_cells(rand_cell);
+	StaticMatrix<3, 2> fixed(dyn);
+	test_assert(fixed.to_matrix() == dyn);
+	for (unsigned int x = 0; x < 3; ++x)
+		for (unsigned int y = 0; y < 2; ++y)
+			test_assert(fixed.get(x, y) == dyn.get(x, y));
+
+	// matches the dynamic operators
+	Matrix dynOther(2, 3);
+	dynOther.map_cells(rand_cell);
+	StaticMatrix<2, 3> fixedOther(dynOther);
+	test_assert((fixed * fixedOther).to_matrix() == dyn * dynOther);
+	test_assert((fixed + fixed * 2).to_matrix() == dyn + dyn * 2);
+	test_assert((fixed - 1).to_matrix() == dyn - 1);
+	test_assert(fixed.transposed().to_matrix() == dyn.transposed());
+
+	Matrix indexed(3, 3);
+	indexed.map_cells(indexed_cell);
+	test_assert(Matrix3(indexed).determinant() == indexed.determinant());
+	Matrix4 scale = Matrix4::scale4(2, 3, 4, 5);
+	test_assert(scale.determinant() == 120);
+	StaticMatrix<5, 5> ident5 = StaticMatrix<5, 5>::Identity() * 2;
+	test_assert(fabs(ident5.determinant() - 32) < 0.0001);
+
+	Matrix3 transposedInPlace(indexed);
+	transposedInPlace.transpose();
+	test_assert(transposedInPlace.to_matrix() == indexed.transposed());
 END_TEST()
 
 BEGIN_TEST(test_mtx_mtx_ops)
@@ -255,7 +343,1072 @@ BEGIN_TEST(test_mtx_mtx_ops)
 	test_assert(outBCM.get(0, 0) == b.get(0, 0) * c.get(0, 0) + b.get(1, 0) * c.get(0, 1));
 	test_assert(outBCM.get(0, 1) == b.get(0, 1) * c.get(0, 0) + b.get(1, 1) * c.get(0, 1));
 	test_assert(outBCM.get(0, 2) == b.get(0, 2) * c.get(0, 0) + b.get(1, 2) * c.get(0, 1));
+
+	// odd cell count so the vector kernels hit both the alignment peel and the tail
+	Matrix big(37, 19), bigOther(37, 19);
+	big.map_cells(rand_cell);
+	bigOther.map_cells(rand_cell);
+	Matrix sum = big + bigOther;
+	Matrix difference = big - bigOther;
+	Matrix plus = big + 3;
+	Matrix minus = big - 3;
+	Matrix times = big * 3;
+	Matrix divided = big / 3;
+	for (unsigned int x = 0; x < big.width; ++x) {
+		for (unsigned int y = 0; y < big.height; ++y) {
+			test_assert(sum.get(x, y) == big.get(x, y) + bigOther.get(x, y));
+			test_assert(difference.get(x, y) == big.get(x, y) - bigOther.get(x, y));
+			test_assert(plus.get(x, y) == big.get(x, y) + 3);
+			test_assert(minus.get(x, y) == big.get(x, y) - 3);
+			test_assert(times.get(x, y) == big.get(x, y) * 3);
+			test_assert(divided.get(x, y) == big.get(x, y) / 3);
+		}
+	}
+END_TEST()
+BEGIN_TEST(test_mtx_move_ops)
+	Matrix a(6, 6), b(6, 6), c(6, 6), d(6, 6);
+	a.map_cells(rand_cell);
+	b.map_cells(rand_cell);
+	c.map_cells(rand_cell);
+	d.map_cells(rand_cell);
+
+	Matrix expected = a * b;
+	expected = expected + c;
+	expected = expected - d;
+
+	// only a * b should allocate, the rest reuse its buffer
+	unsigned long before = allocation_stats().allocations;
+	Matrix chained = a * b + c - d;
+	test_assert(allocation_stats().allocations - before == 1);
+	test_assert(chained == expected);
+
+	Matrix longExpected = expected + c;
+	longExpected = longExpected - d;
+	longExpected = longExpected * 2;
+	longExpected = longExpected - 1;
+	before = allocation_stats().allocations;
+	Matrix longChain = (a * b + c - d + c - d) * 2 - 1;
+	test_assert(allocation_stats().allocations - before == 1);
+	test_assert(longChain == longExpected);
+
+	Matrix product = a * b;
+	before = allocation_stats().allocations;
+	Matrix negated = -(a * b);
+	test_assert(allocation_stats().allocations - before == 1);
+	test_assert(negated == -product);
+
+	// move construction steals the buffer
+	MATHTYPE const *buffer = chained.data();
+	Matrix moved(std::move(chained));
+	test_assert(moved.data() == buffer);
+	test_assert(chained.data() == nullptr && chained.width == 0 && chained.height == 0);
+
+	// copy assignment into a same-sized matrix reuses its buffer
+	Matrix assigned(6, 6);
+	MATHTYPE const *assignedBuffer = assigned.data();
+	before = allocation_stats().allocations;
+	assigned = moved;
+	test_assert(allocation_stats().allocations - before == 0);
+	test_assert(assigned.data() == assignedBuffer && assigned == moved);
+	Matrix resized(2, 3);
+	resized = moved;
+	test_assert(resized.width == 6 && resized.height == 6 && resized == moved);
+
+	assigned = std::move(moved);
+	test_assert(assigned.data() == buffer && moved.data() == nullptr);
+END_TEST()
+
+BEGIN_TEST(test_mtx_gemm)
+	// odd sizes so every blocking level has a partial edge tile
+	unsigned int const shapes[][3] = { {1, 1, 1}, {7, 5, 3}, {37, 53, 61}, {130, 97, 300}, {301, 18, 259} };
+	for (auto const &shape : shapes) {
+		Matrix a(shape[2], shape[0]);
+		Matrix b(shape[1], shape[2]);
+		a.map_cells(unit_cell);
+		b.map_cells(unit_cell);
+		Matrix product = a * b;
+		test_assert(product.width == b.width && product.height == a.height);
+		for (unsigned int y = 0; y < product.height; ++y) {
+			Matrix row = a.get_row(y);
+			for (unsigned int x = 0; x < product.width; ++x) {
+				Matrix column = b.get_column(x);
+				MATHTYPE dot = 0;
+				for (unsigned int i = 0; i < column.height; ++i)
+					dot += row.get(i, 0) * column.get(0, i);
+				test_assert(fabs(product.get(x, y) - dot) < 0.001);
+			}
+		}
+	}
+END_TEST()
+
+// Laplace expansion along the first row, for checking determinant() against
+MATHTYPE cofactor_determinant(Matrix const &mtx)
+{
+	if (mtx.width == 1)
+		return mtx.get(0, 0);
+	MATHTYPE ret = 0;
+	for (unsigned int x = 0; x < mtx.width; ++x) {
+		Matrix sub(mtx.width - 1);
+		for (unsigned int sy = 1; sy < mtx.height; ++sy)
+			for (unsigned int sx = 0, i = 0; sx < mtx.width; ++sx)
+				if (sx != x)
+					sub.set(i++, sy - 1, mtx.get(sx, sy));
+		ret += (x % 2 ? -1 : 1) * mtx.get(x, 0) * cofactor_determinant(sub);
+	}
+	return ret;
+}
+BEGIN_TEST(test_mtx_lu)
+	for (unsigned int n = 1; n <= 7; ++n) {
+		Matrix mtx(n);
+		mtx.map_cells(unit_cell);
+		MATHTYPE expected = cofactor_determinant(mtx);
+		test_assert(fabs(mtx.determinant() - expected) < 0.0001, ", on closed form / LU determinant");
+		test_assert(fabs(mtx.lu().determinant() - expected) < 0.0001, ", on LU determinant");
+	}
+	// needs a row swap at every step
+	Matrix swapped(5);
+	for (unsigned int i = 0; i < 5; ++i)
+		swapped.set(4 - i, i, i + 1);
+	test_assert(swapped.determinant() == 120);
+	test_assert(swapped.lu().sign == 1);
+	Matrix singular(6);
+	singular.map_cells(indexed_cell);
+	test_assert(singular.lu().singular);
+	test_assert(singular.determinant() == 0);
+
+	// reuse one factorization for several right-hand sides
+	Matrix a(9);
+	a.map_cells(unit_cell);
+	LUDecomposition factors = a.lu();
+	for (unsigned int columns = 1; columns <= 3; ++columns) {
+		Matrix b(columns, 9);
+		b.map_cells(unit_cell);
+		Matrix x = factors.solve(b);
+		test_assert(x.width == columns && x.height == 9);
+		Matrix residual = a * x - b;
+		for (unsigned int cx = 0; cx < residual.width; ++cx)
+			for (unsigned int cy = 0; cy < residual.height; ++cy)
+				test_assert(fabs(residual.get(cx, cy)) < 0.001);
+	}
+END_TEST()
+
+BEGIN_TEST(test_mtx_views)
+	Matrix mtx(6, 5);
+	mtx.map_cells(indexed_cell);
+	// rows are contiguous, columns are strided by the width, both look straight into the buffer
+	StridedView row = mtx.row(2);
+	test_assert(row.data == mtx.data() + 12 && row.size == 6 && row.stride == 1);
+	StridedConstView column = static_cast<Matrix const &>(mtx).column(4);
+	test_assert(column.size == 5 && column.stride == 6 && column[3] == 43);
+	row[1] = -1;
+	test_assert(mtx.get(1, 2) == -1);
+	test_assert_throws(mtx.row(5), std::out_of_range);
+	test_assert_throws(mtx.column(6), std::out_of_range);
+	// the last columns iterate and sort in place, their end one step past the last row
+	MATHTYPE columnSum = 0;
+	for (MATHTYPE cell : column)
+		columnSum += cell;
+	test_assert(columnSum == 40 + 41 + 42 + 43 + 44 && column.end() - column.begin() == 5);
+	StridedView lastColumn = mtx.column(5);
+	std::sort(lastColumn.begin(), lastColumn.end(), [](MATHTYPE a, MATHTYPE b) { return a > b; });
+	test_assert(mtx.get(5, 0) == 54 && mtx.get(5, 4) == 50);
+	std::sort(lastColumn.begin(), lastColumn.end());
+
+	MatrixView block = mtx.submatrix(1, 2, 3, 2);
+	test_assert(block.width == 3 && block.height == 2 && block.stride == 6 && !block.contiguous());
+	test_assert(block(0, 0) == -1 && block(2, 1) == 33);
+	test_assert(block.column(1)[1] == 23 && block.row(1)[2] == 33);
+	test_assert(block.submatrix(1, 1, 2, 1)(1, 0) == 33);
+	test_assert_throws(mtx.submatrix(4, 0, 3, 1), std::out_of_range);
+	test_assert_throws(block.submatrix(0, 0, 1, 3), std::out_of_range);
+	test_assert_throws(mtx.submatrix(0, 0, 0, 2), std::out_of_range);
+	test_assert_throws(block.submatrix(3, 2, 0, 0), std::out_of_range);
+	Matrix copy(block);
+	test_assert(copy.width == 3 && copy.height == 2 && copy.get(0, 0) == -1 && copy.get(2, 1) == 33);
+
+	// in-place arithmetic only touches the block
+	Matrix before(mtx);
+	block += 100;
+	block *= 2;
+	block -= copy;
+	block /= 2;
+	for (unsigned int x = 0; x < 6; ++x)
+		for (unsigned int y = 0; y < 5; ++y) {
+			bool inside = x >= 1 && x < 4 && y >= 2 && y < 4;
+			MATHTYPE expected = inside ? (2 * (before.get(x, y) + 100) - before.get(x, y)) / 2 : before.get(x, y);
+			test_assert(mtx.get(x, y) == expected, ", on in-place view ops");
+		}
+	block -= block;
+	test_assert(mtx.get(1, 2) == 0 && mtx.get(3, 3) == 0 && mtx.get(0, 2) == before.get(0, 2));
+	test_assert_throws(block += Matrix(2), std::invalid_argument);
+	Matrix whole(6, 5);
+	whole.view() += before;
+	test_assert(whole == before);
+
+	// view arithmetic, mixing blocks and matrices
+	Matrix a(4, 4), b(4, 4);
+	a.map_cells(unit_cell);
+	b.map_cells(unit_cell);
+	MatrixConstView topLeft = static_cast<Matrix const &>(a).submatrix(0, 0, 2, 3);
+	MatrixConstView right = static_cast<Matrix const &>(b).submatrix(2, 1, 2, 2);
+	test_assert(topLeft * right == Matrix(topLeft) * Matrix(right));
+	test_assert(a.submatrix(1, 1, 3, 3) + b.submatrix(0, 0, 3, 3) == Matrix(a.submatrix(1, 1, 3, 3)) + Matrix(b.submatrix(0, 0, 3, 3)));
+	test_assert(a.submatrix(1, 1, 3, 3) - b.submatrix(0, 0, 3, 3) == Matrix(a.submatrix(1, 1, 3, 3)) - Matrix(b.submatrix(0, 0, 3, 3)));
+	test_assert(a - b.view() == a - b);
+	test_assert_throws(topLeft * topLeft, std::invalid_argument);
+	test_assert_throws(topLeft + right, std::invalid_argument);
+END_TEST()
+
+BEGIN_TEST(test_mtx_expr)
+	Matrix a(5, 4), b(3, 5), c(3, 4), d(3, 4), e(5, 4);
+	a.map_cells(unit_cell);
+	b.map_cells(unit_cell);
+	c.map_cells(unit_cell);
+	d.map_cells(unit_cell);
+	e.map_cells(unit_cell);
+
+	// elementwise chains fuse into one pass
+	Matrix fused = lazy(a) * 2 - e / 4 + 1;
+	test_assert(fused == a * 2 - e / 4 + 1, ", on fused elementwise chain");
+	test_assert(Matrix(-lazy(c) + d) == d - c);
+	test_assert(Matrix(3 * lazy(c) - 0.5 * d) == c * 3 - d * 0.5);
+
+	// products on the top-level sum accumulate into the destination with gemm
+	test_assert(Matrix(lazy(a) * b) == a * b, ", on lazy product");
+	test_assert(Matrix(lazy(a) * b + c) == a * b + c, ", on A*B + C");
+	test_assert(Matrix(c - lazy(a) * b) == c - a * b, ", on C - A*B");
+	test_assert(Matrix(lazy(a) * b * 2 - d) == a * b * 2 - d, ", on A*B*2 - D");
+	test_assert(Matrix(lazy(a) * b + lazy(c) * 2 - d) == a * b + c * 2 - d, ", on A*B + C*2 - D");
+	test_assert(Matrix(-(lazy(a) * b) / 2 + lazy(a) * b) == a * b / 2, ", on two spine products");
+	test_assert(Matrix(lazy(a) * b + 1) == a * b + 1, ", on A*B + scalar");
+	// nested expressions are materialized first
+	test_assert(Matrix((lazy(a) + e) * b) == (a + e) * b, ", on (A+B)*C");
+	test_assert(Matrix(lazy(a) * (lazy(b) * 2) - (lazy(a) * b) * 3) == a * b * -1, ", on nested products");
+	// a stored expression reads its inputs again on every evaluation, nested operands included
+	{
+		Matrix x = a, y = e;
+		auto stored = (lazy(x) + y) * b;
+		Matrix first = stored;
+		test_assert(first == (x + y) * b);
+		x(0, 0) += 10;
+		Matrix second = stored;
+		test_assert(second == (x + y) * b && !(second == first), ", on re-evaluated stored expression");
+	}
+
+	// assignment reuses the buffer, unless a product reads from it
+	Matrix dst(3, 4);
+	MATHTYPE const *buffer = dst.data();
+	dst = lazy(a) * b + c;
+	test_assert(dst.data() == buffer && dst == a * b + c);
+	dst = lazy(dst) * 2 - c;
+	test_assert(dst.data() == buffer && dst == (a * b + c) * 2 - c, ", on aliased elementwise chain");
+	Matrix square(4, 4), other(4, 4);
+	square.map_cells(unit_cell);
+	other.map_cells(unit_cell);
+	Matrix expected = square * other + other;
+	square = lazy(square) * other + other;
+	test_assert(square == expected, ", on product reading the destination");
+	// a different size reallocates
+	dst = lazy(a) * e.transposed();
+	test_assert(dst.width == 4 && dst.height == 4 && dst == a * e.transposed());
+	// temporaries are moved into the expression
+	Matrix fromTemporaries = lazy(a * b) + lazy(Matrix(c)) * 3;
+	test_assert(fromTemporaries == a * b + c * 3);
+
+	test_assert_throws(lazy(a) + b, std::invalid_argument);
+	test_assert_throws(lazy(c) - a, std::invalid_argument);
+	test_assert_throws(lazy(a) * a, std::invalid_argument);
+END_TEST()
+
+BEGIN_TEST(test_mtx_memory)
+	Matrix a(8, 8), b(8, 8);
+	a.map_cells(unit_cell);
+	b.map_cells(unit_cell);
+	Matrix expected = a * b + a;
+	test_assert(a.resource() == std::pmr::get_default_resource());
+
+	// statistics count the buffers made on this thread
+	AllocationStats before = allocation_stats();
+	{
+		Matrix product = a * b;
+		AllocationStats during = allocation_stats();
+		test_assert(during.allocations == before.allocations + 1 && during.live_bytes == before.live_bytes + 64 * sizeof(MATHTYPE));
+	}
+	AllocationStats after = allocation_stats();
+	test_assert(after.deallocations == before.deallocations + 1 && after.live_bytes == before.live_bytes);
+	reset_allocation_stats();
+	test_assert(allocation_stats().allocations == 0 && allocation_stats().live_bytes == after.live_bytes);
+
+	// a frame of temporaries from an arena, released by one reset
+	ArenaResource arena(4096);
+	Matrix result(8, 8);
+	for (int frame = 0; frame < 3; ++frame) {
+		{
+			ScopedMatrixResource scope(&arena);
+			test_assert(matrix_resource() == &arena);
+			Matrix temporary = a * b + a;
+			test_assert(temporary.resource() == &arena && temporary == expected);
+			test_assert(Matrix(temporary).resource() == &arena);
+			Matrix transposed = temporary.transposed();
+			transposed.transpose();
+			test_assert(transposed == expected);
+			// assigning an arena temporary to a long-lived matrix copies it out of the arena
+			MATHTYPE const *resultBuffer = result.data();
+			result = std::move(temporary);
+			test_assert(result.data() == resultBuffer && result.resource() == std::pmr::get_default_resource());
+			test_assert(temporary.resource() == &arena);
+		}
+		test_assert(matrix_resource() == std::pmr::get_default_resource());
+		test_assert(arena.used() >= 3 * 64 * sizeof(MATHTYPE));
+		arena.reset();
+		test_assert(arena.used() == 0 && result == expected);
+	}
+	// chunks are kept across resets
+	test_assert(arena.capacity() == 4096);
+	{
+		// larger than a chunk
+		ScopedMatrixResource scope(&arena);
+		Matrix big(40, 40);
+		test_assert(big.resource() == &arena && big.get(39, 39) == 0);
+		test_assert(arena.capacity() > 4096);
+	}
+
+	// small matrices from a size-class pool, scopes nest
+	std::pmr::unsynchronized_pool_resource pool;
+	{
+		ScopedMatrixResource outer(&pool);
+		Matrix small = Matrix::Identity(4);
+		{
+			ScopedMatrixResource inner(&arena);
+			test_assert(matrix_resource() == &arena);
+		}
+		test_assert(matrix_resource() == &pool);
+		small = small * 2;
+		test_assert(small.resource() == &pool && small == Matrix::Identity(4) * 2);
+		small.reduce_rows(+[](unsigned int, Matrix row) { return row.get(0, 0) + row.get(1, 0) + row.get(2, 0) + row.get(3, 0); });
+		test_assert(small.width == 1 && small.get(0, 3) == 2);
+	}
+	arena.reset();
+END_TEST()
+
+// Copy of mtx with rows padded to `alignment` bytes
+static Matrix padded_copy(Matrix const &mtx, size_t alignment)
+{
+	Matrix ret(mtx.width, mtx.height, Matrix::RowAlignment{ alignment });
+	ret.view() += mtx;
+	return ret;
+}
+
+BEGIN_TEST(test_mtx_layout)
+	Matrix padded(127, 3, Matrix::RowAlignment{ 64 });
+	size_t cellsPer64 = 64 / sizeof(MATHTYPE);
+	test_assert(padded.stride() % cellsPer64 == 0 && padded.stride() >= 127 && padded.stride() < 127 + cellsPer64);
+	for (unsigned int y = 0; y < 3; ++y)
+		test_assert(reinterpret_cast<uintptr_t>(padded.data() + y * padded.stride()) % 64 == 0, ", rows start 64-byte aligned");
+	test_assert(padded == Matrix(127, 3) && Matrix(5, 5).stride() == 5);
+	test_assert(Matrix(1024, 2, Matrix::RowAlignment{ 64 }).stride() == 1024 + cellsPer64, ", rows a whole number of pages apart are padded one step further");
+	padded.set(126, 2, 4);
+	test_assert(padded.get(126, 2) == 4 && padded(126, 2) == 4 && padded.data()[2 * padded.stride() + 126] == 4);
+	test_assert_throws(padded.get(127, 0), std::out_of_range);
+	test_assert_throws(Matrix(4, 4, Matrix::RowAlignment{ 3 }), std::invalid_argument);
+	test_assert_throws(Matrix(4, 4, Matrix::RowAlignment{ 48 }), std::invalid_argument);
+
+	// every operation gives the same cells whatever the layout of its operands
+	for (unsigned int n : { 3u, 4u, 7u, 17u }) {
+		Matrix a(n, n), b(n, n), rhs(2, n);
+		a.map_cells(unit_cell);
+		b.map_cells(unit_cell);
+		rhs.map_cells(unit_cell);
+		a = a + Matrix::Identity(n) * (MATHTYPE) n;
+		Matrix pa = padded_copy(a, 32), pb = padded_copy(b, 64);
+		test_assert(pa == a && pa.stride() % (32 / sizeof(MATHTYPE)) == 0);
+
+		test_assert(pa + pb == a + b && pa - b == a - b && a + pb == a + b, ", on padded +/-");
+		test_assert(pa * pb == a * b && a * pb == a * b, ", on padded product");
+		test_assert(pa * 3 == a * 3 && pa / 2 == a / 2 && pa - 1 == a - 1 && -pa == -a, ", on padded scalar ops");
+		test_assert(Matrix(pa) + 1 == a + 1 && (pa + pb).stride() == pa.stride(), ", results keep the layout");
+		test_assert(pa.transposed() == a.transposed() && pa.transposed().stride() % (32 / sizeof(MATHTYPE)) == 0);
+		test_assert(std::abs(pa.determinant() - a.determinant()) <= 1e-4 * std::abs(a.determinant()));
+		test_assert(pa.inverted() == a.inverted() && Matrix::solve(pa, padded_copy(rhs, 64)) == Matrix::solve(a, rhs));
+		test_assert(pa.mapped_cells(indexed_cell) == a.mapped_cells(indexed_cell));
+		test_assert(pa.reduced_rows([](unsigned int, StridedConstView row) { return row[row.size - 1]; })
+			== a.reduced_rows([](unsigned int, StridedConstView row) { return row[row.size - 1]; }));
+		test_assert(Matrix(lazy(pa) * pb + pa * 2 - b) == a * b + a * 2 - b, ", on lazy padded expression");
+		Matrix dst = padded_copy(a, 64);
+		dst = lazy(dst) * 2 + pb;
+		test_assert(dst == a * 2 + b && dst.stride() % (64 / sizeof(MATHTYPE)) == 0);
+		Matrix assigned(n, n);
+		assigned = pa;
+		test_assert(assigned == a && assigned.stride() == pa.stride());
+		pa.transpose();
+		test_assert(pa == a.transposed());
+	}
+
+	Matrix rotation = Matrix::rotate3Z(0.4) * Matrix::rotate3X(1.2);
+	Matrix paddedRotation = padded_copy(rotation, 64);
+	Vec3 v(1, -2, 3);
+	test_assert(paddedRotation * v == rotation * v);
+	test_assert(Matrix3(paddedRotation).to_matrix() == rotation);
+	Quaternion q = Quaternion::from_matrix(paddedRotation);
+	test_assert(q.to_matrix3() == rotation);
+	Matrix affine = padded_copy(Matrix::translate3(1, 2, 3) * Matrix::scale4(2, 2, 2, 1), 64);
+	std::vector<Vec3> points = { Vec3(1, 0, 0), Vec3(0, 1, -1) }, out(2);
+	affine.transform_points(points, out);
+	test_assert(out[0] == Vec3(3, 2, 3) && out[1] == Vec3(1, 4, 1));
+	Matrix column = padded_copy(Vec3(4, 5, 6).to_column(), 64);
+	test_assert(column.stride() > 1 && column.to_vec3() == Vec3(4, 5, 6));
+	column.reduce_columns(+[](unsigned int, Matrix c) { return c.get(0, 0) + c.get(0, 1) + c.get(0, 2); });
+	test_assert(column.width == 1 && column.height == 1 && column.get(0, 0) == 15);
+END_TEST()
+
+// Cell for cell, not within an epsilon
+static bool identical(Matrix const &a, Matrix const &b)
+{
+	if (a.width != b.width || a.height != b.height)
+		return false;
+	for (unsigned int y = 0; y < a.height; ++y)
+		for (unsigned int x = 0; x < a.width; ++x)
+			if (a(x, y) != b(x, y))
+				return false;
+	return true;
+}
+
+BEGIN_TEST(test_mtx_threads)
+	// big enough that every operation below is split across the pool
+	Matrix a(300, 200), b(250, 300), c(600, 500), d(600, 500);
+	a.map_cells(unit_cell);
+	b.map_cells(unit_cell);
+	c.map_cells(unit_cell);
+	d.map_cells(unit_cell);
+	Matrix paddedC = padded_copy(c, 64);
+	set_thread_count(1);
+	test_assert(thread_count() == 1);
+	Matrix product = a * b, sum = c + d, difference = paddedC - d, scaled = paddedC * 3, transposed = c.transposed();
+	Matrix mapped = c.mapped_cells(indexed_cell);
+
+	// no matter how the work is split, each cell is computed the same way
+	set_thread_count(4);
+	test_assert(thread_count() == 4);
+	for (int repeat = 0; repeat < 3; ++repeat) {
+		test_assert(identical(a * b, product) && identical(c + d, sum), ", on threaded * and +");
+		test_assert(identical(paddedC - d, difference) && identical(paddedC * 3, scaled), ", on threaded padded - and scalar *");
+		test_assert(identical(c.transposed(), transposed), ", on threaded transpose");
+		Matrix parallelMapped(c);
+		parallelMapped.map_cells_parallel(indexed_cell);
+		test_assert(identical(parallelMapped, mapped), ", on map_cells_parallel");
+	}
+
+	// ranges cover everything exactly once, including from inside another parallel_for
+	std::atomic<size_t> total = 0;
+	parallel_for(1000, 10, [&](size_t begin, size_t end) {
+		parallel_for(end - begin, 1, [&](size_t innerBegin, size_t innerEnd) {
+			for (size_t i = innerBegin; i < innerEnd; ++i)
+				total += begin + i;
+		});
+	});
+	test_assert(total == 1000 * 999 / 2);
+	// a thread waiting on its inner call never picks up another outer range meanwhile, even once the inner
+	// ranges left are all asleep on other threads
+	static thread_local bool waiting = false;
+	std::atomic<bool> overlapped = false;
+	for (int repeat = 0; repeat < 5; ++repeat)
+		parallel_for(64, 1, [&](size_t, size_t) {
+			if (waiting)
+				overlapped = true;
+			waiting = true;
+			parallel_for(64, 1, [&](size_t, size_t) {
+				std::this_thread::sleep_for(std::chrono::microseconds(200));
+			});
+			waiting = false;
+		});
+	test_assert(!overlapped, ", on helping with unrelated ranges");
+
+	// the first exception is rethrown on the calling thread, and the pool keeps working afterwards
+	auto throwing = [](unsigned int x, unsigned int, MATHTYPE cell) {
+		if (x == 599)
+			throw std::out_of_range("test");
+		return cell;
+	};
+	Matrix copy(c);
+	test_assert_throws(copy.map_cells_parallel(throwing), std::out_of_range);
+	test_assert(identical(c + d, sum));
+
+	// small work stays on the calling thread
+	std::thread::id caller = std::this_thread::get_id();
+	bool onCaller = true;
+	Matrix small(8, 8);
+	small.map_cells_parallel([&](unsigned int, unsigned int, MATHTYPE cell) {
+		onCaller = onCaller && std::this_thread::get_id() == caller;
+		return cell;
+	});
+	test_assert(onCaller);
+#ifdef __linux__
+	// and doesn't start the pool's threads either
+	auto process_threads = [] {
+		return std::distance(std::filesystem::directory_iterator("/proc/self/task"), std::filesystem::directory_iterator());
+	};
+	set_thread_count(4);
+	auto threadsBefore = process_threads();
+	Matrix smallSum = small + small;
+	test_assert(thread_count() == 4 && process_threads() == threadsBefore, ", on small work starting the pool");
+#endif
+	set_thread_count(0);
+	test_assert(thread_count() >= 1);
+END_TEST()
+
+template <typename T>
+static T swap_bytes(T value)
+{
+	unsigned char bytes[sizeof(T)];
+	std::memcpy(bytes, &value, sizeof(T));
+	std::reverse(bytes, bytes + sizeof(T));
+	std::memcpy(&value, bytes, sizeof(T));
+	return value;
+}
+
+BEGIN_TEST(test_mtx_io)
+	Matrix packed(7, 5);
+	packed.map_cells(unit_cell);
+	Matrix padded = padded_copy(packed, 64);
+
+	// stream round trips keep the cells and the row layout
+	for (Matrix const *source : { &packed, &padded }) {
+		std::stringstream stream;
+		source->write(stream);
+		Matrix back = Matrix::read(stream);
+		test_assert(identical(back, *source) && back.stride() == source->stride());
+	}
+	std::stringstream viewStream;
+	write_matrix(viewStream, padded.view().submatrix(1, 1, 4, 3));
+	test_assert(identical(Matrix::read(viewStream), Matrix(packed.view().submatrix(1, 1, 4, 3))));
+
+	// files map back without a copy, padding included
+	std::string path = (std::filesystem::temp_directory_path() / ("zmath_test_" + std::to_string(rand()) + ".zmtx")).string();
+	padded.write(path);
+	test_assert(identical(Matrix::read(path), padded));
+	{
+		MappedMatrix mapped(path);
+		test_assert(mapped.width() == 7 && mapped.height() == 5 && mapped.stride() == padded.stride());
+		test_assert(reinterpret_cast<uintptr_t>(mapped.data()) % 64 == 0);
+		test_assert(identical(Matrix(mapped.view()), padded));
+		test_assert(identical(Matrix(mapped) + packed, packed * 2));
+		test_assert_throws(mapped.as_vec3s(), std::invalid_argument);
+		MappedMatrix moved(std::move(mapped));
+		test_assert(moved.data() != nullptr && mapped.data() == nullptr);
+	}
+	Vec3 points[] = { Vec3(1, 2, 3), Vec3(4, 5, 6), Vec3(7, 8, 9) };
+	write_vectors(path, std::span<Vec3 const>(points));
+	{
+		MappedMatrix mapped(path);
+		std::span<Vec3 const> mappedPoints = mapped.as_vec3s();
+		test_assert(mappedPoints.size() == 3 && mappedPoints[1] == points[1] && mappedPoints[2] == points[2]);
+	}
+
+	// the other byte order and cell type convert on read, and refuse to map
+	MatrixFileHeader header = {};
+	std::memcpy(header.magic, "ZMTX", 4);
+	header.byteOrder = swap_bytes(MatrixFileHeader::BYTE_ORDER_MARK);
+	header.version = swap_bytes(MatrixFileHeader::VERSION);
+	header.cellType = swap_bytes(sizeof(MATHTYPE) == 4 ? MatrixFileHeader::CELL_FLOAT64 : MatrixFileHeader::CELL_FLOAT32);
+	header.width = swap_bytes(uint32_t(2));
+	header.height = swap_bytes(uint32_t(2));
+	header.stride = swap_bytes(uint64_t(3));
+	header.dataOffset = swap_bytes(uint64_t(64));
+	{
+		std::ofstream out(path, std::ios::binary);
+		out.write(reinterpret_cast<char const *>(&header), sizeof(header));
+		for (int cell : { 1, 2, 0, 3, 4 }) {
+			if (sizeof(MATHTYPE) == 4) {
+				double value = swap_bytes((double) cell);
+				out.write(reinterpret_cast<char const *>(&value), sizeof(value));
+			} else {
+				float value = swap_bytes((float) cell);
+				out.write(reinterpret_cast<char const *>(&value), sizeof(value));
+			}
+		}
+	}
+	Matrix converted = Matrix::read(path);
+	test_assert(converted.width == 2 && converted.height == 2);
+	test_assert(converted(0, 0) == 1 && converted(1, 0) == 2 && converted(0, 1) == 3 && converted(1, 1) == 4);
+	test_assert_throws(MappedMatrix(path), std::invalid_argument);
+
+	// not a matrix, or cut short
+	std::stringstream bad("ZMTY and then some more bytes to fill out a whole header, which is 64 bytes long");
+	test_assert_throws(Matrix::read(bad), std::invalid_argument);
+	std::stringstream whole;
+	packed.write(whole);
+	std::string bytes = whole.str();
+	std::stringstream truncated(bytes.substr(0, bytes.size() - 4));
+	test_assert_throws(Matrix::read(truncated), std::runtime_error);
+	{
+		std::ofstream out(path, std::ios::binary);
+		out.write(bytes.data(), (std::streamsize) bytes.size() - 4);
+	}
+	test_assert_throws(MappedMatrix(path), std::invalid_argument);
+	// nothing to write, and a file claiming no rows is no matrix file
+	std::stringstream empty;
+	test_assert_throws(write_vectors(empty, std::span<Vec3 const>()), std::invalid_argument);
+	test_assert(empty.str().empty());
+	MatrixFileHeader noRows;
+	std::memcpy(&noRows, bytes.data(), sizeof(noRows));
+	noRows.height = 0;
+	std::stringstream noRowsFile(std::string(reinterpret_cast<char const *>(&noRows), sizeof(noRows)) + bytes.substr(sizeof(noRows)));
+	test_assert_throws(Matrix::read(noRowsFile), std::invalid_argument);
+	// the last row's padding may be left out of a file
+	std::stringstream paddedWhole;
+	padded.write(paddedWhole);
+	std::string paddedBytes = paddedWhole.str();
+	paddedBytes.resize(paddedBytes.size() - (padded.stride() - padded.width) * sizeof(MATHTYPE));
+	std::stringstream unpaddedEnd(paddedBytes);
+	test_assert(identical(Matrix::read(unpaddedEnd), padded), ", on a file without the last row's padding");
+	{
+		std::ofstream out(path, std::ios::binary);
+		out.write(paddedBytes.data(), (std::streamsize) paddedBytes.size());
+	}
+	test_assert(identical(Matrix(MappedMatrix(path).view()), padded));
+	// a header whose sizes can't be allocated is no matrix file either, and nothing is allocated for it
+	for (int field = 0; field < 3; ++field) {
+		MatrixFileHeader corrupt;
+		std::memcpy(&corrupt, bytes.data(), sizeof(corrupt));
+		if (field == 0)
+			corrupt.stride = uint64_t(1) << 62;
+		else if (field == 1)
+			corrupt.stride = corrupt.height = 0xffffffffu;
+		else
+			corrupt.rowAlignment = 1u << 30;
+		std::stringstream corruptFile(std::string(reinterpret_cast<char const *>(&corrupt), sizeof(corrupt)) + bytes.substr(sizeof(corrupt)));
+		test_assert_throws(Matrix::read(corruptFile), std::invalid_argument);
+	}
+	std::stringstream overAligned;
+	test_assert_throws(Matrix(4, 4, Matrix::RowAlignment{ 8192 }).write(overAligned), std::invalid_argument);
+	std::remove(path.c_str());
+	test_assert_throws(MappedMatrix(path), std::runtime_error);
+	test_assert_throws(Matrix::read(path), std::runtime_error);
+END_TEST()
+BEGIN_TEST(test_mtx_strassen)
+	// small crossovers so these sizes recurse a few levels, odd sides get peeled at every level
+	unsigned int const shapes[][3] = { {64, 64, 64}, {67, 67, 67}, {45, 70, 33}, {100, 9, 120} };
+	for (auto const &shape : shapes) {
+		Matrix a(shape[2], shape[0]);
+		Matrix b(shape[1], shape[2]);
+		a.map_cells(unit_cell);
+		b.map_cells(unit_cell);
+		Matrix product = a * b;
+		for (unsigned int crossover : { 1u, 4u, 16u }) {
+			MultiplyPolicy policy{ MultiplyPolicy::StrassenWinograd, crossover };
+			for (Matrix const &paddedA : { a, padded_copy(a, 64) }) {
+				reset_allocation_stats();
+				Matrix strassen = paddedA.multiply(b, policy);
+				// the result and one workspace
+				test_assert(allocation_stats().allocations <= 2, ", allocated per level");
+				test_assert(strassen.width == product.width && strassen.height == product.height);
+				for (unsigned int y = 0; y < product.height; ++y)
+					for (unsigned int x = 0; x < product.width; ++x)
+						test_assert(fabs(strassen(x, y) - product(x, y)) < 0.001);
+			}
+		}
+		test_assert(identical(a.multiply(b, {}), product));
+		test_assert(identical(a.multiply(b, { MultiplyPolicy::StrassenWinograd }), product), ", below the default crossover");
+	}
+	test_assert_throws(Matrix(3, 4).multiply(Matrix(3, 4), { MultiplyPolicy::StrassenWinograd }), std::invalid_argument);
+END_TEST()
+
+// about one cell in `density` nonzero
+static Matrix sparse_cells(unsigned int w, unsigned int h, int density)
+{
+	return Matrix(w, h).mapped_cells([=](unsigned int, unsigned int, MATHTYPE) {
+		return rand() % density == 0 ? unit_cell(0, 0, 0) : MATHTYPE(0);
+	});
+}
+
+BEGIN_TEST(test_sparse_mtx)
+	Matrix dense = sparse_cells(40, 30, 8), other = sparse_cells(40, 30, 8);
+	size_t stored = 0;
+	for (unsigned int y = 0; y < dense.height; ++y)
+		for (unsigned int x = 0; x < dense.width; ++x)
+			stored += dense(x, y) != 0;
+	for (SparseMatrix::Format format : { SparseMatrix::CSR, SparseMatrix::CSC }) {
+		SparseMatrix sparse(dense, format);
+		test_assert(sparse.format() == format && sparse.nonzeros() == stored);
+		test_assert(sparse.offsets().size() == (format == SparseMatrix::CSR ? 31u : 41u));
+		test_assert(identical(sparse.to_dense(), dense));
+		test_assert(sparse.get(3, 7) == dense(3, 7) && sparse.get(39, 29) == dense(39, 29));
+		test_assert_throws(sparse.get(40, 0), std::out_of_range);
+
+		// conversions and the transpose keep every cell
+		SparseMatrix converted = sparse.to_format(format == SparseMatrix::CSR ? SparseMatrix::CSC : SparseMatrix::CSR);
+		test_assert(converted.format() != format && identical(converted.to_dense(), dense));
+		SparseMatrix transposed = sparse.transposed();
+		test_assert(transposed.width == 30 && transposed.height == 40 && transposed.format() != format);
+		test_assert(identical(transposed.to_dense(), dense.transposed()));
+		test_assert(identical(SparseMatrix(sparse).transposed().transposed().to_dense(), dense));
+
+		// elementwise, against either format on the right
+		SparseMatrix sparseOther(other, SparseMatrix::CSR);
+		test_assert(identical((sparse + sparseOther).to_dense(), dense + other));
+		test_assert(identical((sparse - sparseOther).to_dense(), dense - other));
+		test_assert(identical((-sparse).to_dense(), -dense) && identical((sparse * 3).to_dense(), dense * 3));
+		test_assert(identical((2 * sparse / 4).to_dense(), dense * 2 / 4));
+		test_assert((sparse + sparseOther).format() == format);
+		test_assert_throws(sparse + SparseMatrix(30, 40), std::invalid_argument);
+		SparseMatrix mapped(sparse);
+		mapped.map_values([&](unsigned int x, unsigned int y, MATHTYPE value) {
+			test_assert(value == dense(x, y));
+			return value + 1;
+		});
+		test_assert(mapped.nonzeros() == stored && mapped.get(0, 0) == (dense(0, 0) != 0 ? dense(0, 0) + 1 : 0));
+
+		// products, against the dense ones
+		Matrix x(1, 40), columns = padded_copy(Matrix(5, 40), 64);
+		x.map_cells(unit_cell);
+		columns.map_cells(unit_cell);
+		std::vector<MATHTYPE> xCells(40), y(30);
+		for (unsigned int i = 0; i < 40; ++i)
+			xCells[i] = x(0, i);
+		sparse.multiply(xCells, y);
+		Matrix expected = dense * x, product = sparse * columns, expectedProduct = dense * columns;
+		for (unsigned int i = 0; i < 30; ++i)
+			test_assert(fabs(y[i] - expected(0, i)) < 0.0001);
+		for (unsigned int row = 0; row < 30; ++row)
+			for (unsigned int column = 0; column < 5; ++column)
+				test_assert(fabs(product(column, row) - expectedProduct(column, row)) < 0.0001);
+		test_assert_throws(sparse.multiply(std::span<MATHTYPE const>(xCells).first(39), y), std::invalid_argument);
+		test_assert_throws(sparse * Matrix(5, 30), std::invalid_argument);
+
+		std::vector<Vec3> points(40), moved(30);
+		for (Vec3 &point : points)
+			point = Vec3(unit_cell(0, 0, 0), unit_cell(0, 0, 0), unit_cell(0, 0, 0));
+		sparse.multiply(points, moved);
+		for (unsigned int row = 0; row < 30; ++row) {
+			Vec3 sum(0, 0, 0);
+			for (unsigned int column = 0; column < 40; ++column)
+				sum = sum + points[column] * dense(column, row);
+			test_assert(fabs(moved[row].x - sum.x) < 0.0001 && fabs(moved[row].z - sum.z) < 0.0001);
+		}
+	}
+
+	// duplicates summed, order doesn't matter
+	SparseMatrix::Triplet const triplets[] = { {2, 1, 1}, {0, 0, 2}, {2, 1, 3}, {1, 2, 4}, {0, 1, 5} };
+	for (SparseMatrix::Format format : { SparseMatrix::CSR, SparseMatrix::CSC }) {
+		SparseMatrix built = SparseMatrix::from_triplets(3, 3, triplets, format);
+		test_assert(built.nonzeros() == 4 && built.get(2, 1) == 4 && built.get(0, 1) == 5 && built.get(1, 1) == 0);
+	}
+	SparseMatrix::Triplet const outside[] = { {3, 0, 1} };
+	test_assert_throws(SparseMatrix::from_triplets(3, 3, outside), std::out_of_range);
+	test_assert(SparseMatrix(dense, SparseMatrix::CSR, 0.5).nonzeros() < stored);
+
+	// SpMV split across threads sums every row in the same order
+	SparseMatrix large(sparse_cells(2000, 3000, 50));
+	std::vector<MATHTYPE> x(2000), single(3000), threaded(3000);
+	for (MATHTYPE &cell : x)
+		cell = unit_cell(0, 0, 0);
+	set_thread_count(1);
+	large.multiply(x, single);
+	set_thread_count(4);
+	large.multiply(x, threaded);
+	set_thread_count(0);
+	test_assert(single == threaded);
+END_TEST()
+
+// largest difference between two matrices of the same size
+static MATHTYPE max_difference(Matrix const &a, Matrix const &b)
+{
+	MATHTYPE ret = 0;
+	for (unsigned int y = 0; y < a.height; ++y)
+		for (unsigned int x = 0; x < a.width; ++x)
+			ret = std::max<MATHTYPE>(ret, fabs(a(x, y) - b(x, y)));
+	return ret;
+}
+
+BEGIN_TEST(test_packed_mtx)
+	unsigned int const n = 70;
+	Matrix dense = Matrix(n).mapped_cells(unit_cell), rhs = padded_copy(Matrix(3, n).mapped_cells(unit_cell), 64);
+	// dominant diagonal so every solve below is well conditioned
+	for (unsigned int i = 0; i < n; ++i)
+		dense(i, i) += n;
+	std::vector<MATHTYPE> x(n), y(n);
+	for (MATHTYPE &cell : x)
+		cell = unit_cell(0, 0, 0);
+	Matrix xColumn(1, n);
+	for (unsigned int i = 0; i < n; ++i)
+		xColumn(0, i) = x[i];
+	// y against the dense product
+	auto check_vector_product = [&](Matrix const &expected) {
+		for (unsigned int i = 0; i < n; ++i)
+			test_assert(fabs(y[i] - expected(0, i)) < 0.001, ", on span multiply");
+	};
+
+	for (TriangularMatrix::Part part : { TriangularMatrix::Lower, TriangularMatrix::Upper }) {
+		bool lower = part == TriangularMatrix::Lower;
+		Matrix masked = dense.mapped_cells([=](unsigned int cx, unsigned int cy, MATHTYPE cell) {
+			return (lower ? cx <= cy : cx >= cy) ? cell : MATHTYPE(0);
+		});
+		TriangularMatrix triangle(dense, part);
+		test_assert(triangle.part() == part && triangle.cells().size() == n * (n + 1) / 2);
+		test_assert(identical(triangle.to_dense(), masked));
+		test_assert(triangle.get(3, 5) == masked(3, 5) && triangle.get(5, 3) == masked(5, 3));
+		test_assert_throws(triangle.set(lower ? 5 : 3, lower ? 3 : 5, 1), std::out_of_range);
+		TriangularMatrix transposed = triangle.transposed();
+		test_assert(transposed.part() != part && identical(transposed.to_dense(), masked.transposed()));
+		test_assert(max_difference(triangle * rhs, masked * rhs) < 0.001);
+		triangle.multiply(x, y);
+		check_vector_product(masked * xColumn);
+		test_assert(max_difference(masked * triangle.solve(rhs), rhs) < 0.001, ", on triangular solve");
+		test_assert(max_difference(masked.transposed() * transposed.solve(rhs), rhs) < 0.001);
+		TriangularMatrix singular(triangle);
+		singular.set(7, 7, 0);
+		test_assert_throws(singular.solve(rhs), std::invalid_argument);
+	}
+
+	// symmetric positive definite: dense^T dense
+	Matrix spd = dense.transposed() * dense;
+	SymmetricMatrix symmetric(spd);
+	test_assert(symmetric.cells().size() == n * (n + 1) / 2);
+	Matrix mirrored = symmetric.to_dense();
+	test_assert(identical(mirrored, mirrored.transposed()) && mirrored(3, 9) == spd(3, 9) && symmetric.get(3, 9) == spd(9, 3));
+	symmetric.set(2, 6, 5);
+	test_assert(symmetric.get(6, 2) == 5);
+	symmetric.set(2, 6, spd(2, 6));
+	test_assert(identical(symmetric.transposed().to_dense(), mirrored));
+	test_assert(max_difference(symmetric * rhs, mirrored * rhs) < 0.01);
+	symmetric.multiply(x, y);
+	Matrix expectedSymmetric = mirrored * xColumn;
+	for (unsigned int i = 0; i < n; ++i)
+		test_assert(fabs(y[i] - expectedSymmetric(0, i)) < 0.01);
+	Matrix l = symmetric.cholesky().to_dense();
+	test_assert(max_difference(l * l.transposed(), mirrored) / n < 0.001, ", on cholesky");
+	test_assert(max_difference(mirrored * symmetric.solve(rhs), rhs) < 0.001, ", on symmetric solve");
+	symmetric.set(4, 4, -1);
+	test_assert_throws(symmetric.cholesky(), std::invalid_argument);
+
+	unsigned int const bands[][2] = { {0, 0}, {1, 1}, {2, 3}, {5, 0}, {0, 4}, {n - 1, n - 1} };
+	for (auto const &band : bands) {
+		Matrix masked = dense.mapped_cells([&](unsigned int cx, unsigned int cy, MATHTYPE cell) {
+			return cy <= cx + band[0] && cx <= cy + band[1] ? cell : MATHTYPE(0);
+		});
+		BandedMatrix banded(dense, band[0], band[1]);
+		test_assert(banded.cells().size() == n * (band[0] + band[1] + 1));
+		test_assert(identical(banded.to_dense(), masked));
+		BandedMatrix transposed = banded.transposed();
+		test_assert(transposed.lower == band[1] && transposed.upper == band[0]);
+		test_assert(identical(transposed.to_dense(), masked.transposed()));
+		test_assert(max_difference(banded * rhs, masked * rhs) < 0.001);
+		banded.multiply(x, y);
+		check_vector_product(masked * xColumn);
+		test_assert(max_difference(masked * banded.solve(rhs), rhs) < 0.001, ", on banded solve");
+	}
+	// pivoting: a tridiagonal matrix with zeros on its diagonal
+	BandedMatrix tridiagonal(6, 1, 1);
+	for (unsigned int i = 0; i + 1 < 6; ++i) {
+		tridiagonal.set(i + 1, i, 1 + i);
+		tridiagonal.set(i, i + 1, 2 + i);
+	}
+	Matrix tridiagonalRhs = Matrix(2, 6).mapped_cells(unit_cell);
+	test_assert(max_difference(tridiagonal.to_dense() * tridiagonal.solve(tridiagonalRhs), tridiagonalRhs) < 0.001, ", on pivoted banded solve");
+	test_assert_throws(tridiagonal.set(3, 0, 1), std::out_of_range);
+	test_assert_throws(BandedMatrix(6, 1, 1).solve(tridiagonalRhs), std::invalid_argument);
+	test_assert_throws(BandedMatrix(6, 6, 0), std::invalid_argument);
+	test_assert_throws(TriangularMatrix(Matrix(3, 4)), std::invalid_argument);
+END_TEST()
+BEGIN_TEST(test_mtx_qr)
+	// tall and square, past one panel so the blocked update runs, with padded rows
+	unsigned int const shapes[][2] = { {5, 5}, {12, 7}, {100, 40}, {90, 70} };
+	for (auto const &shape : shapes) {
+		unsigned int m = shape[0], n = shape[1];
+		Matrix a = padded_copy(Matrix(n, m).mapped_cells(unit_cell), 64);
+		QRDecomposition qr = a.qr();
+		Matrix q = qr.q(), r = qr.r();
+		test_assert(q.width == n && q.height == m && r.width == n && r.height == n);
+		test_assert(max_difference(q.transposed() * q, Matrix::Identity(n)) < 0.001, ", on Q^T Q");
+		test_assert(max_difference(q * r, a) < 0.001, ", on Q R");
+		for (unsigned int y = 1; y < n; ++y)
+			for (unsigned int x = 0; x < y; ++x)
+				test_assert(r(x, y) == 0, ", below the diagonal of R");
+
+		// at the least squares solution the residual is orthogonal to the columns of A
+		Matrix b = Matrix(3, m).mapped_cells(unit_cell);
+		Matrix x = Matrix::lstsq(a, b);
+		test_assert(x.width == 3 && x.height == n);
+		test_assert(max_difference(a.transposed() * (a * x - b), Matrix(3, n)) < 0.001, ", on A^T (A X - B)");
+		test_assert(max_difference(qr.solve(b), x) < 0.001, ", on QRDecomposition::solve");
+	}
+	// tall-skinny, within a single panel, against the normal equations
+	for (unsigned int n = 1; n <= 6; ++n) {
+		Matrix a = Matrix(n, 50).mapped_cells(unit_cell), b = Matrix(2, 50).mapped_cells(unit_cell);
+		Matrix x = Matrix::lstsq(a, b);
+		Matrix at = a.transposed();
+		test_assert(max_difference(x, Matrix::solve(at * a, at * b)) < 0.001, ", on normal equations");
+		test_assert(max_difference(a.qr().solve(b), x) < 0.001);
+	}
+	Matrix a3 = Matrix(3, 20).mapped_cells(unit_cell), a4 = Matrix(4, 20).mapped_cells(unit_cell);
+	Matrix b1 = Matrix(1, 20).mapped_cells(unit_cell);
+	std::vector<Vec3> rows3;
+	std::vector<Vec4> rows4;
+	std::vector<MATHTYPE> rhs;
+	for (unsigned int y = 0; y < 20; ++y) {
+		rows3.push_back(Vec3(a3(0, y), a3(1, y), a3(2, y)));
+		rows4.push_back(Vec4(a4(0, y), a4(1, y), a4(2, y), a4(3, y)));
+		rhs.push_back(b1(0, y));
+	}
+	Vec3 x3 = Matrix::lstsq(std::span<Vec3 const>(rows3), rhs);
+	Vec4 x4 = Matrix::lstsq(std::span<Vec4 const>(rows4), rhs);
+	Matrix expected3 = Matrix::lstsq(a3, b1), expected4 = Matrix::lstsq(a4, b1);
+	test_assert(fabs(x3.x - expected3(0, 0)) < 0.001 && fabs(x3.y - expected3(0, 1)) < 0.001 && fabs(x3.z - expected3(0, 2)) < 0.001);
+	test_assert(fabs(x4.x - expected4(0, 0)) < 0.001 && fabs(x4.w - expected4(0, 3)) < 0.001);
+
+	// the workspace is kept, writing into a view allocates nothing the second time
+	Matrix wide = Matrix(40, 100).mapped_cells(unit_cell), wideRhs = Matrix(2, 100).mapped_cells(unit_cell), out(2, 40);
+	Matrix::lstsq(wide.view(), wideRhs.view(), out.view());
+	reset_allocation_stats();
+	Matrix::lstsq(wide.view(), wideRhs.view(), out.view());
+	test_assert(allocation_stats().allocations == 0, ", on repeated lstsq");
+	Matrix::lstsq(wide, wideRhs);
+	test_assert(allocation_stats().allocations == 1, ", on repeated lstsq");
+
+	// fits from inside a parallel_for, each of whose transposes and products runs parallel_for again, match
+	// the same fits made one after another
+	set_thread_count(4);
+	std::vector<Matrix> problems, problemRhs, expected;
+	for (unsigned int i = 0; i < 16; ++i) {
+		// tall enough that the transposes go parallel, and wide enough for the blocked update
+		unsigned int n = i % 2 ? 3 : 40, m = i % 2 ? 100000 : 2000;
+		problems.push_back(Matrix(n, m).mapped_cells(unit_cell));
+		problemRhs.push_back(Matrix(1, m).mapped_cells(unit_cell));
+		expected.push_back(Matrix::lstsq(problems.back(), problemRhs.back()));
+	}
+	std::vector<Matrix> solved(problems.size(), Matrix(1, 1));
+	for (int repeat = 0; repeat < 3; ++repeat) {
+		parallel_for(problems.size(), 1, [&](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; ++i)
+				solved[i] = Matrix::lstsq(problems[i], problemRhs[i]);
+		});
+		for (size_t i = 0; i < problems.size(); ++i)
+			test_assert(max_difference(solved[i], expected[i]) < 0.001, ", on lstsq inside parallel_for");
+	}
+	set_thread_count(0);
+
+	test_assert_throws(Matrix(4, 3).qr(), std::invalid_argument);
+	test_assert_throws(Matrix::lstsq(Matrix(4, 3), Matrix(1, 3)), std::invalid_argument);
+	test_assert_throws(Matrix::lstsq(Matrix(2, 3), Matrix(1, 4)), std::invalid_argument);
+	// rank deficient
+	test_assert_throws(Matrix::lstsq(Matrix(3, 6), Matrix(1, 6)), std::invalid_argument);
+	test_assert_throws(Matrix::lstsq(Matrix(6, 8), Matrix(1, 8)), std::invalid_argument);
+	test_assert_throws(Matrix::lstsq(std::span<Vec3 const>(rows3.data(), 2), std::span<MATHTYPE const>(rhs.data(), 2)), std::invalid_argument);
+END_TEST()
+BEGIN_TEST(test_mtx_eigen)
+	for (unsigned int n : { 1u, 2u, 3u, 8u, 30u }) {
+		Matrix cells = Matrix(n).mapped_cells(unit_cell);
+		Matrix symmetric = cells + cells.transposed();
+		SymmetricEigen eigen = symmetric.eigen_symmetric();
+		test_assert(eigen.values.size() == n && eigen.vectors.width == n && eigen.vectors.height == n);
+		test_assert(std::is_sorted(eigen.values.begin(), eigen.values.end()), ", on ascending eigenvalues");
+		Matrix lambda(n);
+		for (unsigned int i = 0; i < n; ++i)
+			lambda(i, i) = eigen.values[i];
+		test_assert(max_difference(eigen.vectors.transposed() * eigen.vectors, Matrix::Identity(n)) < 0.001, ", on V^T V");
+		test_assert(max_difference(symmetric * eigen.vectors, eigen.vectors * lambda) < 0.001, ", on A V = V L");
+		// the upper triangle is never read
+		Matrix lower = symmetric.mapped_cells([](unsigned int x, unsigned int y, MATHTYPE cell) {
+			return x <= y ? cell : MATHTYPE(0);
+		});
+		test_assert(lower.eigen_symmetric().values == eigen.values);
+	}
+	SymmetricEigen repeated = (Matrix::Identity(4) * 2).eigen_symmetric();
+	test_assert(repeated.values == std::vector<MATHTYPE>(4, 2) && identical(repeated.vectors, Matrix::Identity(4)));
+	test_assert_throws(Matrix(3, 4).eigen_symmetric(), std::invalid_argument);
+
+	// random, then the ones with repeated or zero eigenvalues, where the closed form has to pick vectors
+	std::vector<Matrix3> matrices;
+	for (unsigned int i = 0; i < 300; ++i) {
+		Matrix3 mtx;
+		for (unsigned int y = 0; y < 3; ++y)
+			for (unsigned int x = 0; x <= y; ++x)
+				mtx(x, y) = mtx(y, x) = unit_cell(x, y, 0) * 10;
+		matrices.push_back(mtx);
+	}
+	matrices.push_back(Matrix3::Zero());
+	matrices.push_back(Matrix3::Identity() * 3);
+	matrices.push_back(Matrix3::scale3(1, 1, 2));
+	matrices.push_back(Matrix3::scale3(5, -1, 5));
+	matrices.push_back(Matrix3::scale3(1e-20f, 2e-20f, 3e-20f));
+	Matrix3 outer;
+	MATHTYPE const axis[3] = { 1, 2, 3 };
+	for (unsigned int y = 0; y < 3; ++y)
+		for (unsigned int x = 0; x < 3; ++x)
+			outer(x, y) = axis[x] * axis[y];
+	matrices.push_back(outer);
+	std::vector<Vec3> values(matrices.size()), valuesOnly(matrices.size()), vectors(3 * matrices.size());
+	eigen_symmetric3(matrices, values, vectors);
+	eigen_symmetric3(matrices, valuesOnly);
+	for (size_t i = 0; i < matrices.size(); ++i) {
+		SymmetricEigen expected = matrices[i].to_matrix().eigen_symmetric();
+		MATHTYPE const found[3] = { values[i].x, values[i].y, values[i].z };
+		MATHTYPE scale = std::max(fabs(expected.values[0]), fabs(expected.values[2]));
+		for (unsigned int k = 0; k < 3; ++k) {
+			test_assert(fabs(found[k] - expected.values[k]) <= 0.001 * scale, ", on 3x3 eigenvalues");
+			Vec3 const &v = vectors[3 * i + k];
+			test_assert(fabs(v.x * v.x + v.y * v.y + v.z * v.z - 1) < 0.001, ", on unit eigenvectors");
+			Vec3 av = matrices[i] * v;
+			test_assert(fabs(av.x - found[k] * v.x) + fabs(av.y - found[k] * v.y) + fabs(av.z - found[k] * v.z) <= 0.001 * scale, ", on A v = l v");
+		}
+		Vec3 const &a = vectors[3 * i], &b = vectors[3 * i + 1], &c = vectors[3 * i + 2];
+		test_assert(fabs(a.x * b.x + a.y * b.y + a.z * b.z) < 0.001 && fabs(a.x * c.x + a.y * c.y + a.z * c.z) < 0.001, ", on orthogonal eigenvectors");
+		test_assert(valuesOnly[i].x == values[i].x && valuesOnly[i].y == values[i].y && valuesOnly[i].z == values[i].z);
+	}
+	test_assert_throws(eigen_symmetric3(matrices, std::span<Vec3>(values).first(3)), std::invalid_argument);
+	test_assert_throws(eigen_symmetric3(matrices, values, std::span<Vec3>(vectors).first(3)), std::invalid_argument);
 END_TEST()
+
+
+BEGIN_TEST(test_mtx_inverse)
+	// diagonally dominant so every size stays well conditioned, covers the closed forms and LU
+	for (unsigned int n = 1; n <= 7; ++n) {
+		Matrix mtx = Matrix::Identity(n) * (MATHTYPE) n + Matrix(n).mapped_cells(unit_cell);
+		Matrix inverse = mtx.inverted();
+		test_assert(mtx * inverse == Matrix::Identity(n), ", on M * M^-1");
+		test_assert(inverse * mtx == Matrix::Identity(n), ", on M^-1 * M");
+		test_assert(mtx.lu().inverse() == inverse, ", on LU inverse");
+		Matrix inPlace(mtx);
+		inPlace.invert();
+		test_assert(inPlace == inverse);
+	}
+	test_assert(Matrix::Identity(6).inverted() == Matrix::Identity(6));
+	Matrix4 static4 = Matrix4::Identity() * 4 + Matrix4(Matrix(4).mapped_cells(unit_cell));
+	test_assert(static4 * static4.inverted() == Matrix4::Identity());
+	test_assert(static4.inverted().to_matrix() == static4.to_matrix().inverted());
+	Matrix singular(5);
+	singular.map_cells(indexed_cell);
+	test_assert_throws(singular.inverted(), std::invalid_argument);
+	test_assert_throws(Matrix(3, 4).inverted(), std::invalid_argument);
+
+	// affine: translation * rotation * non-uniform scale
+	Matrix rotation = Matrix::Identity(4);
+	Matrix rotation3 = Matrix::rotate3Z(0.7) * Matrix::rotate3Y(-1.1);
+	for (unsigned int x = 0; x < 3; ++x)
+		for (unsigned int y = 0; y < 3; ++y)
+			rotation.set(x, y, rotation3.get(x, y));
+	Matrix affine = Matrix::translate3(1, -2, 3) * rotation * Matrix::scale4(2, 0.5, 3, 1);
+	Matrix affineInverse = affine.inverted_affine();
+	test_assert(affineInverse == affine.inverted());
+	test_assert(affine * affineInverse == Matrix::Identity(4));
+	test_assert(Matrix4(affine).inverted_affine() == Matrix4(affineInverse));
+	Matrix affine2 = Matrix::translate2(4, 5) * Matrix::scale3(2, 4, 1);
+	test_assert(affine2.inverted_affine() == affine2.inverted());
+	affine.invert_affine();
+	test_assert(affine == affineInverse);
+	test_assert_throws(Matrix::scale4(1, 1, 1, 2).inverted_affine(), std::invalid_argument);
+	test_assert_throws(Matrix::Identity(5).inverted_affine(), std::invalid_argument);
+
+	// solve factors once for every column
+	Matrix a = Matrix::Identity(8) * 8 + Matrix(8).mapped_cells(unit_cell);
+	Matrix b(3, 8);
+	b.map_cells(unit_cell);
+	Matrix x = Matrix::solve(a, b);
+	test_assert(a * x == b);
+	test_assert(x == a.inverted() * b);
+	test_assert_throws(Matrix::solve(a, Matrix(1, 7)), std::invalid_argument);
+END_TEST()
+
 #define PI 3.1415926535
 BEGIN_TEST(test_mtx_vec_ops)
 	// rotation CCW by PI/2
@@ -280,6 +1433,57 @@ BEGIN_TEST(test_mtx_vec_ops)
 	Vec3 vec3(1, 0, 1);
 	test_assert(transform3 * vec3 == Vec3(0, 1, 1));
 END_TEST()
+BEGIN_TEST(test_mtx_transform)
+	Matrix m3 = Matrix::rotate3Z(0.3) * Matrix::scale3(2, -1, 0.5);
+	Matrix m4 = Matrix::translate3(1, 2, 3) * Matrix::scale4(2, 3, 4, 1);
+	Matrix perspective = Matrix::Identity(4);
+	perspective.set(2, 3, -1);
+	perspective.set(3, 3, 0);
+	perspective.set(3, 2, 0.5);
+	// matrix * vector doesn't go through temporary matrices anymore
+	unsigned long allocationsBefore = allocation_stats().allocations;
+	Vec3 single = m3 * Vec3(1, 2, 3);
+	test_assert(allocation_stats().allocations == allocationsBefore);
+	test_assert(single == (m3 * Vec3(1, 2, 3).to_column()).to_vec3());
+
+	// sizes around the batch width, for the remainder loop
+	for (unsigned int n : {0u, 1u, 15u, 16u, 17u, 37u}) {
+		std::vector<Vec3> in3, out3;
+		std::vector<Vec4> in4, out4;
+		for (unsigned int i = 0; i < n; ++i) {
+			in3.emplace_back(unit_cell(0, 0, 0), unit_cell(0, 0, 0), unit_cell(0, 0, 0) + 2);
+			in4.emplace_back(unit_cell(0, 0, 0), unit_cell(0, 0, 0), unit_cell(0, 0, 0), 1);
+			out3.emplace_back();
+			out4.emplace_back();
+		}
+		m3.transform(in3, out3);
+		for (unsigned int i = 0; i < n; ++i)
+			test_assert(out3[i] == m3 * in3[i], ", on transform(Vec3)");
+		m4.transform(in4, out4);
+		for (unsigned int i = 0; i < n; ++i)
+			test_assert(out4[i] == m4 * in4[i], ", on transform(Vec4)");
+		m4.transform_points(in3, out3);
+		for (unsigned int i = 0; i < n; ++i)
+			test_assert(out3[i] == (m4 * in3[i].extended(1)).shortened(), ", on transform_points");
+		m4.transform_directions(in3, out3);
+		for (unsigned int i = 0; i < n; ++i)
+			test_assert(out3[i] == (m4 * in3[i].extended(0)).shortened(), ", on transform_directions");
+		perspective.transform_points(in3, out3);
+		for (unsigned int i = 0; i < n; ++i) {
+			Vec4 clip = perspective * in3[i].extended(1);
+			test_assert(out3[i] == clip.shortened() / clip.w, ", on projective transform_points");
+		}
+		// in place
+		std::vector<Vec3> inPlace(in3);
+		m3.transform(inPlace, inPlace);
+		for (unsigned int i = 0; i < n; ++i)
+			test_assert(inPlace[i] == m3 * in3[i], ", on in-place transform");
+	}
+	std::vector<Vec3> three(3), two(2);
+	test_assert_throws(m3.transform(three, two), std::invalid_argument);
+	test_assert_throws(m4.transform(three, three), std::invalid_argument);
+	test_assert_throws(m3.transform_points(three, three), std::invalid_argument);
+END_TEST()
 BEGIN_TEST(test_mtx_unary_ops)
 	Matrix mtx(3, 5);
 	mtx.map_cells(rand_cell);
@@ -296,6 +1500,33 @@ BEGIN_TEST(test_mtx_unary_ops)
 		for (unsigned int y = 0; y < transposed.height; ++y)
 			test_assert(transposed.get(x, y) == mtx.get(y, x));
 
+	// blocked transposes, on sizes around the tile edge, packed and padded
+	for (unsigned int w : { 1u, 31u, 32u, 33u, 70u }) {
+		for (unsigned int h : { 1u, 33u, 70u }) {
+			Matrix source(w, h);
+			source.map_cells(indexed_cell);
+			Matrix expected(h, w);
+			expected.map_cells([&](unsigned int x, unsigned int y, MATHTYPE) { return source.get(y, x); });
+			for (size_t alignment : { size_t(0), size_t(64) }) {
+				Matrix original = alignment ? padded_copy(source, alignment) : source;
+				reset_allocation_stats();
+				Matrix copy = original.transposed();
+				test_assert(allocation_stats().allocations == 1, ", transposed() allocates only its result");
+				test_assert(identical(copy, expected) && copy.stride() == (alignment ? padded_copy(expected, alignment) : expected).stride());
+				copy.transpose();
+				test_assert(identical(copy, source));
+			}
+		}
+	}
+	Matrix square(70, 70);
+	square.map_cells(indexed_cell);
+	Matrix squareT = square.transposed();
+	reset_allocation_stats();
+	square.transpose();
+	test_assert(identical(square, squareT));
+	square = std::move(square).transposed();
+	test_assert(allocation_stats().allocations == 0, ", square transposes happen in place");
+
 	Matrix ident = Matrix::Identity(5);
 	MATHTYPE identDet = ident.determinant();
 	test_assert(identDet == 1);
@@ -417,6 +1648,47 @@ BEGIN_TEST(test_mtx_apply_ops)
 	Matrix reducedColumns = mtx.reduced_columns(col_sum);
 	for (unsigned int x = 0; x < reducedColumns.width; ++x)
 		test_assert(reducedColumns.get(x, 0) == col_sum(x, mtx.get_column(x)));
+
+	// callable overloads, capturing state and getting views instead of copies
+	MATHTYPE offset = 2;
+	Matrix shifted = mtx.mapped_cells([offset](unsigned int, unsigned int, MATHTYPE cell) { return cell + offset; });
+	test_assert(shifted == mtx + offset);
+	unsigned int calls = 0;
+	Matrix counted(mtx);
+	counted.map_cells([&calls](unsigned int x, unsigned int y, MATHTYPE) { ++calls; return MATHTYPE(y * 10 + x); });
+	test_assert(calls == 15 && counted.get(2, 4) == 42);
+	Matrix rowsScaled(mtx);
+	rowsScaled.map_rows([](unsigned int y, StridedView row) {
+		for (MATHTYPE &cell : row)
+			cell *= y;
+	});
+	for (unsigned int x = 0; x < 3; ++x)
+		for (unsigned int y = 0; y < 5; ++y)
+			test_assert(rowsScaled.get(x, y) == mtx.get(x, y) * y);
+	Matrix columnsIndexed = mtx.mapped_columns([](unsigned int x, StridedView column) {
+		test_assert(column.size == 5 && column.stride == 3);
+		for (size_t y = 0; y < column.size; ++y)
+			column[y] = x * 10 + y;
+	});
+	test_assert(columnsIndexed == mtx.mapped_cells([](unsigned int x, unsigned int y, MATHTYPE) {
+		return MATHTYPE(x * 10 + y);
+	}));
+	auto viewSum = [](unsigned int, StridedConstView line) {
+		MATHTYPE sum = 0;
+		for (MATHTYPE cell : line)
+			sum += cell;
+		return sum;
+	};
+	test_assert(mtx.reduced_rows(viewSum) == reducedRows);
+	test_assert(mtx.reduced_columns(viewSum) == reducedColumns);
+	Matrix reducedInPlace(mtx);
+	reducedInPlace.reduce_columns(viewSum);
+	test_assert(reducedInPlace == reducedColumns);
+	reducedInPlace = mtx;
+	reducedInPlace.reduce_rows(viewSum);
+	test_assert(reducedInPlace == reducedRows);
+	StridedConstView column(StridedView(counted.data() + 1, 5, 3));
+	test_assert(column.end() - column.begin() == 5 && column.begin()[4] == 41 && *(column.begin() + 1) == 11);
 END_TEST()
 
 BEGIN_TEST(test_mtx_ctors)
@@ -498,7 +1770,26 @@ BEGIN_TEST(test_mtx_accesses)
 		}
 	}
 
-
+	// Unchecked access, same cells as get/set
+	Matrix wide(4, 2);
+	wide(3, 1) = 7;
+	wide(0, 1) += 2;
+	test_assert(wide.get(3, 1) == 7 && wide.get(0, 1) == 2 && wide.data()[7] == 7);
+	Matrix const &constWide = wide;
+	test_assert(constWide(3, 1) == 7 && constWide(1, 0) == 0);
+	Matrix3 small = Matrix3::Identity();
+	small(2, 0) = 4;
+	test_assert(small.get(2, 0) == 4 && small(1, 1) == 1);
+	// get/set always check, operator() only in a ZMATH_BOUNDS_CHECKS build
+	test_assert_throws(wide.get(4, 0), std::out_of_range);
+	test_assert_throws(wide.set(0, 2, 1), std::out_of_range);
+#ifdef ZMATH_BOUNDS_CHECKS
+	test_assert_throws(wide(4, 0), std::out_of_range);
+	test_assert_throws(constWide(0, 2), std::out_of_range);
+	test_assert_throws(small(3, 0), std::out_of_range);
+	test_assert_throws(wide.view()(0, 2), std::out_of_range);
+	test_assert_throws(wide.row(0)[4], std::out_of_range);
+#endif
 END_TEST()
 BEGIN_TEST(test_mtx_rw_accesses)
 	test_not_implemented();
@@ -544,6 +1835,196 @@ BEGIN_TEST(test_mtx_constctors)
 	}
 END_TEST()
 
+BEGIN_TEST(test_vec_soa)
+	// sizes around common vector widths, for the remainder loops
+	for (unsigned int n : {0u, 1u, 7u, 16u, 33u}) {
+		std::vector<Vec3> aos, other;
+		std::vector<Vec4> aos4;
+		for (unsigned int i = 0; i < n; ++i) {
+			aos.emplace_back(unit_cell(0, 0, 0), unit_cell(0, 0, 0), unit_cell(0, 0, 0) + 2);
+			other.emplace_back(unit_cell(0, 0, 0), unit_cell(0, 0, 0), unit_cell(0, 0, 0));
+			aos4.emplace_back(unit_cell(0, 0, 0), unit_cell(0, 0, 0), unit_cell(0, 0, 0), 3);
+		}
+		Vec3SoA soa(aos);
+		Vec3SoA otherSoa(other);
+		Vec4SoA soa4(aos4);
+		test_assert(soa.size() == n && soa4.size() == n);
+		for (unsigned int i = 0; i < n; ++i)
+			test_assert(soa.get(i) == aos[i] && soa4.get(i) == aos4[i]);
+
+		std::vector<MATHTYPE> out(n), outAos(n);
+		dot(soa, otherSoa, out);
+		dot(aos, other, outAos);
+		for (unsigned int i = 0; i < n; ++i)
+			test_assert(fabs(out[i] - aos[i].dot(other[i])) < 0.0001 && fabs(outAos[i] - out[i]) < 0.0001, ", on dot");
+		length(soa, out);
+		length(aos, outAos);
+		for (unsigned int i = 0; i < n; ++i)
+			test_assert(fabs(out[i] - aos[i].length()) < 0.0001 && fabs(outAos[i] - out[i]) < 0.0001, ", on length");
+		length_squared(soa4, out);
+		for (unsigned int i = 0; i < n; ++i)
+			test_assert(fabs(out[i] - aos4[i].length_squared()) < 0.0001, ", on Vec4 length_squared");
+
+		// cross into a third SoA, and in place into a mixed SoA / AoS pair
+		Vec3SoA crossed(n);
+		cross(soa, otherSoa, crossed);
+		std::vector<Vec3> crossedAos(aos);
+		cross(crossedAos, otherSoa, crossedAos);
+		for (unsigned int i = 0; i < n; ++i)
+			test_assert(crossed.get(i) == aos[i].crossed(other[i]) && crossedAos[i] == crossed.get(i), ", on cross");
+
+		Vec3SoA normalized(soa);
+		normalize(normalized);
+		std::vector<Vec3> normalizedAos(aos);
+		normalize(normalizedAos);
+		for (unsigned int i = 0; i < n; ++i)
+			test_assert(normalized.get(i) == aos[i].normalized() && normalizedAos[i] == aos[i].normalized(), ", on normalize");
+		normalize(soa4);
+		for (unsigned int i = 0; i < n; ++i)
+			test_assert(soa4.get(i) == aos4[i].normalized(), ", on Vec4 normalize");
+
+		Vec3SoA clamped(soa);
+		clamp(clamped, -0.5, 0.5);
+		for (unsigned int i = 0; i < n; ++i)
+			test_assert(clamped.get(i) == aos[i].clamped(-0.5, 0.5), ", on clamp");
+		// lengths are in [1, 3.5], so some get scaled up, some down and some left alone
+		Vec3SoA limited(soa);
+		limit_length(limited, 2.5, 1.5);
+		std::vector<Vec3> limitedAos(aos);
+		limit_length(limitedAos, 2.5, 1.5);
+		for (unsigned int i = 0; i < n; ++i)
+			test_assert(limited.get(i) == aos[i].limited_length(2.5, 1.5) && limitedAos[i] == limited.get(i), ", on limit_length");
+
+		// copying back out, and views of arbitrary stride
+		std::vector<Vec3> back(n);
+		soa.copy_to(back);
+		for (unsigned int i = 0; i < n; ++i)
+			test_assert(back[i] == aos[i]);
+		std::vector<MATHTYPE> strided(5 * n + 1);
+		Vec3View stridedView(strided.data(), strided.data() + 1, strided.data() + 2, n, 5);
+		soa.copy_to(stridedView);
+		normalize(stridedView);
+		for (unsigned int i = 0; i < n; ++i)
+			test_assert(stridedView.get(i) == aos[i].normalized(), ", on strided view");
+	}
+	// the zero vector has no direction to scale along, it stays put
+	Vec3SoA zero(4);
+	limit_length(zero, 1, 0.5);
+	test_assert(zero.get(3) == Vec3(0, 0, 0));
+	std::vector<MATHTYPE> tooShort(3);
+	test_assert_throws(length(zero, tooShort), std::invalid_argument);
+END_TEST()
+
+BEGIN_TEST(test_quaternion_rotations)
+	// the X rotations used to put a 1 in the top row
+	test_assert(Matrix::rotate3X(M_PI / 2) * Vec3(0, 1, 0) == Vec3(0, 0, 1));
+	test_assert(Matrix::rotate3XCW(M_PI / 2) * Vec3(0, 1, 0) == Vec3(0, 0, -1));
+
+	MATHTYPE angle = 0.7;
+	test_assert(Quaternion::from_axis_angle(Vec3(1, 0, 0), angle).to_matrix3() == Matrix::rotate3X(angle));
+	test_assert(Quaternion::from_axis_angle(Vec3(0, 2, 0), angle).to_matrix3() == Matrix::rotate3Y(angle));
+	test_assert(Quaternion::from_axis_angle(Vec3(0, 0, 1), angle).to_matrix3() == Matrix::rotate3Z(angle));
+	// a zero axis, say from crossing parallel vectors, doesn't rotate rather than giving NaNs
+	Quaternion unrotated = Quaternion::from_axis_angle(Vec3(0, 0, 0), angle);
+	test_assert(unrotated.r() == 1 && unrotated.i() == 0 && unrotated.j() == 0 && unrotated.k() == 0);
+	test_assert(Quaternion::from_axis_angle(Vec3(1, 2, 3).crossed(Vec3(2, 4, 6)), angle).rotate(Vec3(1, -2, 0.5)) == Vec3(1, -2, 0.5));
+	test_assert(Quaternion::from_euler(0.3, -1.2, 2.5).to_matrix3()
+		== Matrix::rotate3Z(2.5) * Matrix::rotate3Y(-1.2) * Matrix::rotate3X(0.3));
+
+	Quaternion q = Quaternion::from_axis_angle(Vec3(unit_cell(0, 0, 0), unit_cell(0, 0, 0), 1), 2 * unit_cell(0, 0, 0));
+	test_assert(fabs(q.length() - 1) < 0.0001);
+	Matrix m3 = q.to_matrix3();
+	Matrix m4 = q.to_matrix4();
+	test_assert(m4.get(3, 3) == 1 && m4.get(3, 0) == 0 && m4.get(0, 3) == 0);
+	for (unsigned int x = 0; x < 3; ++x)
+		for (unsigned int y = 0; y < 3; ++y)
+			test_assert(m4.get(x, y) == m3.get(x, y));
+	Vec3 v(1, -2, 0.5);
+	test_assert(q.rotate(v) == m3 * v);
+
+	// q and -q are the same rotation, so compare through the matrices.
+	// Angles near pi about each axis hit every branch of from_matrix.
+	for (Vec3 axis : {Vec3(0, 0, 1), Vec3(1, 0.1, 0), Vec3(0.1, 1, 0), Vec3(0, 0.1, 1)}) {
+		for (MATHTYPE a : {0.2, 3.1}) {
+			Matrix rotation = Quaternion::from_axis_angle(axis, a).to_matrix3();
+			test_assert(Quaternion::from_matrix(rotation).to_matrix3() == rotation, ", on from_matrix");
+			Matrix affine = Matrix::translate3(1, 2, 3) * Quaternion::from_axis_angle(axis, a).to_matrix4();
+			test_assert(Quaternion::from_matrix(affine).to_matrix3() == rotation, ", on from_matrix 4x4");
+		}
+	}
+	test_assert_throws(Quaternion::from_matrix(Matrix(2)), std::invalid_argument);
+
+	for (unsigned int n : {0u, 5u, 17u}) {
+		std::vector<Vec3> in, out(n);
+		for (unsigned int i = 0; i < n; ++i)
+			in.emplace_back(unit_cell(0, 0, 0), unit_cell(0, 0, 0), unit_cell(0, 0, 0));
+		q.rotate(in, out);
+		for (unsigned int i = 0; i < n; ++i)
+			test_assert(out[i] == q.rotate(in[i]), ", on batched rotate");
+		q.rotate(out, out);
+		for (unsigned int i = 0; i < n; ++i)
+			test_assert(out[i] == q.rotate(q.rotate(in[i])), ", on in-place batched rotate");
+	}
+END_TEST()
+
+BEGIN_TEST(test_quaternion_interp)
+	auto distance = [](Quaternion const &a, Quaternion const &b) {
+		return std::max({ std::abs(a.r() - b.r()), std::abs(a.i() - b.i()), std::abs(a.j() - b.j()), std::abs(a.k() - b.k()) });
+	};
+	Vec3 axis(1, -2, 0.5);
+	Quaternion from = Quaternion::from_axis_angle(axis, 0.3);
+	// slerp moves at constant speed, so it lands on the axis-angle rotation at every fraction
+	for (MATHTYPE t : {0.0, 0.25, 0.5, 0.9, 1.0}) {
+		Quaternion expected = Quaternion::from_axis_angle(axis, 0.3 + 1.8 * t);
+		test_assert(distance(from.slerp(Quaternion::from_axis_angle(axis, 2.1), t), expected) < 0.0001, ", on slerp");
+		test_assert(distance(from.slerp_fast(Quaternion::from_axis_angle(axis, 2.1), t), expected) < 0.0001, ", on slerp_fast");
+	}
+	test_assert(distance(from.nlerp(Quaternion::from_axis_angle(axis, 2.1), 0.5), Quaternion::from_axis_angle(axis, 1.2)) < 0.0001);
+	test_assert(fabs(from.nlerp(Quaternion::from_axis_angle(axis, 2.1), 0.3).length() - 1) < 0.0001);
+	// close keyframes fall back to nlerp instead of dividing by sin(theta) ~ 0
+	test_assert(distance(from.slerp(from, 0.5), from) < 0.0001);
+
+	// -q is the same rotation as q, interpolation must take the short way around instead of through 0
+	Quaternion to = Quaternion::from_axis_angle(axis, 0.9);
+	Quaternion midpoint = Quaternion::from_axis_angle(axis, 0.6);
+	test_assert(distance(from.slerp(-to, 0.5), midpoint) < 0.0001, ", on slerp shortest arc");
+	test_assert(distance(from.slerp_fast(-to, 0.5), midpoint) < 0.0001, ", on slerp_fast shortest arc");
+	test_assert(distance(from.nlerp(-to, 0.5), midpoint) < 0.0001, ", on nlerp shortest arc");
+
+	// slerp_fast error bound, up to keyframes 180 degrees apart (the worst case of the shortest arc)
+	MATHTYPE worst = 0;
+	for (MATHTYPE angle = 0; angle <= M_PI; angle += M_PI / 64)
+		for (MATHTYPE t = 0; t <= 1; t += 1.0 / 32) {
+			Quaternion a = Quaternion::from_euler(0.4, -0.3, 1.1);
+			Quaternion b = Quaternion::from_axis_angle(axis, angle) * a;
+			worst = std::max(worst, distance(a.slerp_fast(b, t), a.slerp(b, t)));
+		}
+	test_assert(worst < 0.00003, ", slerp_fast error too large");
+
+	for (unsigned int n : {0u, 5u, 37u}) {
+		std::vector<Quaternion> a, b, out(n);
+		std::vector<MATHTYPE> t;
+		for (unsigned int i = 0; i < n; ++i) {
+			a.push_back(Quaternion::from_euler(unit_cell(0, 0, 0), unit_cell(0, 0, 0), unit_cell(0, 0, 0)));
+			b.push_back(Quaternion::from_euler(unit_cell(0, 0, 0), unit_cell(0, 0, 0), unit_cell(0, 0, 0)) * MATHTYPE(i % 2 ? -1 : 1));
+			t.push_back((unit_cell(0, 0, 0) + 1) / 2);
+		}
+		Quaternion::slerp_fast(a, b, t, out);
+		for (unsigned int i = 0; i < n; ++i)
+			test_assert(distance(out[i], a[i].slerp_fast(b[i], t[i])) < 0.000001, ", on batched slerp_fast");
+		Quaternion::nlerp(a, b, t, out);
+		for (unsigned int i = 0; i < n; ++i)
+			test_assert(distance(out[i], a[i].nlerp(b[i], t[i])) < 0.000001, ", on batched nlerp");
+		Quaternion::nlerp(out, b, t, out);
+		for (unsigned int i = 0; i < n; ++i)
+			test_assert(distance(out[i], a[i].nlerp(b[i], t[i]).nlerp(b[i], t[i])) < 0.000001, ", on in-place batched nlerp");
+	}
+	std::vector<Quaternion> two(2), three(3);
+	std::vector<MATHTYPE> ts(2);
+	test_assert_throws(Quaternion::slerp_fast(two, two, ts, three), std::invalid_argument);
+	test_assert_throws(Quaternion::nlerp(two, three, ts, two), std::invalid_argument);
+END_TEST()
+
 BEGIN_TEST(test_vec4)
 	test_vec4_ctors();
 	test_vec4_unary_ops();
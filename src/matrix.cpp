@@ -1,5 +1,6 @@
 #include "matrix.hpp"
 #include "mathtype.hpp"
+#include <algorithm>
 #include <cstdlib>
 #include <iostream>
 #include <ostream>
@@ -20,7 +21,7 @@ Matrix Matrix::Identity(unsigned int size)
 	Matrix ret(size, size);
 	// diagonal of 1's
 	for (unsigned int i = 0; i < size; ++i)
-		ret._array[i * size + i] = 1.0;
+		ret._array[i * ret._stride + i] = 1.0;
 	return ret;
 }
 /* Matrix::Matrix(Vec2 vec) */
@@ -41,70 +42,142 @@ Matrix Matrix::Identity(unsigned int size)
 /* 	_array[2] = vec.z; */
 /* } */
 
-Matrix::Matrix(unsigned int size) : width(size), height(size)
+Matrix::Matrix(unsigned int size) : Matrix(size, size)
 {
-	if (width == 0)
-		throw std::invalid_argument("Expected width > 0 for matrix constructor");
-	if (height == 0)
-		throw std::invalid_argument("Expected height > 0 for matrix constructor");
-	_array = new MATHTYPE[width * height];
-	for (unsigned int i = 0; i < width * height; ++i)
-		_array[i] = 0.0;
 }
 
-Matrix::Matrix(unsigned int w, unsigned int h) : width(w), height(h)
+Matrix::Matrix(unsigned int w, unsigned int h) : Matrix(w, h, Uninitialized())
+{
+	std::fill_n(_array, height * _stride, MATHTYPE(0));
+}
+
+Matrix::Matrix(unsigned int w, unsigned int h, RowAlignment alignment) : Matrix(w, h, Uninitialized(), alignment.bytes)
+{
+	std::fill_n(_array, height * _stride, MATHTYPE(0));
+}
+
+Matrix::Matrix(unsigned int w, unsigned int h, Uninitialized, size_t rowAlignment)
+	: _resource(matrix_resource()), _rowAlignment(rowAlignment), width(w), height(h)
 {
 	if (width == 0)
 		throw std::invalid_argument("Expected width > 0 for matrix constructor");
 	if (height == 0)
 		throw std::invalid_argument("Expected height > 0 for matrix constructor");
-	_array = new MATHTYPE[width * height];
-	for (unsigned int i = 0; i < width * height; ++i)
-		_array[i] = 0.0;
+	if (rowAlignment % sizeof(MATHTYPE) != 0 || (rowAlignment & (rowAlignment - 1)) != 0)
+		throw std::invalid_argument("Expected a power of two multiple of the cell size for matrix row alignment");
+	_stride = padded_stride(width, _rowAlignment);
+	_array = allocate_cells(height * _stride, _rowAlignment);
+	// padding is never read as a cell, but zeroed so whole-buffer copies don't read uninitialized memory
+	if (_stride != width)
+		for (unsigned int y = 0; y < height; ++y)
+			std::fill(_array + y * _stride + width, _array + (y + 1) * _stride, MATHTYPE(0));
+}
+
+Matrix::Matrix(Matrix const &mtx) : Matrix(mtx.width, mtx.height, Uninitialized(), mtx._rowAlignment)
+{
+	std::copy_n(mtx._array, height * _stride, _array);
+}
+
+Matrix::Matrix(Matrix &&mtx) noexcept : _array(mtx._array), _resource(mtx._resource), _stride(mtx._stride),
+	_rowAlignment(mtx._rowAlignment), width(mtx.width), height(mtx.height)
+{
+	mtx._array = nullptr;
+	mtx.width = 0;
+	mtx.height = 0;
 }
 
+Matrix::~Matrix()
+{
+	release_cells();
+}
 
-Matrix::Matrix(Matrix const &mtx)
+Matrix &Matrix::operator=(Matrix const &mtx)
 {
+	if (this == &mtx)
+		return *this;
+	// only reallocate when the buffer size or alignment changes, the layout comes along with the cells
+	size_t cells = mtx.height * mtx._stride;
+	if (_array == nullptr || height * _stride != cells || _rowAlignment != mtx._rowAlignment) {
+		MATHTYPE *newArray = allocate_cells(cells, mtx._rowAlignment);
+		release_cells();
+		_array = newArray;
+	}
 	width = mtx.width;
 	height = mtx.height;
-	if (width == 0)
-		throw std::invalid_argument("Expected width > 0 for matrix copy constructor");
-	if (height == 0)
-		throw std::invalid_argument("Expected height > 0 for matrix copy constructor");
-	_array = new MATHTYPE[width * height];
-	for (unsigned int i = 0; i < width * height; ++i)
-		_array[i] = mtx._array[i];
+	_stride = mtx._stride;
+	_rowAlignment = mtx._rowAlignment;
+	std::copy_n(mtx._array, cells, _array);
+	return *this;
+}
+Matrix &Matrix::operator=(Matrix &&mtx)
+{
+	if (this == &mtx)
+		return *this;
+	// keep this matrix in its own resource, e.g. a long-lived result assigned from an arena temporary
+	if (*_resource != *mtx._resource)
+		return *this = static_cast<Matrix const &>(mtx);
+	release_cells();
+	_array = mtx._array;
+	_stride = mtx._stride;
+	_rowAlignment = mtx._rowAlignment;
+	width = mtx.width;
+	height = mtx.height;
+	mtx._array = nullptr;
+	mtx.width = 0;
+	mtx.height = 0;
+	return *this;
 }
 
-Matrix::~Matrix()
+size_t Matrix::padded_stride(unsigned int w, size_t rowAlignment)
 {
-	delete [] _array;
+	if (rowAlignment == 0)
+		return w;
+	size_t cellsPerAlignment = rowAlignment / sizeof(MATHTYPE);
+	size_t stride = (w + cellsPerAlignment - 1) / cellsPerAlignment * cellsPerAlignment;
+	// rows a whole number of pages apart map a column onto the same few cache sets, skip to the next alignment
+	if (stride * sizeof(MATHTYPE) % 4096 == 0)
+		stride += cellsPerAlignment;
+	return stride;
 }
 
-MATHTYPE  Matrix::get(unsigned int xColumn, unsigned int yRow) const
+void Matrix::check_index(unsigned int xColumn, unsigned int yRow) const
 {
 	if (xColumn >= width)
 		throw std::out_of_range("Column index exceeded width of matrix");
 	if (yRow >= height)
 		throw std::out_of_range("Row index exceeded height of matrix");
-	return _array[yRow * width + xColumn];
+}
+MATHTYPE  Matrix::get(unsigned int xColumn, unsigned int yRow) const
+{
+	check_index(xColumn, yRow);
+	return _array[yRow * _stride + xColumn];
 }
 MATHTYPE &Matrix::get_mut(unsigned int xColumn, unsigned int yRow)
 {
-	if (xColumn >= width)
-		throw std::out_of_range("Column index exceeded width of matrix");
-	if (yRow >= height)
-		throw std::out_of_range("Row index exceeded height of matrix");
-	return _array[yRow * width + xColumn];
+	check_index(xColumn, yRow);
+	return _array[yRow * _stride + xColumn];
 }
 void      Matrix::set(unsigned int xColumn, unsigned int yRow, MATHTYPE newValue)
 {
-	if (xColumn >= width)
-		throw std::out_of_range("Column index exceeded width of matrix");
-	if (yRow >= height)
-		throw std::out_of_range("Row index exceeded height of matrix");
-	_array[yRow * width + xColumn] = newValue;
+	check_index(xColumn, yRow);
+	_array[yRow * _stride + xColumn] = newValue;
+}
+
+MATHTYPE       *Matrix::data()
+{
+	return _array;
+}
+MATHTYPE const *Matrix::data() const
+{
+	return _array;
+}
+size_t Matrix::stride() const
+{
+	return _stride;
+}
+std::pmr::memory_resource *Matrix::resource() const
+{
+	return _resource;
 }
 
 Matrix Matrix::get_column(unsigned int xColumn) const
@@ -113,7 +186,7 @@ Matrix Matrix::get_column(unsigned int xColumn) const
 		throw std::out_of_range("Column index exceeded width of matrix");
 	Matrix ret(1, height);
 	for (size_t i = 0; i < height; ++i)
-		ret._array[i] = _array[i * width + xColumn];
+		ret._array[i] = _array[i * _stride + xColumn];
 	return ret;
 }
 MathTypePointerList Matrix::get_column_mut(unsigned int xColumn) 
@@ -122,7 +195,7 @@ MathTypePointerList Matrix::get_column_mut(unsigned int xColumn)
 		throw std::out_of_range("Column index exceeded width of matrix");
 	MathTypePointerList ret(height);
 	for (size_t i = 0; i < height; ++i)
-		ret[i] = &_array[i * width + xColumn];
+		ret[i] = &_array[i * _stride + xColumn];
 	return ret;
 }
 Matrix Matrix::get_row(unsigned int yRow) const
@@ -131,7 +204,7 @@ Matrix Matrix::get_row(unsigned int yRow) const
 		throw std::out_of_range("Row index exceeded height of matrix");
 	Matrix ret(width, 1);
 	for (size_t i = 0; i < width; ++i)
-		ret._array[i] = _array[yRow * width + i];
+		ret._array[i] = _array[yRow * _stride + i];
 	return ret;
 }
 MathTypePointerList Matrix::get_row_mut(unsigned int yRow) 
@@ -140,7 +213,7 @@ MathTypePointerList Matrix::get_row_mut(unsigned int yRow)
 		throw std::out_of_range("Row index exceeded height of matrix");
 	MathTypePointerList ret(width);
 	for (size_t i = 0; i < width; ++i)
-		ret[i] = &_array[yRow * width + i];
+		ret[i] = &_array[yRow * _stride + i];
 	return ret;
 }
 
@@ -149,7 +222,7 @@ void Matrix::print() const
 	for (unsigned int y = 0; y < height; ++y) {
 		std::cout << "[ ";
 		for (unsigned int x = 0; x < width; ++x) {
-			std::cout << get(x, y) << " ";
+			std::cout << (*this)(x, y) << " ";
 		}
 		std::cout << "]" << std::endl;
 	}
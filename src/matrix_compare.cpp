@@ -5,7 +5,7 @@
 #define MIN_ERROR_EQUAL 0.0001
 #endif
 namespace ZMathLib_Graphics {
-bool Matrix::operator==(Matrix other) const
+bool Matrix::operator==(Matrix const &other) const
 {
 	if (width != other.width)
 		return false;
@@ -13,14 +13,14 @@ bool Matrix::operator==(Matrix other) const
 		return false;
 	for (unsigned int x = 0; x < width; ++x) {
 		for (unsigned int y = 0; y < height; ++y) {
-			if (fabs(_array[y * width + x] - other._array[y * width + x]) >= (MIN_ERROR_EQUAL))
+			if (fabs(_array[y * _stride + x] - other._array[y * other._stride + x]) >= (MIN_ERROR_EQUAL))
 				return false;
 		}
 	}
 	return true;
 }
 
-bool Matrix::operator!=(Matrix other) const
+bool Matrix::operator!=(Matrix const &other) const
 {
 	return !(*this == other);
 }
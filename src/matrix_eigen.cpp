@@ -0,0 +1,229 @@
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include "matrix_threads.hpp"
+#include "static_matrix.hpp"
+#include "vector.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numbers>
+#include <numeric>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+namespace ZMathLib_Graphics {
+namespace {
+// Jacobi converges quadratically once the off-diagonal is small, a handful of sweeps in practice
+constexpr unsigned int MAX_SWEEPS = 50;
+// matrices per parallel_for range in eigen_symmetric3
+constexpr size_t PARALLEL_MATRICES = 1 << 12;
+
+// Cyclic Jacobi on a (n x n, symmetric, both triangles stored): every sweep zeroes each off-diagonal cell in
+// turn with a rotation, until the off-diagonal underflows. The diagonal ends up the eigenvalues and row i of
+// vt the eigenvector of a[i][i]. Rows of vt are contiguous, where columns of V would be strided.
+void jacobi(size_t n, MATHTYPE *a, MATHTYPE *vt)
+{
+	for (unsigned int sweep = 0; sweep < MAX_SWEEPS; ++sweep) {
+		MATHTYPE off = 0;
+		for (size_t p = 0; p < n; ++p)
+			for (size_t q = p + 1; q < n; ++q)
+				off += std::fabs(a[p * n + q]);
+		if (off == 0)
+			return;
+		// the first sweeps only rotate the larger cells
+		MATHTYPE threshold = sweep < 3 ? MATHTYPE(0.2) * off / MATHTYPE(n * n) : 0;
+		for (size_t p = 0; p < n; ++p)
+			for (size_t q = p + 1; q < n; ++q) {
+				MATHTYPE apq = a[p * n + q], app = a[p * n + p], aqq = a[q * n + q];
+				MATHTYPE g = 100 * std::fabs(apq);
+				// past a few sweeps, a cell too small to change either diagonal cell is dropped
+				if (sweep > 3 && std::fabs(app) + g == std::fabs(app) && std::fabs(aqq) + g == std::fabs(aqq)) {
+					a[p * n + q] = a[q * n + p] = 0;
+					continue;
+				}
+				if (std::fabs(apq) <= threshold)
+					continue;
+				// t = tan of the rotation angle, the smaller root of t^2 + 2 theta t - 1 = 0
+				MATHTYPE h = aqq - app, t;
+				if (std::fabs(h) + g == std::fabs(h)) {
+					t = apq / h;
+				} else {
+					MATHTYPE theta = h / (2 * apq);
+					t = 1 / (std::fabs(theta) + std::sqrt(1 + theta * theta));
+					if (theta < 0)
+						t = -t;
+				}
+				MATHTYPE c = 1 / std::sqrt(1 + t * t), s = t * c, tau = s / (1 + c);
+				a[p * n + p] = app - t * apq;
+				a[q * n + q] = aqq + t * apq;
+				a[p * n + q] = a[q * n + p] = 0;
+				for (size_t k = 0; k < n; ++k) {
+					if (k == p || k == q)
+						continue;
+					MATHTYPE akp = a[k * n + p], akq = a[k * n + q];
+					a[k * n + p] = a[p * n + k] = akp - s * (akq + tau * akp);
+					a[k * n + q] = a[q * n + k] = akq + s * (akp - tau * akq);
+				}
+				MATHTYPE *vp = vt + p * n, *vq = vt + q * n;
+				for (size_t k = 0; k < n; ++k) {
+					MATHTYPE vkp = vp[k], vkq = vq[k];
+					vp[k] = vkp - s * (vkq + tau * vkp);
+					vq[k] = vkq + s * (vkp - tau * vkq);
+				}
+			}
+	}
+}
+
+// Inlined here where Vec3's methods live out of line, so the 3x3 solver compiles to straight-line code
+struct V3 {
+	MATHTYPE x, y, z;
+};
+inline V3 cross(V3 a, V3 b)
+{
+	return { a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x };
+}
+inline MATHTYPE dot(V3 a, V3 b)
+{
+	return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+inline V3 scaled(V3 a, MATHTYPE s)
+{
+	return { a.x * s, a.y * s, a.z * s };
+}
+inline V3 select(bool condition, V3 a, V3 b)
+{
+	return { condition ? a.x : b.x, condition ? a.y : b.y, condition ? a.z : b.z };
+}
+
+// Symmetric 3x3, rows a0 a1 a2
+struct Sym3 {
+	V3 a0, a1, a2;
+
+	V3 operator*(V3 v) const { return { dot(a0, v), dot(a1, v), dot(a2, v) }; }
+};
+
+// Unit vector spanning the null space of m - lambda I, taken as the longest cross product of two of its rows.
+// Good when lambda is a simple eigenvalue, any unit vector if m - lambda I is 0.
+inline V3 null_vector(Sym3 const &m, MATHTYPE lambda)
+{
+	V3 r0 = { m.a0.x - lambda, m.a0.y, m.a0.z };
+	V3 r1 = { m.a1.x, m.a1.y - lambda, m.a1.z };
+	V3 r2 = { m.a2.x, m.a2.y, m.a2.z - lambda };
+	V3 c01 = cross(r0, r1), c02 = cross(r0, r2), c12 = cross(r1, r2);
+	MATHTYPE d01 = dot(c01, c01), d02 = dot(c02, c02), d12 = dot(c12, c12);
+	V3 v = select(d02 > d01, c02, c01);
+	MATHTYPE d = std::max(d01, d02);
+	v = select(d12 > d, c12, v);
+	d = std::max(d, d12);
+	v = select(d > 0, v, V3{ 1, 0, 0 });
+	return scaled(v, 1 / std::sqrt(d > 0 ? d : 1));
+}
+
+// Unit eigenvector of lambda orthogonal to v0, found in the plane u, w orthogonal to v0: (m - lambda I)
+// restricted to it is a rank <= 1 2x2 matrix, whose null vector is orthogonal to its longer row.
+inline V3 second_vector(Sym3 const &m, V3 v0, MATHTYPE lambda)
+{
+	bool xLarger = std::fabs(v0.x) > std::fabs(v0.y);
+	V3 u = select(xLarger, V3{ -v0.z, 0, v0.x }, V3{ 0, v0.z, -v0.y });
+	u = scaled(u, 1 / std::sqrt(dot(u, u)));
+	V3 w = cross(v0, u);
+	V3 mu = m * u, mw = m * w;
+	MATHTYPE m00 = dot(u, mu) - lambda, m01 = dot(u, mw), m11 = dot(w, mw) - lambda;
+	MATHTYPE s0 = m00 * m00 + m01 * m01, s1 = m01 * m01 + m11 * m11;
+	MATHTYPE x = s0 >= s1 ? m01 : m11, y = s0 >= s1 ? -m00 : -m01, d = std::max(s0, s1);
+	// lambda is a double eigenvalue, every vector of the plane is one
+	x = d > 0 ? x : 1;
+	MATHTYPE inverse = 1 / std::sqrt(d > 0 ? d : 1);
+	V3 ret = { x * u.x + y * w.x, x * u.y + y * w.y, x * u.z + y * w.z };
+	return scaled(ret, inverse);
+}
+
+template <bool VECTORS>
+inline void eigen3(MATHTYPE const *cells, Vec3 &values, Vec3 *vectors)
+{
+	// scaled to its largest cell, so squares and cubes below neither overflow nor underflow
+	MATHTYPE a00 = cells[0], a10 = cells[3], a11 = cells[4], a20 = cells[6], a21 = cells[7], a22 = cells[8];
+	MATHTYPE scale = std::max({ std::fabs(a00), std::fabs(a10), std::fabs(a11), std::fabs(a20), std::fabs(a21), std::fabs(a22) });
+	scale = scale > 0 ? scale : 1;
+	MATHTYPE inverseScale = 1 / scale;
+	a00 *= inverseScale; a10 *= inverseScale; a11 *= inverseScale;
+	a20 *= inverseScale; a21 *= inverseScale; a22 *= inverseScale;
+
+	// Smith's method: with A = q I + p B, tr(B) = 0 and |B| = sqrt(6), the eigenvalues of B are
+	// 2 cos(phi + 2 pi k / 3) with cos(3 phi) = det(B) / 2
+	MATHTYPE q = (a00 + a11 + a22) / 3;
+	MATHTYPE b00 = a00 - q, b11 = a11 - q, b22 = a22 - q;
+	MATHTYPE p = std::sqrt((b00 * b00 + b11 * b11 + b22 * b22 + 2 * (a10 * a10 + a20 * a20 + a21 * a21)) / 6);
+	// p = 0 is A = q I, r = 0 then puts every eigenvalue at q
+	MATHTYPE inverseP = p > 0 ? 1 / p : 0;
+	MATHTYPE det = b00 * (b11 * b22 - a21 * a21) - a10 * (a10 * b22 - a21 * a20) + a20 * (a10 * a21 - b11 * a20);
+	MATHTYPE r = std::clamp(det * inverseP * inverseP * inverseP / 2, MATHTYPE(-1), MATHTYPE(1));
+	// phi is in [0, pi / 3], so its sine is the positive root and cos(phi + 2 pi / 3) needs no second cosine
+	MATHTYPE c = std::cos(std::acos(r) / 3), s = std::sqrt(std::max(1 - c * c, MATHTYPE(0)));
+	MATHTYPE largest = q + 2 * p * c;
+	MATHTYPE smallest = q - p * (c + MATHTYPE(std::numbers::sqrt3) * s);
+	MATHTYPE middle = 3 * q - largest - smallest;
+	values.x = smallest * scale;
+	values.y = middle * scale;
+	values.z = largest * scale;
+	if constexpr (VECTORS) {
+		Sym3 m = { { a00, a10, a20 }, { a10, a11, a21 }, { a20, a21, a22 } };
+		// r >= 0 puts the largest eigenvalue further from the middle one than the smallest is, so its null
+		// vector is the better conditioned one to start from
+		bool largestFirst = r >= 0;
+		V3 v0 = null_vector(m, largestFirst ? largest : smallest);
+		V3 v1 = second_vector(m, v0, middle);
+		V3 v2 = cross(v0, v1);
+		V3 first = select(largestFirst, v2, v0), last = select(largestFirst, v0, v2);
+		vectors[0].x = first.x; vectors[0].y = first.y; vectors[0].z = first.z;
+		vectors[1].x = v1.x; vectors[1].y = v1.y; vectors[1].z = v1.z;
+		vectors[2].x = last.x; vectors[2].y = last.y; vectors[2].z = last.z;
+	}
+}
+}
+
+SymmetricEigen Matrix::eigen_symmetric() const
+{
+	if (width != height)
+		throw std::invalid_argument("Matrix::eigen_symmetric expects a square matrix");
+	size_t n = width;
+	std::vector<MATHTYPE> a(n * n), vt(n * n);
+	for (unsigned int y = 0; y < n; ++y) {
+		for (unsigned int x = 0; x <= y; ++x)
+			a[y * n + x] = a[x * n + y] = (*this)(x, y);
+		vt[y * n + y] = 1;
+	}
+	jacobi(n, a.data(), vt.data());
+
+	std::vector<unsigned int> order(n);
+	std::iota(order.begin(), order.end(), 0u);
+	std::stable_sort(order.begin(), order.end(), [&](unsigned int i, unsigned int j) {
+		return a[i * n + i] < a[j * n + j];
+	});
+	SymmetricEigen ret{ std::vector<MATHTYPE>(n), Matrix(width) };
+	for (unsigned int i = 0; i < n; ++i) {
+		ret.values[i] = a[order[i] * (n + 1)];
+		for (unsigned int k = 0; k < n; ++k)
+			ret.vectors(i, k) = vt[order[i] * n + k];
+	}
+	return ret;
+}
+
+void eigen_symmetric3(std::span<Matrix3 const> matrices, std::span<Vec3> values, std::span<Vec3> vectors)
+{
+	if (values.size() != matrices.size())
+		throw std::invalid_argument("eigen_symmetric3 expects one Vec3 of eigenvalues per matrix");
+	if (!vectors.empty() && vectors.size() != 3 * matrices.size())
+		throw std::invalid_argument("eigen_symmetric3 expects three Vec3 eigenvectors per matrix, or none");
+	bool withVectors = !vectors.empty();
+	parallel_for(matrices.size(), PARALLEL_MATRICES, [&](size_t begin, size_t end) {
+		if (withVectors)
+			for (size_t i = begin; i < end; ++i)
+				eigen3<true>(matrices[i].data(), values[i], vectors.data() + 3 * i);
+		else
+			for (size_t i = begin; i < end; ++i)
+				eigen3<false>(matrices[i].data(), values[i], nullptr);
+	});
+}
+}
@@ -0,0 +1,233 @@
+#include "mathtype.hpp"
+#include "matrix_kernels.hpp"
+#include "matrix_threads.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+// Elementwise kernels stream over the contiguous row-major buffer.
+// The vector bodies use GCC/Clang vector types, so the same template compiles to SSE2, AVX2 or AVX-512
+// depending on the target of the function it is flattened into. Stores are peeled to vector alignment,
+// loads are unaligned-safe since the inputs can have any offset relative to the output.
+
+namespace ZMathLib_Graphics::Kernels {
+namespace {
+// Operands are passed by reference, passing wide vector types by value outside their target changes the ABI
+struct Add { template <typename T> void operator()(T &out, T const &a, T const &b) const { out = a + b; } };
+struct Sub { template <typename T> void operator()(T &out, T const &a, T const &b) const { out = a - b; } };
+struct Mul { template <typename T> void operator()(T &out, T const &a, T const &b) const { out = a * b; } };
+struct Div { template <typename T> void operator()(T &out, T const &a, T const &b) const { out = a / b; } };
+
+template <typename Op>
+void binary_scalar(MATHTYPE *out, MATHTYPE const *a, MATHTYPE const *b, size_t n)
+{
+	for (size_t i = 0; i < n; ++i)
+		Op()(out[i], a[i], b[i]);
+}
+template <typename Op>
+void broadcast_scalar(MATHTYPE *out, MATHTYPE const *a, MATHTYPE scalar, size_t n)
+{
+	for (size_t i = 0; i < n; ++i)
+		Op()(out[i], a[i], scalar);
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+typedef MATHTYPE Vector16 __attribute__((vector_size(16)));
+typedef MATHTYPE Vector32 __attribute__((vector_size(32)));
+typedef MATHTYPE Vector64 __attribute__((vector_size(64)));
+
+// number of leading cells to handle one at a time so that `out + count` is aligned to Bytes
+template <size_t Bytes>
+inline size_t peel_count(MATHTYPE const *out, size_t n)
+{
+	size_t misalignment = reinterpret_cast<uintptr_t>(out) % Bytes;
+	if (misalignment == 0 || misalignment % sizeof(MATHTYPE) != 0)
+		return 0;
+	size_t count = (Bytes - misalignment) / sizeof(MATHTYPE);
+	return count < n ? count : n;
+}
+
+template <typename V, typename Op>
+inline void binary_vector(MATHTYPE *out, MATHTYPE const *a, MATHTYPE const *b, size_t n)
+{
+	constexpr size_t lanes = sizeof(V) / sizeof(MATHTYPE);
+	size_t i = peel_count<sizeof(V)>(out, n);
+	binary_scalar<Op>(out, a, b, i);
+	// out is aligned here unless MATHTYPE itself is misaligned, which new[] never produces
+	bool aligned = reinterpret_cast<uintptr_t>(out + i) % sizeof(V) == 0;
+	for (; i + lanes <= n; i += lanes) {
+		V va, vb;
+		std::memcpy(&va, a + i, sizeof(V));
+		std::memcpy(&vb, b + i, sizeof(V));
+		V result;
+		Op()(result, va, vb);
+		if (aligned)
+			*reinterpret_cast<V *>(out + i) = result;
+		else
+			std::memcpy(out + i, &result, sizeof(V));
+	}
+	binary_scalar<Op>(out + i, a + i, b + i, n - i);
+}
+
+template <typename V, typename Op>
+inline void broadcast_vector(MATHTYPE *out, MATHTYPE const *a, MATHTYPE scalar, size_t n)
+{
+	constexpr size_t lanes = sizeof(V) / sizeof(MATHTYPE);
+	V vs;
+	for (size_t l = 0; l < lanes; ++l)
+		vs[l] = scalar;
+	size_t i = peel_count<sizeof(V)>(out, n);
+	broadcast_scalar<Op>(out, a, scalar, i);
+	bool aligned = reinterpret_cast<uintptr_t>(out + i) % sizeof(V) == 0;
+	for (; i + lanes <= n; i += lanes) {
+		V va;
+		std::memcpy(&va, a + i, sizeof(V));
+		V result;
+		Op()(result, va, vs);
+		if (aligned)
+			*reinterpret_cast<V *>(out + i) = result;
+		else
+			std::memcpy(out + i, &result, sizeof(V));
+	}
+	broadcast_scalar<Op>(out + i, a + i, scalar, n - i);
+}
+
+#define ELEMENTWISE_ISA(isa, isaTarget, V) \
+__attribute__((target(isaTarget), flatten)) \
+void add_##isa(MATHTYPE *out, MATHTYPE const *a, MATHTYPE const *b, size_t n) { binary_vector<V, Add>(out, a, b, n); } \
+__attribute__((target(isaTarget), flatten)) \
+void sub_##isa(MATHTYPE *out, MATHTYPE const *a, MATHTYPE const *b, size_t n) { binary_vector<V, Sub>(out, a, b, n); } \
+__attribute__((target(isaTarget), flatten)) \
+void add_scalar_##isa(MATHTYPE *out, MATHTYPE const *a, MATHTYPE s, size_t n) { broadcast_vector<V, Add>(out, a, s, n); } \
+__attribute__((target(isaTarget), flatten)) \
+void sub_scalar_##isa(MATHTYPE *out, MATHTYPE const *a, MATHTYPE s, size_t n) { broadcast_vector<V, Sub>(out, a, s, n); } \
+__attribute__((target(isaTarget), flatten)) \
+void mul_scalar_##isa(MATHTYPE *out, MATHTYPE const *a, MATHTYPE s, size_t n) { broadcast_vector<V, Mul>(out, a, s, n); } \
+__attribute__((target(isaTarget), flatten)) \
+void div_scalar_##isa(MATHTYPE *out, MATHTYPE const *a, MATHTYPE s, size_t n) { broadcast_vector<V, Div>(out, a, s, n); }
+
+ELEMENTWISE_ISA(sse2, "sse2", Vector16)
+ELEMENTWISE_ISA(avx2, "avx2", Vector32)
+ELEMENTWISE_ISA(avx512, "avx512f", Vector64)
+#endif
+
+struct ElementwiseKernels {
+	void (*add)(MATHTYPE *, MATHTYPE const *, MATHTYPE const *, size_t);
+	void (*sub)(MATHTYPE *, MATHTYPE const *, MATHTYPE const *, size_t);
+	void (*add_scalar)(MATHTYPE *, MATHTYPE const *, MATHTYPE, size_t);
+	void (*sub_scalar)(MATHTYPE *, MATHTYPE const *, MATHTYPE, size_t);
+	void (*mul_scalar)(MATHTYPE *, MATHTYPE const *, MATHTYPE, size_t);
+	void (*div_scalar)(MATHTYPE *, MATHTYPE const *, MATHTYPE, size_t);
+};
+
+#define ELEMENTWISE_TABLE(isa) \
+	ElementwiseKernels{ add_##isa, sub_##isa, add_scalar_##isa, sub_scalar_##isa, mul_scalar_##isa, div_scalar_##isa }
+
+ElementwiseKernels select_elementwise()
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f"))
+		return ELEMENTWISE_TABLE(avx512);
+	if (__builtin_cpu_supports("avx2"))
+		return ELEMENTWISE_TABLE(avx2);
+	if (__builtin_cpu_supports("sse2"))
+		return ELEMENTWISE_TABLE(sse2);
+#endif
+	return ElementwiseKernels{
+		binary_scalar<Add>, binary_scalar<Sub>,
+		broadcast_scalar<Add>, broadcast_scalar<Sub>, broadcast_scalar<Mul>, broadcast_scalar<Div>
+	};
+}
+
+ElementwiseKernels const &elementwise()
+{
+	static ElementwiseKernels const kernels = select_elementwise();
+	return kernels;
+}
+
+// Cells per thread below which a second thread costs more than it saves. The kernels are memory bound,
+// so the point is mostly getting more cores' worth of cache and memory bandwidth on a big matrix.
+constexpr size_t PARALLEL_CELLS = size_t(1) << 15;
+
+void for_each_row(size_t rows, size_t cols, MATHTYPE *out, size_t ldo, MATHTYPE const *a, size_t lda,
+	MATHTYPE const *b, size_t ldb, void (*kernel)(MATHTYPE *, MATHTYPE const *, MATHTYPE const *, size_t))
+{
+	if (rows == 1 || (ldo == cols && lda == cols && ldb == cols)) {
+		parallel_for(rows * cols, PARALLEL_CELLS, [&](size_t begin, size_t end) {
+			kernel(out + begin, a + begin, b + begin, end - begin);
+		});
+		return;
+	}
+	parallel_for(rows, std::max<size_t>(1, PARALLEL_CELLS / cols), [&](size_t begin, size_t end) {
+		for (size_t y = begin; y < end; ++y)
+			kernel(out + y * ldo, a + y * lda, b + y * ldb, cols);
+	});
+}
+void for_each_row(size_t rows, size_t cols, MATHTYPE *out, size_t ldo, MATHTYPE const *a, size_t lda,
+	MATHTYPE scalar, void (*kernel)(MATHTYPE *, MATHTYPE const *, MATHTYPE, size_t))
+{
+	if (rows == 1 || (ldo == cols && lda == cols)) {
+		parallel_for(rows * cols, PARALLEL_CELLS, [&](size_t begin, size_t end) {
+			kernel(out + begin, a + begin, scalar, end - begin);
+		});
+		return;
+	}
+	parallel_for(rows, std::max<size_t>(1, PARALLEL_CELLS / cols), [&](size_t begin, size_t end) {
+		for (size_t y = begin; y < end; ++y)
+			kernel(out + y * ldo, a + y * lda, scalar, cols);
+	});
+}
+}
+
+void add(MATHTYPE *out, MATHTYPE const *a, MATHTYPE const *b, size_t n)
+{
+	elementwise().add(out, a, b, n);
+}
+void sub(MATHTYPE *out, MATHTYPE const *a, MATHTYPE const *b, size_t n)
+{
+	elementwise().sub(out, a, b, n);
+}
+void add_scalar(MATHTYPE *out, MATHTYPE const *a, MATHTYPE scalar, size_t n)
+{
+	elementwise().add_scalar(out, a, scalar, n);
+}
+void sub_scalar(MATHTYPE *out, MATHTYPE const *a, MATHTYPE scalar, size_t n)
+{
+	elementwise().sub_scalar(out, a, scalar, n);
+}
+void mul_scalar(MATHTYPE *out, MATHTYPE const *a, MATHTYPE scalar, size_t n)
+{
+	elementwise().mul_scalar(out, a, scalar, n);
+}
+void div_scalar(MATHTYPE *out, MATHTYPE const *a, MATHTYPE scalar, size_t n)
+{
+	elementwise().div_scalar(out, a, scalar, n);
+}
+
+void add(size_t rows, size_t cols, MATHTYPE *out, size_t ldo, MATHTYPE const *a, size_t lda, MATHTYPE const *b, size_t ldb)
+{
+	for_each_row(rows, cols, out, ldo, a, lda, b, ldb, elementwise().add);
+}
+void sub(size_t rows, size_t cols, MATHTYPE *out, size_t ldo, MATHTYPE const *a, size_t lda, MATHTYPE const *b, size_t ldb)
+{
+	for_each_row(rows, cols, out, ldo, a, lda, b, ldb, elementwise().sub);
+}
+void add_scalar(size_t rows, size_t cols, MATHTYPE *out, size_t ldo, MATHTYPE const *a, size_t lda, MATHTYPE scalar)
+{
+	for_each_row(rows, cols, out, ldo, a, lda, scalar, elementwise().add_scalar);
+}
+void sub_scalar(size_t rows, size_t cols, MATHTYPE *out, size_t ldo, MATHTYPE const *a, size_t lda, MATHTYPE scalar)
+{
+	for_each_row(rows, cols, out, ldo, a, lda, scalar, elementwise().sub_scalar);
+}
+void mul_scalar(size_t rows, size_t cols, MATHTYPE *out, size_t ldo, MATHTYPE const *a, size_t lda, MATHTYPE scalar)
+{
+	for_each_row(rows, cols, out, ldo, a, lda, scalar, elementwise().mul_scalar);
+}
+void div_scalar(size_t rows, size_t cols, MATHTYPE *out, size_t ldo, MATHTYPE const *a, size_t lda, MATHTYPE scalar)
+{
+	for_each_row(rows, cols, out, ldo, a, lda, scalar, elementwise().div_scalar);
+}
+}
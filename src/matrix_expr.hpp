@@ -0,0 +1,493 @@
+#ifndef MATRIX_EXPR_HPP
+#define MATRIX_EXPR_HPP
+
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include "matrix_view.hpp"
+#include <concepts>
+#include <cstddef>
+#include <optional>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+// Opt-in lazy evaluation of Matrix arithmetic. Wrapping any operand in lazy() makes the whole expression a tree
+// of lightweight nodes instead of a chain of temporary matrices, and nothing is computed until it is assigned
+// to (or used to construct) a Matrix:
+//
+//	Matrix d = lazy(a) * b + lazy(c) * 2 - e;
+//
+// runs a single gemm accumulating into d after one fused pass computing c * 2 - e, with no temporaries.
+// Only operators with an expression operand are lazy, `c * 2` above would still be an eager Matrix.
+// Elementwise +, -, scalar * and / fuse into one loop, and every product in the sum (optionally scaled or negated)
+// is accumulated into the destination by Matrix::gemm. Only an operand of a product that isn't a plain matrix,
+// like (a + b) in lazy(a + b) * c, is materialized before each pass and freed after it.
+// Expressions hold references to the matrices they were built from (temporaries are moved in), so evaluate them
+// before those matrices go away. Sizes are checked when the expression is built, with the same
+// std::invalid_argument as the eager operators.
+
+namespace ZMathLib_Graphics::Expr {
+// Leaves. cell(y, x) is the cell in row y and column x, valid after prepare()
+struct Ref : Expression {
+	Matrix const *matrix;
+	mutable MATHTYPE const *cells = nullptr;
+	mutable size_t stride = 0;
+
+	explicit Ref(Matrix const &matrix) : matrix(&matrix) {}
+
+	unsigned int width() const { return matrix->width; }
+	unsigned int height() const { return matrix->height; }
+	void prepare() const
+	{
+		cells = matrix->data();
+		stride = matrix->stride();
+	}
+	MATHTYPE cell(size_t y, size_t x) const { return cells[y * stride + x]; }
+	bool packed() const { return matrix->stride() == matrix->width; }
+	bool reads(MATHTYPE const *buffer) const { return matrix->data() == buffer; }
+	MatrixConstView view() const { return matrix->view(); }
+};
+// A temporary moved into the expression
+struct Owned : Expression {
+	Matrix matrix;
+	mutable MATHTYPE const *cells = nullptr;
+	mutable size_t stride = 0;
+
+	explicit Owned(Matrix &&matrix) : matrix(std::move(matrix)) {}
+
+	unsigned int width() const { return matrix.width; }
+	unsigned int height() const { return matrix.height; }
+	void prepare() const
+	{
+		cells = matrix.data();
+		stride = matrix.stride();
+	}
+	MATHTYPE cell(size_t y, size_t x) const { return cells[y * stride + x]; }
+	bool packed() const { return matrix.stride() == matrix.width; }
+	bool reads(MATHTYPE const *) const { return false; }
+	MatrixConstView view() const { return matrix.view(); }
+};
+// Not an Expression by itself, only an operand of one
+struct Scalar {
+	MATHTYPE value;
+
+	void prepare() const {}
+	MATHTYPE cell(size_t, size_t) const { return value; }
+	bool packed() const { return true; }
+};
+
+struct Add { static MATHTYPE apply(MATHTYPE a, MATHTYPE b) { return a + b; } };
+struct Sub { static MATHTYPE apply(MATHTYPE a, MATHTYPE b) { return a - b; } };
+struct Mul { static MATHTYPE apply(MATHTYPE a, MATHTYPE b) { return a * b; } };
+struct Div { static MATHTYPE apply(MATHTYPE a, MATHTYPE b) { return a / b; } };
+
+template <typename T>
+constexpr bool is_leaf = std::same_as<T, Ref> || std::same_as<T, Owned>;
+
+// Elementwise a op b, one side may be a Scalar
+template <typename Op, typename L, typename R>
+struct Binary : Expression {
+	using OpType = Op;
+	L left;
+	R right;
+
+	Binary(L left, R right) : left(std::move(left)), right(std::move(right))
+	{
+		if constexpr (!std::same_as<L, Scalar> && !std::same_as<R, Scalar>) {
+			if (this->left.width() != this->right.width() || this->left.height() != this->right.height()) {
+				if constexpr (std::same_as<Op, Add>)
+					throw std::invalid_argument("Matrix + Matrix operation requires matrices of equal width and height");
+				else
+					throw std::invalid_argument("Matrix - Matrix operation requires matrices of equal width and height");
+			}
+		}
+	}
+
+	unsigned int width() const
+	{
+		if constexpr (std::same_as<L, Scalar>)
+			return right.width();
+		else
+			return left.width();
+	}
+	unsigned int height() const
+	{
+		if constexpr (std::same_as<L, Scalar>)
+			return right.height();
+		else
+			return left.height();
+	}
+	void prepare() const
+	{
+		left.prepare();
+		right.prepare();
+	}
+	MATHTYPE cell(size_t y, size_t x) const { return Op::apply(left.cell(y, x), right.cell(y, x)); }
+	bool packed() const { return left.packed() && right.packed(); }
+};
+
+template <typename E>
+struct Negate : Expression {
+	E inner;
+
+	explicit Negate(E inner) : inner(std::move(inner)) {}
+
+	unsigned int width() const { return inner.width(); }
+	unsigned int height() const { return inner.height(); }
+	void prepare() const { inner.prepare(); }
+	MATHTYPE cell(size_t y, size_t x) const { return -inner.cell(y, x); }
+	bool packed() const { return inner.packed(); }
+};
+
+// Matrix product a * b. Leaf operands are used in place, other operands are evaluated into a Matrix first.
+template <typename L, typename R>
+struct Product : Expression {
+	L left_expr;
+	R right_expr;
+	mutable std::optional<Matrix> left_value, right_value;
+
+	Product(L left, R right) : left_expr(std::move(left)), right_expr(std::move(right))
+	{
+		if (left_expr.width() != right_expr.height())
+			throw std::invalid_argument("Matrix A * Matrix B operation requires that A.width == B.height");
+	}
+
+	unsigned int width() const { return right_expr.width(); }
+	unsigned int height() const { return left_expr.height(); }
+	MatrixConstView left() const
+	{
+		if constexpr (is_leaf<L>)
+			return left_expr.view();
+		else
+			return *left_value;
+	}
+	MatrixConstView right() const
+	{
+		if constexpr (is_leaf<R>)
+			return right_expr.view();
+		else
+			return *right_value;
+	}
+	// Evaluates the operands that aren't leaves, called before left() and right() on every evaluation so a stored
+	// expression sees the current contents of the matrices it reads
+	void prepare_operands() const
+	{
+		if constexpr (!is_leaf<L>)
+			left_value.emplace(left_expr);
+		if constexpr (!is_leaf<R>)
+			right_value.emplace(right_expr);
+	}
+	// Frees the evaluated operands once the pass is done
+	void release_operands() const
+	{
+		left_value.reset();
+		right_value.reset();
+	}
+	// Whether gemm would read buffer while accumulating the product, nested operands are copies by then
+	bool reads_directly(MATHTYPE const *buffer) const
+	{
+		bool ret = false;
+		if constexpr (is_leaf<L>)
+			ret = ret || left_expr.reads(buffer);
+		if constexpr (is_leaf<R>)
+			ret = ret || right_expr.reads(buffer);
+		return ret;
+	}
+};
+
+inline Ref lazy(Matrix const &matrix)
+{
+	return Ref(matrix);
+}
+inline Owned lazy(Matrix &&matrix)
+{
+	return Owned(std::move(matrix));
+}
+
+template <typename T>
+concept Node = std::derived_from<std::remove_cvref_t<T>, Expression>;
+template <typename T>
+concept MatrixOperand = Node<T> || std::same_as<std::remove_cvref_t<T>, Matrix>;
+template <typename T>
+concept ScalarOperand = std::is_arithmetic_v<std::remove_cvref_t<T>>;
+
+// Nodes are copied into their parent, matrices are referenced (or moved in when temporary), numbers become Scalar
+template <typename T>
+auto wrap(T &&operand)
+{
+	if constexpr (Node<T>)
+		return std::remove_cvref_t<T>(std::forward<T>(operand));
+	else if constexpr (ScalarOperand<T>)
+		return Scalar{ MATHTYPE(operand) };
+	else
+		return lazy(std::forward<T>(operand));
+}
+template <typename T>
+using Wrapped = decltype(wrap(std::declval<T>()));
+
+// At least one side has to be an expression already, plain Matrix arithmetic stays eager
+template <typename A, typename B>
+requires ((Node<A> && (MatrixOperand<B> || ScalarOperand<B>)) || (Node<B> && (MatrixOperand<A> || ScalarOperand<A>)))
+Binary<Add, Wrapped<A>, Wrapped<B>> operator+(A &&a, B &&b)
+{
+	return { wrap(std::forward<A>(a)), wrap(std::forward<B>(b)) };
+}
+template <typename A, typename B>
+requires ((Node<A> && (MatrixOperand<B> || ScalarOperand<B>)) || (Node<B> && (MatrixOperand<A> || ScalarOperand<A>)))
+Binary<Sub, Wrapped<A>, Wrapped<B>> operator-(A &&a, B &&b)
+{
+	return { wrap(std::forward<A>(a)), wrap(std::forward<B>(b)) };
+}
+template <typename A, typename B>
+requires ((Node<A> && MatrixOperand<B>) || (Node<B> && MatrixOperand<A>))
+Product<Wrapped<A>, Wrapped<B>> operator*(A &&a, B &&b)
+{
+	return { wrap(std::forward<A>(a)), wrap(std::forward<B>(b)) };
+}
+template <typename A, typename B>
+requires (Node<A> && ScalarOperand<B>)
+Binary<Mul, Wrapped<A>, Scalar> operator*(A &&a, B b)
+{
+	return { wrap(std::forward<A>(a)), Scalar{ MATHTYPE(b) } };
+}
+template <typename A, typename B>
+requires (ScalarOperand<A> && Node<B>)
+Binary<Mul, Scalar, Wrapped<B>> operator*(A a, B &&b)
+{
+	return { Scalar{ MATHTYPE(a) }, wrap(std::forward<B>(b)) };
+}
+template <typename A, typename B>
+requires (Node<A> && ScalarOperand<B>)
+Binary<Div, Wrapped<A>, Scalar> operator/(A &&a, B b)
+{
+	return { wrap(std::forward<A>(a)), Scalar{ MATHTYPE(b) } };
+}
+template <typename A>
+requires Node<A>
+Negate<Wrapped<A>> operator-(A &&a)
+{
+	return Negate<Wrapped<A>>(wrap(std::forward<A>(a)));
+}
+template <typename A>
+requires Node<A>
+Wrapped<A> operator+(A &&a)
+{
+	return wrap(std::forward<A>(a));
+}
+
+// The spine is the top of the tree made of +, -, negation and scaling by a Scalar. Products on the spine are
+// accumulated into the destination by gemm, everything else is computed by the fused elementwise pass.
+template <typename T>
+constexpr bool is_product = false;
+template <typename L, typename R>
+constexpr bool is_product<Product<L, R>> = true;
+template <typename T>
+constexpr bool is_negate = false;
+template <typename E>
+constexpr bool is_negate<Negate<E>> = true;
+
+// Scale applied to the spine term `inner` of a spine node, and whether it is one
+template <typename T>
+struct Spine {
+	static constexpr bool value = false;
+};
+template <typename L, typename R>
+struct Spine<Binary<Add, L, R>> {
+	static constexpr bool value = true;
+};
+template <typename L, typename R>
+struct Spine<Binary<Sub, L, R>> {
+	static constexpr bool value = true;
+};
+template <typename E>
+struct Spine<Negate<E>> {
+	static constexpr bool value = true;
+};
+template <typename E>
+struct Spine<Binary<Mul, E, Scalar>> {
+	static constexpr bool value = true;
+};
+template <typename E>
+struct Spine<Binary<Mul, Scalar, E>> {
+	static constexpr bool value = true;
+};
+template <typename E>
+struct Spine<Binary<Div, E, Scalar>> {
+	static constexpr bool value = true;
+};
+
+template <typename E>
+void prepare_spine(E const &expr)
+{
+	if constexpr (is_product<E>)
+		expr.prepare_operands();
+	else if constexpr (std::same_as<E, Scalar>)
+		return;
+	else if constexpr (Spine<E>::value) {
+		if constexpr (is_negate<E>)
+			prepare_spine(expr.inner);
+		else {
+			prepare_spine(expr.left);
+			prepare_spine(expr.right);
+		}
+	} else
+		expr.prepare();
+}
+template <typename E>
+void release_spine(E const &expr)
+{
+	if constexpr (is_product<E>)
+		expr.release_operands();
+	else if constexpr (Spine<E>::value) {
+		if constexpr (is_negate<E>)
+			release_spine(expr.inner);
+		else {
+			release_spine(expr.left);
+			release_spine(expr.right);
+		}
+	}
+}
+
+// cell of the expression minus its spine products
+template <typename E>
+inline MATHTYPE spine_cell(E const &expr, size_t y, size_t x)
+{
+	if constexpr (is_product<E>)
+		return 0;
+	else if constexpr (Spine<E>::value) {
+		if constexpr (is_negate<E>)
+			return -spine_cell(expr.inner, y, x);
+		else
+			return E::OpType::apply(spine_cell(expr.left, y, x), spine_cell(expr.right, y, x));
+	} else
+		return expr.cell(y, x);
+}
+// Whether every matrix the elementwise pass reads has unpadded rows, so it can run as one flat loop
+template <typename E>
+bool spine_packed(E const &expr)
+{
+	if constexpr (is_product<E>)
+		return true;
+	else if constexpr (Spine<E>::value) {
+		if constexpr (is_negate<E>)
+			return spine_packed(expr.inner);
+		else
+			return spine_packed(expr.left) && spine_packed(expr.right);
+	} else
+		return expr.packed();
+}
+
+template <typename E>
+constexpr bool spine_has_products()
+{
+	if constexpr (is_product<E>)
+		return true;
+	else if constexpr (Spine<E>::value) {
+		if constexpr (is_negate<E>)
+			return spine_has_products<decltype(E::inner)>();
+		else
+			return spine_has_products<decltype(E::left)>() || spine_has_products<decltype(E::right)>();
+	} else
+		return false;
+}
+// Whether the spine is nothing but products, so the elementwise pass can be skipped
+template <typename E>
+constexpr bool spine_only_products()
+{
+	if constexpr (is_product<E>)
+		return true;
+	else if constexpr (Spine<E>::value) {
+		if constexpr (is_negate<E>)
+			return spine_only_products<decltype(E::inner)>();
+		else if constexpr (std::same_as<typename E::OpType, Mul> || std::same_as<typename E::OpType, Div>)
+			return spine_only_products<decltype(E::left)>() || spine_only_products<decltype(E::right)>();
+		else
+			return spine_only_products<decltype(E::left)>() && spine_only_products<decltype(E::right)>();
+	} else
+		return false;
+}
+
+// Runs gemm for every spine product with its accumulated scale. The first one overwrites dst when `overwrite`
+template <typename E>
+void accumulate_spine(E const &expr, MATHTYPE scale, MatrixView dst, bool &overwrite)
+{
+	if constexpr (is_product<E>) {
+		Matrix::gemm(scale, expr.left(), expr.right(), overwrite ? 0 : 1, dst);
+		overwrite = false;
+	} else if constexpr (Spine<E>::value) {
+		if constexpr (is_negate<E>)
+			accumulate_spine(expr.inner, -scale, dst, overwrite);
+		else {
+			using Op = typename E::OpType;
+			if constexpr (std::same_as<Op, Add>) {
+				accumulate_spine(expr.left, scale, dst, overwrite);
+				accumulate_spine(expr.right, scale, dst, overwrite);
+			} else if constexpr (std::same_as<Op, Sub>) {
+				accumulate_spine(expr.left, scale, dst, overwrite);
+				accumulate_spine(expr.right, -scale, dst, overwrite);
+			} else if constexpr (std::same_as<decltype(E::left), Scalar>)
+				accumulate_spine(expr.right, scale * expr.left.value, dst, overwrite);
+			else if constexpr (std::same_as<Op, Mul>)
+				accumulate_spine(expr.left, scale * expr.right.value, dst, overwrite);
+			else
+				accumulate_spine(expr.left, scale / expr.right.value, dst, overwrite);
+		}
+	}
+}
+
+// Whether evaluating expr into buffer in place would have gemm read cells it already overwrote
+template <typename E>
+requires std::derived_from<E, Expression>
+bool spine_products_read(E const &expr, MATHTYPE const *buffer)
+{
+	if constexpr (is_product<E>)
+		return expr.reads_directly(buffer);
+	else if constexpr (Spine<E>::value) {
+		if constexpr (is_negate<E>)
+			return spine_products_read(expr.inner, buffer);
+		else {
+			bool ret = false;
+			if constexpr (!std::same_as<decltype(E::left), Scalar>)
+				ret = spine_products_read(expr.left, buffer);
+			if constexpr (!std::same_as<decltype(E::right), Scalar>)
+				ret = ret || spine_products_read(expr.right, buffer);
+			return ret;
+		}
+	} else
+		return false;
+}
+
+// Computes expr into dst, which has its size. Called by Matrix's expression constructor and assignment
+template <typename E>
+requires std::derived_from<E, Expression>
+void evaluate_expression(E const &expr, Matrix &dst)
+{
+	prepare_spine(expr);
+	bool overwrite = true;
+	if constexpr (!spine_only_products<E>()) {
+		bool packed = dst.stride() == dst.width && spine_packed(expr);
+		size_t const rows = packed ? 1 : dst.height;
+		size_t const columns = packed ? (size_t) dst.width * dst.height : dst.width;
+		for (size_t y = 0; y < rows; ++y) {
+			MATHTYPE *out = dst.data() + y * dst.stride();
+			// leaves may be dst itself, but each cell only reads the same cell of its operands
+#if defined(__GNUC__) && !defined(__clang__)
+#pragma GCC ivdep
+#endif
+			for (size_t x = 0; x < columns; ++x)
+				out[x] = spine_cell(expr, y, x);
+		}
+		overwrite = false;
+	}
+	if constexpr (spine_has_products<E>()) {
+		accumulate_spine(expr, 1, dst, overwrite);
+		release_spine(expr);
+	}
+}
+}
+
+namespace ZMathLib_Graphics {
+using Expr::lazy;
+}
+
+#endif
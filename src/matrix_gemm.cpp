@@ -0,0 +1,247 @@
+#include "mathtype.hpp"
+#include "matrix_kernels.hpp"
+#include "matrix_threads.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <vector>
+
+// Goto-style blocked GEMM:
+//  - B is packed into kc x NR panels that stay in L3/L2 across a whole block row of C,
+//  - A is packed into MR x kc panels that stay in L2 across a block column,
+//  - an MR x NR micro-kernel keeps its tile of C in registers for the whole kc loop.
+// Packing makes both operands unit-stride for the micro-kernel, so no transposition is ever needed.
+// The register tile shape depends on the vector width, so the blocked path is picked from CPUID on first use.
+// On large products the thread pool packs B panels in parallel, then runs blocks of C (MC rows, split further
+// by columns when there are few of them) on separate threads, each packing its own A panel. Every cell of C
+// is summed in the same order however the blocks are spread, so the thread count doesn't change results.
+
+namespace ZMathLib_Graphics::Kernels {
+namespace {
+// A panel: MC x KC, B panel: KC x NC
+constexpr size_t KC = 256;
+// below this many multiply-adds, packing costs more than it saves
+constexpr size_t SMALL_GEMM = 32 * 32 * 32;
+// multiply-adds, or cells packed, below which a second thread costs more than it saves
+constexpr size_t PARALLEL_GEMM = 64 * 64 * 64;
+constexpr size_t PARALLEL_PACK = size_t(1) << 15;
+// cells per 128-bit vector register, micro-tile widths are given in multiples of it
+constexpr size_t LANES = 16 / sizeof(MATHTYPE) > 0 ? 16 / sizeof(MATHTYPE) : 1;
+
+void gemm_small(size_t m, size_t n, size_t k, MATHTYPE alpha,
+	MATHTYPE const *a, size_t lda,
+	MATHTYPE const *b, size_t ldb,
+	MATHTYPE beta, MATHTYPE *c, size_t ldc)
+{
+	for (size_t y = 0; y < m; ++y) {
+		MATHTYPE *cRow = c + y * ldc;
+		if (beta == 0)
+			std::fill(cRow, cRow + n, MATHTYPE(0));
+		else if (beta != 1)
+			for (size_t x = 0; x < n; ++x)
+				cRow[x] *= beta;
+		for (size_t i = 0; i < k; ++i) {
+			MATHTYPE av = alpha * a[y * lda + i];
+			MATHTYPE const *bRow = b + i * ldb;
+			for (size_t x = 0; x < n; ++x)
+				cRow[x] += av * bRow[x];
+		}
+	}
+}
+
+
+// A kc deep slice of the product with its B columns packed, cut into blocks of MC rows x chunkPanels NR-wide
+// panels that threads run independently
+struct Slice {
+	size_t m, nc, kc;
+	MATHTYPE alpha, beta;
+	// A and C from the slice's first column
+	MATHTYPE const *a;
+	size_t lda;
+	MATHTYPE const *packedB;
+	MATHTYPE *c;
+	size_t ldc;
+	size_t columnChunks, chunkPanels;
+};
+
+// MR x NR is the register tile of C, chosen per instruction set so the accumulators fit in registers
+template <size_t MR, size_t NR>
+struct Blocked {
+	static constexpr size_t MC = MR * 16;
+	static constexpr size_t NC = NR * 128;
+
+	// Packs rows [0, mc) x columns [0, kc) of A into MR-row panels, column-interleaved, zero padding the last panel
+	static void pack_a(size_t mc, size_t kc, MATHTYPE const *a, size_t lda, MATHTYPE *packed)
+	{
+		for (size_t ir = 0; ir < mc; ir += MR) {
+			size_t mr = std::min(MR, mc - ir);
+			for (size_t p = 0; p < kc; ++p) {
+				for (size_t i = 0; i < mr; ++i)
+					packed[i] = a[(ir + i) * lda + p];
+				for (size_t i = mr; i < MR; ++i)
+					packed[i] = 0;
+				packed += MR;
+			}
+		}
+	}
+
+	// Packs rows [0, kc) x columns [0, nc) of B into NR-column panels, zero padding the last panel
+	static void pack_b(size_t kc, size_t nc, MATHTYPE const *b, size_t ldb, MATHTYPE *packed)
+	{
+		for (size_t jr = 0; jr < nc; jr += NR) {
+			size_t nr = std::min(NR, nc - jr);
+			for (size_t p = 0; p < kc; ++p) {
+				MATHTYPE const *bRow = b + p * ldb + jr;
+				for (size_t j = 0; j < nr; ++j)
+					packed[j] = bRow[j];
+				for (size_t j = nr; j < NR; ++j)
+					packed[j] = 0;
+				packed += NR;
+			}
+		}
+	}
+
+	// C tile (mr x nr) = alpha * Apanel * Bpanel + beta * C tile
+	// The accumulator is a fixed MR x NR block so the compiler keeps it in vector registers.
+	static void micro_kernel(size_t kc, MATHTYPE alpha, MATHTYPE const *__restrict ap, MATHTYPE const *__restrict bp,
+		MATHTYPE beta, MATHTYPE *__restrict c, size_t ldc, size_t mr, size_t nr)
+	{
+		MATHTYPE acc[MR][NR] = {};
+		for (size_t p = 0; p < kc; ++p) {
+			MATHTYPE const *bv = bp + p * NR;
+			MATHTYPE const *av = ap + p * MR;
+			for (size_t i = 0; i < MR; ++i)
+				for (size_t j = 0; j < NR; ++j)
+					acc[i][j] += av[i] * bv[j];
+		}
+		for (size_t i = 0; i < mr; ++i) {
+			MATHTYPE *cRow = c + i * ldc;
+			if (beta == 0) {
+				for (size_t j = 0; j < nr; ++j)
+					cRow[j] = alpha * acc[i][j];
+			} else {
+				for (size_t j = 0; j < nr; ++j)
+					cRow[j] = alpha * acc[i][j] + beta * cRow[j];
+			}
+		}
+	}
+
+	// Runs blocks [begin, end) of the slice
+	static void run_blocks(Slice const &slice, size_t begin, size_t end)
+	{
+		thread_local std::vector<MATHTYPE> packedA;
+		packedA.resize(MC * KC);
+		for (size_t block = begin; block < end; ++block) {
+			size_t ic = block / slice.columnChunks * MC;
+			size_t mc = std::min(MC, slice.m - ic);
+			size_t jrBegin = block % slice.columnChunks * slice.chunkPanels * NR;
+			size_t jrEnd = std::min(slice.nc, jrBegin + slice.chunkPanels * NR);
+			// blocks of the same rows share the packed A panel
+			if (block == begin || block % slice.columnChunks == 0)
+				pack_a(mc, slice.kc, slice.a + ic * slice.lda, slice.lda, packedA.data());
+			for (size_t jr = jrBegin; jr < jrEnd; jr += NR) {
+				for (size_t ir = 0; ir < mc; ir += MR) {
+					micro_kernel(slice.kc, slice.alpha, packedA.data() + ir * slice.kc, slice.packedB + jr * slice.kc,
+						slice.beta, slice.c + (ic + ir) * slice.ldc + jr, slice.ldc,
+						std::min(MR, mc - ir), std::min(NR, slice.nc - jr));
+				}
+			}
+		}
+	}
+};
+
+// The blocked path for one instruction set. run_blocks is compiled for that instruction set, the loops
+// around it (and packing B, which is only copies) are not.
+struct BlockedKernels {
+	size_t nr, mc, nc;
+	void (*pack_b)(size_t kc, size_t nc, MATHTYPE const *b, size_t ldb, MATHTYPE *packed);
+	void (*run_blocks)(Slice const &slice, size_t begin, size_t end);
+};
+
+template <size_t MR, size_t NR>
+constexpr BlockedKernels blocked_kernels(void (*runBlocks)(Slice const &, size_t, size_t))
+{
+	return BlockedKernels{ NR, Blocked<MR, NR>::MC, Blocked<MR, NR>::NC, Blocked<MR, NR>::pack_b, runBlocks };
+}
+
+// Tile shapes were picked by measuring, `flatten` compiles the micro-kernel loop nest for the wider ISA.
+constexpr size_t GENERIC_MR = 4, GENERIC_NR = 2 * LANES;
+void run_blocks_generic(Slice const &slice, size_t begin, size_t end)
+{
+	Blocked<GENERIC_MR, GENERIC_NR>::run_blocks(slice, begin, end);
+}
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+constexpr size_t AVX2_MR = 6, AVX2_NR = 6 * LANES;
+__attribute__((target("avx2,fma"), flatten))
+void run_blocks_avx2(Slice const &slice, size_t begin, size_t end)
+{
+	Blocked<AVX2_MR, AVX2_NR>::run_blocks(slice, begin, end);
+}
+constexpr size_t AVX512_MR = 4, AVX512_NR = 8 * LANES;
+__attribute__((target("avx512f,fma"), flatten))
+void run_blocks_avx512(Slice const &slice, size_t begin, size_t end)
+{
+	Blocked<AVX512_MR, AVX512_NR>::run_blocks(slice, begin, end);
+}
+#endif
+
+BlockedKernels select_blocked()
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("fma"))
+		return blocked_kernels<AVX512_MR, AVX512_NR>(run_blocks_avx512);
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+		return blocked_kernels<AVX2_MR, AVX2_NR>(run_blocks_avx2);
+#endif
+	return blocked_kernels<GENERIC_MR, GENERIC_NR>(run_blocks_generic);
+}
+
+void gemm_blocked(BlockedKernels const &kernels, size_t m, size_t n, size_t k, MATHTYPE alpha,
+	MATHTYPE const *a, size_t lda,
+	MATHTYPE const *b, size_t ldb,
+	MATHTYPE beta, MATHTYPE *c, size_t ldc)
+{
+	size_t nr = kernels.nr;
+	std::vector<MATHTYPE> packedB(std::min(kernels.nc, (n + nr - 1) / nr * nr) * KC);
+	size_t rowBlocks = (m + kernels.mc - 1) / kernels.mc;
+	for (size_t jc = 0; jc < n; jc += kernels.nc) {
+		size_t nc = std::min(kernels.nc, n - jc);
+		size_t panels = (nc + nr - 1) / nr;
+		// with few row blocks, each is also split by columns so every thread gets some
+		size_t columnChunks = std::min(panels, std::max<size_t>(1, thread_count() * 2 / rowBlocks));
+		size_t chunkPanels = (panels + columnChunks - 1) / columnChunks;
+		columnChunks = (panels + chunkPanels - 1) / chunkPanels;
+		for (size_t pc = 0; pc < k; pc += KC) {
+			size_t kc = std::min(KC, k - pc);
+			parallel_for(panels, std::max<size_t>(1, PARALLEL_PACK / (nr * kc)), [&](size_t begin, size_t end) {
+				kernels.pack_b(kc, std::min(nc, end * nr) - begin * nr, b + pc * ldb + jc + begin * nr, ldb,
+					packedB.data() + begin * nr * kc);
+			});
+			// only the first k block applies the caller's beta, the rest accumulate
+			Slice slice{ m, nc, kc, alpha, pc == 0 ? beta : MATHTYPE(1), a + pc, lda, packedB.data(), c + jc, ldc,
+				columnChunks, chunkPanels };
+			size_t blockWork = kernels.mc * chunkPanels * nr * kc;
+			parallel_for(rowBlocks * columnChunks, std::max<size_t>(1, PARALLEL_GEMM / blockWork),
+				[&](size_t begin, size_t end) {
+					kernels.run_blocks(slice, begin, end);
+				});
+		}
+	}
+}
+}
+
+void gemm(size_t m, size_t n, size_t k, MATHTYPE alpha,
+	MATHTYPE const *a, size_t lda,
+	MATHTYPE const *b, size_t ldb,
+	MATHTYPE beta, MATHTYPE *c, size_t ldc)
+{
+	if (m == 0 || n == 0)
+		return;
+	if (k == 0 || m * n * k <= SMALL_GEMM) {
+		gemm_small(m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+		return;
+	}
+	static BlockedKernels const blocked = select_blocked();
+	gemm_blocked(blocked, m, n, k, alpha, a, lda, b, ldb, beta, c, ldc);
+}
+}
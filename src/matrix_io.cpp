@@ -0,0 +1,377 @@
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include "matrix_io.hpp"
+#include "vector.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define ZMATH_HAS_MMAP
+#endif
+
+namespace ZMathLib_Graphics {
+namespace {
+static_assert(std::is_same_v<MATHTYPE, float> || std::is_same_v<MATHTYPE, double>,
+	"Matrix files hold IEEE-754 floats or doubles");
+constexpr uint16_t NATIVE_CELL = sizeof(MATHTYPE) == 4 ? MatrixFileHeader::CELL_FLOAT32 : MatrixFileHeader::CELL_FLOAT64;
+// cells start on a cache line, which also keeps every row alignment up to 64 bytes intact in a mapping
+constexpr uint64_t DATA_ALIGNMENT = 64;
+// a mapping is only page aligned, rows aligned to more than a page couldn't keep it
+constexpr uint32_t MAX_ROW_ALIGNMENT = 4096;
+
+template <typename T>
+T byte_swapped(T value)
+{
+	unsigned char bytes[sizeof(T)];
+	std::memcpy(bytes, &value, sizeof(T));
+	std::reverse(bytes, bytes + sizeof(T));
+	std::memcpy(&value, bytes, sizeof(T));
+	return value;
+}
+
+size_t cell_size(MatrixFileHeader const &header)
+{
+	return header.cellType == MatrixFileHeader::CELL_FLOAT32 ? 4 : 8;
+}
+
+// The header in this machine's byte order, checked for everything that doesn't depend on the file size.
+// swapped is set if the cells need byte swapping too.
+MatrixFileHeader parse_header(MatrixFileHeader header, bool &swapped)
+{
+	if (std::memcmp(header.magic, "ZMTX", 4) != 0)
+		throw std::invalid_argument("Not a matrix file, expected it to start with ZMTX");
+	swapped = header.byteOrder != MatrixFileHeader::BYTE_ORDER_MARK;
+	if (swapped) {
+		if (byte_swapped(header.byteOrder) != MatrixFileHeader::BYTE_ORDER_MARK)
+			throw std::invalid_argument("Unrecognized byte order in matrix file");
+		header.version = byte_swapped(header.version);
+		header.cellType = byte_swapped(header.cellType);
+		header.rowAlignment = byte_swapped(header.rowAlignment);
+		header.width = byte_swapped(header.width);
+		header.height = byte_swapped(header.height);
+		header.stride = byte_swapped(header.stride);
+		header.dataOffset = byte_swapped(header.dataOffset);
+	}
+	if (header.version != MatrixFileHeader::VERSION)
+		throw std::invalid_argument("Unsupported matrix file version");
+	if (header.cellType != MatrixFileHeader::CELL_FLOAT32 && header.cellType != MatrixFileHeader::CELL_FLOAT64)
+		throw std::invalid_argument("Unsupported cell type in matrix file");
+	if (header.stride < header.width || header.dataOffset < sizeof(MatrixFileHeader) || header.dataOffset % DATA_ALIGNMENT != 0)
+		throw std::invalid_argument("Inconsistent layout in matrix file header");
+	// a Matrix can't be empty, so neither can its file
+	if (header.width == 0 || header.height == 0)
+		throw std::invalid_argument("Matrix file has no cells");
+	if (header.rowAlignment > MAX_ROW_ALIGNMENT)
+		throw std::invalid_argument("Matrix file rows are aligned to more than 4096 bytes");
+	// every row, padding included, has to fit in memory
+	if (header.stride > std::numeric_limits<size_t>::max() / cell_size(header) / header.height)
+		throw std::invalid_argument("Matrix file is larger than memory can address");
+	return header;
+}
+
+// bytes from dataOffset to the end of the last row, or max() if that doesn't fit in a size_t
+uint64_t cells_bytes(MatrixFileHeader const &header)
+{
+	if (header.height == 0)
+		return 0;
+	uint64_t rows = header.height - 1;
+	uint64_t maxCells = std::numeric_limits<uint64_t>::max() / cell_size(header);
+	if (rows != 0 && header.stride > (maxCells - header.width) / rows)
+		return std::numeric_limits<uint64_t>::max();
+	return (rows * header.stride + header.width) * cell_size(header);
+}
+
+// cellCount cells of the header's type at `bytes` into `out`
+void convert_cells(MatrixFileHeader const &header, bool swapped, unsigned char const *bytes, size_t cellCount, MATHTYPE *out)
+{
+	if (header.cellType == NATIVE_CELL && !swapped) {
+		std::memcpy(out, bytes, cellCount * sizeof(MATHTYPE));
+		return;
+	}
+	for (size_t i = 0; i < cellCount; ++i) {
+		if (header.cellType == MatrixFileHeader::CELL_FLOAT32) {
+			float cell;
+			std::memcpy(&cell, bytes + i * 4, 4);
+			out[i] = (MATHTYPE) (swapped ? byte_swapped(cell) : cell);
+		} else {
+			double cell;
+			std::memcpy(&cell, bytes + i * 8, 8);
+			out[i] = (MATHTYPE) (swapped ? byte_swapped(cell) : cell);
+		}
+	}
+}
+
+void write_cells(std::ostream &out, MATHTYPE const *cells, unsigned int width, unsigned int height, size_t ld,
+	size_t stride, size_t rowAlignment)
+{
+	if (width == 0 || height == 0)
+		throw std::invalid_argument("Can't write a matrix file with no cells");
+	if (rowAlignment > MAX_ROW_ALIGNMENT)
+		throw std::invalid_argument("Can't write a matrix file with rows aligned to more than 4096 bytes");
+	MatrixFileHeader header = {};
+	std::memcpy(header.magic, "ZMTX", 4);
+	header.byteOrder = MatrixFileHeader::BYTE_ORDER_MARK;
+	header.version = MatrixFileHeader::VERSION;
+	header.cellType = NATIVE_CELL;
+	header.rowAlignment = (uint32_t) rowAlignment;
+	header.width = width;
+	header.height = height;
+	header.stride = stride;
+	header.dataOffset = std::max<uint64_t>(DATA_ALIGNMENT, rowAlignment);
+	out.write(reinterpret_cast<char const *>(&header), sizeof(header));
+	std::vector<char> zeros(std::max<size_t>(header.dataOffset - sizeof(header), (stride - width) * sizeof(MATHTYPE)));
+	out.write(zeros.data(), header.dataOffset - sizeof(header));
+	if (ld == stride && ld == width) {
+		out.write(reinterpret_cast<char const *>(cells), sizeof(MATHTYPE) * width * height);
+	} else {
+		// the padding is written as zeros whatever the source holds there
+		for (unsigned int y = 0; y < height && out; ++y) {
+			out.write(reinterpret_cast<char const *>(cells + y * ld), sizeof(MATHTYPE) * width);
+			out.write(zeros.data(), (stride - width) * sizeof(MATHTYPE));
+		}
+	}
+	if (!out)
+		throw std::runtime_error("Failed writing matrix to stream");
+}
+
+template <typename Write>
+void write_file(std::string const &path, Write const &write)
+{
+	std::ofstream out(path, std::ios::binary | std::ios::trunc);
+	if (!out)
+		throw std::runtime_error("Couldn't open " + path + " for writing");
+	write(out);
+	out.close();
+	if (!out)
+		throw std::runtime_error("Failed writing matrix file " + path);
+}
+
+MatrixConstView vectors_view(MATHTYPE const *cells, unsigned int components, size_t count)
+{
+	if (count > std::numeric_limits<unsigned int>::max())
+		throw std::invalid_argument("Too many vectors for one matrix file");
+	return MatrixConstView(cells, components, (unsigned int) count);
+}
+}
+
+void write_matrix(std::ostream &out, MatrixConstView mtx)
+{
+	write_cells(out, mtx.data, mtx.width, mtx.height, mtx.stride, mtx.width, 0);
+}
+void write_matrix(std::string const &path, MatrixConstView mtx)
+{
+	write_file(path, [&](std::ostream &out) { write_matrix(out, mtx); });
+}
+void write_vectors(std::ostream &out, std::span<Vec3 const> vectors)
+{
+	write_matrix(out, vectors_view(reinterpret_cast<MATHTYPE const *>(vectors.data()), 3, vectors.size()));
+}
+void write_vectors(std::ostream &out, std::span<Vec4 const> vectors)
+{
+	write_matrix(out, vectors_view(reinterpret_cast<MATHTYPE const *>(vectors.data()), 4, vectors.size()));
+}
+void write_vectors(std::string const &path, std::span<Vec3 const> vectors)
+{
+	write_file(path, [&](std::ostream &out) { write_vectors(out, vectors); });
+}
+void write_vectors(std::string const &path, std::span<Vec4 const> vectors)
+{
+	write_file(path, [&](std::ostream &out) { write_vectors(out, vectors); });
+}
+
+void Matrix::write(std::ostream &out) const
+{
+	write_cells(out, _array, width, height, _stride, _stride, _rowAlignment);
+}
+void Matrix::write(std::string const &path) const
+{
+	write_file(path, [&](std::ostream &out) { write(out); });
+}
+
+Matrix Matrix::read(std::istream &in)
+{
+	MatrixFileHeader raw;
+	if (!in.read(reinterpret_cast<char *>(&raw), sizeof(raw)))
+		throw std::runtime_error("Failed reading matrix file header");
+	bool swapped;
+	MatrixFileHeader header = parse_header(raw, swapped);
+	in.ignore(header.dataOffset - sizeof(header));
+
+	// keep the writer's row alignment when it suits this cell type
+	size_t alignment = header.rowAlignment;
+	bool alignable = alignment % sizeof(MATHTYPE) == 0 && (alignment & (alignment - 1)) == 0;
+	Matrix ret(header.width, header.height, Uninitialized(), alignable ? alignment : 0);
+	size_t cellSize = cell_size(header);
+	bool direct = header.cellType == NATIVE_CELL && !swapped;
+	if (direct && header.stride == ret._stride) {
+		// the file holds the buffer as it is, padding included, except maybe the last row's (zeroed already)
+		size_t cells = (ret.height - 1) * ret._stride + ret.width;
+		in.read(reinterpret_cast<char *>(ret._array), (std::streamsize) (sizeof(MATHTYPE) * cells));
+	} else {
+		std::vector<unsigned char> row(header.width * cellSize);
+		size_t padding = (header.stride - header.width) * cellSize;
+		for (unsigned int y = 0; y < ret.height && in; ++y) {
+			in.read(reinterpret_cast<char *>(row.data()), (std::streamsize) row.size());
+			convert_cells(header, swapped, row.data(), ret.width, ret._array + y * ret._stride);
+			// the last row's padding may be missing from the file
+			if (y + 1 < ret.height)
+				in.ignore((std::streamsize) padding);
+		}
+	}
+	if (!in)
+		throw std::runtime_error("Matrix file ended before all of its cells");
+	return ret;
+}
+Matrix Matrix::read(std::string const &path)
+{
+	std::ifstream in(path, std::ios::binary);
+	if (!in)
+		throw std::runtime_error("Couldn't open " + path + " for reading");
+	return read(in);
+}
+
+MappedMatrix::MappedMatrix(std::string const &path)
+{
+#ifdef ZMATH_HAS_MMAP
+	int fd = open(path.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw std::runtime_error("Couldn't open " + path + " for reading");
+	struct stat info;
+	if (fstat(fd, &info) != 0) {
+		close(fd);
+		throw std::runtime_error("Couldn't stat " + path);
+	}
+	_size = (size_t) info.st_size;
+	if (_size < sizeof(MatrixFileHeader)) {
+		close(fd);
+		throw std::invalid_argument("Not a matrix file, " + path + " is shorter than a header");
+	}
+	void *mapping = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, fd, 0);
+	// the mapping keeps the file open on its own
+	close(fd);
+	if (mapping == MAP_FAILED)
+		throw std::runtime_error("Couldn't map " + path);
+	_mapping = mapping;
+#else
+	// no mmap, read the whole file into memory with a single read instead
+	std::ifstream in(path, std::ios::binary | std::ios::ate);
+	if (!in)
+		throw std::runtime_error("Couldn't open " + path + " for reading");
+	_size = (size_t) in.tellg();
+	if (_size < sizeof(MatrixFileHeader))
+		throw std::invalid_argument("Not a matrix file, " + path + " is shorter than a header");
+	_mapping = ::operator new(_size, std::align_val_t(DATA_ALIGNMENT));
+	in.seekg(0);
+	if (!in.read(static_cast<char *>(_mapping), (std::streamsize) _size)) {
+		unmap();
+		throw std::runtime_error("Failed reading " + path);
+	}
+#endif
+	try {
+		MatrixFileHeader raw;
+		std::memcpy(&raw, _mapping, sizeof(raw));
+		bool swapped;
+		MatrixFileHeader header = parse_header(raw, swapped);
+		if (swapped || header.cellType != NATIVE_CELL)
+			throw std::invalid_argument("Can only map matrix files of this build's cell type and byte order, Matrix::read converts");
+		uint64_t bytes = cells_bytes(header);
+		if (header.dataOffset > _size || bytes > _size - header.dataOffset)
+			throw std::invalid_argument("Matrix file " + path + " is truncated");
+		_cells = reinterpret_cast<MATHTYPE const *>(static_cast<unsigned char const *>(_mapping) + header.dataOffset);
+		_width = header.width;
+		_height = header.height;
+		_stride = header.stride;
+	} catch (...) {
+		unmap();
+		throw;
+	}
+}
+MappedMatrix::~MappedMatrix()
+{
+	unmap();
+}
+MappedMatrix::MappedMatrix(MappedMatrix &&other) noexcept
+	: _mapping(std::exchange(other._mapping, nullptr)), _size(std::exchange(other._size, 0)),
+	_cells(std::exchange(other._cells, nullptr)), _width(std::exchange(other._width, 0)),
+	_height(std::exchange(other._height, 0)), _stride(std::exchange(other._stride, 0))
+{
+}
+MappedMatrix &MappedMatrix::operator=(MappedMatrix &&other) noexcept
+{
+	if (this != &other) {
+		unmap();
+		_mapping = std::exchange(other._mapping, nullptr);
+		_size = std::exchange(other._size, 0);
+		_cells = std::exchange(other._cells, nullptr);
+		_width = std::exchange(other._width, 0);
+		_height = std::exchange(other._height, 0);
+		_stride = std::exchange(other._stride, 0);
+	}
+	return *this;
+}
+void MappedMatrix::unmap()
+{
+	if (_mapping == nullptr)
+		return;
+#ifdef ZMATH_HAS_MMAP
+	munmap(_mapping, _size);
+#else
+	::operator delete(_mapping, std::align_val_t(DATA_ALIGNMENT));
+#endif
+	_mapping = nullptr;
+	_cells = nullptr;
+}
+
+unsigned int MappedMatrix::width() const
+{
+	return _width;
+}
+unsigned int MappedMatrix::height() const
+{
+	return _height;
+}
+size_t MappedMatrix::stride() const
+{
+	return _stride;
+}
+MATHTYPE const *MappedMatrix::data() const
+{
+	return _cells;
+}
+MatrixConstView MappedMatrix::view() const
+{
+	return MatrixConstView(_cells, _width, _height, _stride);
+}
+MappedMatrix::operator MatrixConstView() const
+{
+	return view();
+}
+std::span<Vec3 const> MappedMatrix::as_vec3s() const
+{
+	if (_width != 3 || (_stride != 3 && _height > 1))
+		throw std::invalid_argument("MappedMatrix::as_vec3s() expects packed rows of 3 cells");
+	return std::span<Vec3 const>(reinterpret_cast<Vec3 const *>(_cells), _height);
+}
+std::span<Vec4 const> MappedMatrix::as_vec4s() const
+{
+	if (_width != 4 || (_stride != 4 && _height > 1))
+		throw std::invalid_argument("MappedMatrix::as_vec4s() expects packed rows of 4 cells");
+	return std::span<Vec4 const>(reinterpret_cast<Vec4 const *>(_cells), _height);
+}
+}
@@ -0,0 +1,95 @@
+#ifndef MATRIX_IO_HPP
+#define MATRIX_IO_HPP
+
+#include "mathtype.hpp"
+#include "matrix_view.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <iosfwd>
+#include <span>
+#include <string>
+
+// Binary matrix files. A file is a 64 byte MatrixFileHeader followed, from header.dataOffset, by `height` rows
+// of `stride` cells each, the first `width` of which are the row, and the last row's padding may be left out.
+// Everything is in the byte order of the machine that wrote it, which byteOrder records. Rows start at multiples
+// of rowAlignment bytes (at most 4096) from dataOffset, itself a multiple of 64, so a file mapped at a page
+// boundary has the same aligned rows as the Matrix it came from.
+//
+// Matrix::write / Matrix::read copy through a stream and convert between cell types and byte orders.
+// MappedMatrix maps a file with this build's cell type and byte order, and uses its pages directly.
+
+namespace ZMathLib_Graphics {
+struct Matrix;
+struct Vec3;
+struct Vec4;
+
+struct MatrixFileHeader {
+	// "ZMTX"
+	char magic[4];
+	// BYTE_ORDER_MARK as the writer stored it, reads back swapped from a machine of the other byte order
+	uint32_t byteOrder;
+	uint16_t version;
+	// CELL_FLOAT32 or CELL_FLOAT64, IEEE-754
+	uint16_t cellType;
+	// bytes, 0 when the rows are packed
+	uint32_t rowAlignment;
+	uint32_t width, height;
+	// cells between the starts of two rows
+	uint64_t stride;
+	// bytes from the start of the file to the first cell
+	uint64_t dataOffset;
+	uint8_t reserved[24];
+
+	static constexpr uint32_t BYTE_ORDER_MARK = 0x01020304;
+	static constexpr uint16_t VERSION = 1;
+	static constexpr uint16_t CELL_FLOAT32 = 1;
+	static constexpr uint16_t CELL_FLOAT64 = 2;
+};
+static_assert(sizeof(MatrixFileHeader) == 64, "MatrixFileHeader is 64 bytes on disk");
+
+// Writes the viewed cells with packed rows. Throws std::runtime_error if the stream or file fails, and
+// std::invalid_argument, before writing anything, for an empty view or span.
+void write_matrix(std::ostream &out, MatrixConstView mtx);
+void write_matrix(std::string const &path, MatrixConstView mtx);
+// Writes vectors as the rows of a count x 3 (or x 4) matrix, so MappedMatrix::as_vec3s() can map them back
+void write_vectors(std::ostream &out, std::span<Vec3 const> vectors);
+void write_vectors(std::ostream &out, std::span<Vec4 const> vectors);
+void write_vectors(std::string const &path, std::span<Vec3 const> vectors);
+void write_vectors(std::string const &path, std::span<Vec4 const> vectors);
+
+// Read-only matrix backed by a memory mapping of a matrix file. Nothing is read or copied up front, the cells
+// are the file's pages and are loaded by the OS on first touch. Throws std::runtime_error if the file can't be
+// opened or mapped, and std::invalid_argument if it isn't a matrix file, is truncated, or has another cell type
+// or byte order than this build (Matrix::read converts those).
+struct MappedMatrix {
+	explicit MappedMatrix(std::string const &path);
+	~MappedMatrix();
+	MappedMatrix(MappedMatrix &&other) noexcept;
+	MappedMatrix &operator=(MappedMatrix &&other) noexcept;
+	MappedMatrix(MappedMatrix const &) = delete;
+	MappedMatrix &operator=(MappedMatrix const &) = delete;
+
+	unsigned int width() const;
+	unsigned int height() const;
+	// cells between the starts of two rows, as written
+	size_t stride() const;
+	MATHTYPE const *data() const;
+
+	// The cells as a view, usable anywhere a MatrixConstView is (arithmetic, Matrix(view) to copy)
+	MatrixConstView view() const;
+	operator MatrixConstView() const;
+	// The rows as vectors, for files of packed rows 3 (or 4) cells wide, std::invalid_argument otherwise
+	std::span<Vec3 const> as_vec3s() const;
+	std::span<Vec4 const> as_vec4s() const;
+private:
+	void *_mapping = nullptr;
+	size_t _size = 0;
+	MATHTYPE const *_cells = nullptr;
+	unsigned int _width = 0, _height = 0;
+	size_t _stride = 0;
+
+	void unmap();
+};
+}
+
+#endif
@@ -0,0 +1,110 @@
+#ifndef MATRIX_KERNELS_HPP
+#define MATRIX_KERNELS_HPP
+
+#include "mathtype.hpp"
+#include <cstddef>
+#include <functional>
+#include <span>
+
+// Raw buffer kernels shared by the Matrix operators. Internal, not installed with the public headers.
+// All buffers are row-major, `ld*` is the distance in cells between the starts of two consecutive rows.
+namespace ZMathLib_Graphics::Kernels {
+// C (m x n) = alpha * A (m x k) * B (k x n) + beta * C
+// When beta == 0, C is only written, never read.
+void gemm(size_t m, size_t n, size_t k, MATHTYPE alpha,
+	MATHTYPE const *a, size_t lda,
+	MATHTYPE const *b, size_t ldb,
+	MATHTYPE beta, MATHTYPE *c, size_t ldc);
+// C (m x n) = A (m x k) * B (k x n) by Strassen-Winograd, recursing until a side is at most `crossover` long
+// and handing those blocks to gemm. workspace holds strassen_workspace(m, n, k, crossover) cells.
+// C must not overlap A, B or the workspace.
+void strassen(size_t m, size_t n, size_t k,
+	MATHTYPE const *a, size_t lda,
+	MATHTYPE const *b, size_t ldb,
+	MATHTYPE *c, size_t ldc,
+	size_t crossover, MATHTYPE *workspace);
+size_t strassen_workspace(size_t m, size_t n, size_t k, size_t crossover);
+
+// Elementwise kernels over n contiguous cells. out may alias either input.
+// Vectorized with SSE2/AVX2/AVX-512 when the CPU supports it, picked from CPUID on first use.
+void add(MATHTYPE *out, MATHTYPE const *a, MATHTYPE const *b, size_t n);
+void sub(MATHTYPE *out, MATHTYPE const *a, MATHTYPE const *b, size_t n);
+void add_scalar(MATHTYPE *out, MATHTYPE const *a, MATHTYPE scalar, size_t n);
+void sub_scalar(MATHTYPE *out, MATHTYPE const *a, MATHTYPE scalar, size_t n);
+void mul_scalar(MATHTYPE *out, MATHTYPE const *a, MATHTYPE scalar, size_t n);
+void div_scalar(MATHTYPE *out, MATHTYPE const *a, MATHTYPE scalar, size_t n);
+// The same over a rows x cols block of each buffer. Blocks whose rows are back to back run as one contiguous
+// pass, padded or strided ones row by row.
+void add(size_t rows, size_t cols, MATHTYPE *out, size_t ldo, MATHTYPE const *a, size_t lda, MATHTYPE const *b, size_t ldb);
+void sub(size_t rows, size_t cols, MATHTYPE *out, size_t ldo, MATHTYPE const *a, size_t lda, MATHTYPE const *b, size_t ldb);
+void add_scalar(size_t rows, size_t cols, MATHTYPE *out, size_t ldo, MATHTYPE const *a, size_t lda, MATHTYPE scalar);
+void sub_scalar(size_t rows, size_t cols, MATHTYPE *out, size_t ldo, MATHTYPE const *a, size_t lda, MATHTYPE scalar);
+void mul_scalar(size_t rows, size_t cols, MATHTYPE *out, size_t ldo, MATHTYPE const *a, size_t lda, MATHTYPE scalar);
+void div_scalar(size_t rows, size_t cols, MATHTYPE *out, size_t ldo, MATHTYPE const *a, size_t lda, MATHTYPE scalar);
+
+// out (cols x rows) = transpose of in (rows x cols), blocked so neither side is walked a whole column at a time.
+// out must not overlap in.
+void transpose(size_t rows, size_t cols, MATHTYPE *out, size_t ldo, MATHTYPE const *in, size_t ldi);
+// Transposes the n x n block at data in place, by swapping mirrored blocks
+void transpose_square(size_t n, MATHTYPE *data, size_t ld);
+
+// Batched matrix * vector over `count` packed vectors (xyz or xyzw back to back). out may alias in.
+// transform3: 3x3 m on xyz, transform4: 4x4 m on xyzw
+void transform3(MATHTYPE const *m, MATHTYPE const *in, MATHTYPE *out, size_t count);
+void transform4(MATHTYPE const *m, MATHTYPE const *in, MATHTYPE *out, size_t count);
+// 4x4 m on xyz with an implicit w = 1. affine ignores the last row of m, projective divides by the resulting w
+void transform_affine3(MATHTYPE const *m, MATHTYPE const *in, MATHTYPE *out, size_t count);
+void transform_projective3(MATHTYPE const *m, MATHTYPE const *in, MATHTYPE *out, size_t count);
+
+// Batched quaternion interpolation over `count` packed rijk quaternions, by t[i] from from[i] to to[i],
+// along the shortest arc. out may alias from or to.
+// nlerp: normalized lerp. slerp_fast: polynomial slerp, max error about 2.6e-5 for unit inputs.
+void nlerp(MATHTYPE const *from, MATHTYPE const *to, MATHTYPE const *t, MATHTYPE *out, size_t count);
+void slerp_fast(MATHTYPE const *from, MATHTYPE const *to, MATHTYPE const *t, MATHTYPE *out, size_t count);
+// The slerp_fast weight of the quaternion at the far end, sin(t * theta) / sin(theta), with cosine = cos(theta) in [0, 1]
+MATHTYPE slerp_weight(MATHTYPE t, MATHTYPE cosine);
+
+// Row helpers for the packed, sparse and QR code, inline so they vectorize into their callers' loops.
+// Multiply-adds below which a second thread costs more than it saves, for splitting their work
+constexpr size_t PARALLEL_WORK = size_t(1) << 15;
+
+// out row += value * in row, COLS cells or cols when COLS is 0
+template <size_t COLS = 0>
+inline void axpy_row(MATHTYPE *out, MATHTYPE value, MATHTYPE const *in, size_t cols)
+{
+	size_t const n = COLS ? COLS : cols;
+	for (size_t c = 0; c < n; ++c)
+		out[c] += value * in[c];
+}
+// row *= value
+inline void scale_row(MATHTYPE *row, MATHTYPE value, size_t cols)
+{
+	for (size_t c = 0; c < cols; ++c)
+		row[c] *= value;
+}
+// sum of a[i] * b[i] over n cells, in 8 partial sums the compiler can keep in one vector register
+inline MATHTYPE dot(MATHTYPE const *a, MATHTYPE const *b, size_t n)
+{
+	MATHTYPE sums[8] = {};
+	size_t i = 0;
+	for (; i + 8 <= n; i += 8)
+		for (size_t lane = 0; lane < 8; ++lane)
+			sums[lane] += a[i + lane] * b[i + lane];
+	MATHTYPE ret = 0;
+	for (; i < n; ++i)
+		ret += a[i] * b[i];
+	for (MATHTYPE sum : sums)
+		ret += sum;
+	return ret;
+}
+
+// Whether a and b share any memory. std::less, since < between pointers into unrelated arrays is unspecified
+template <typename A, typename B>
+bool overlaps(std::span<A> a, std::span<B> b)
+{
+	std::less<void const *> less;
+	return less(a.data(), b.data() + b.size()) && less(b.data(), a.data() + a.size());
+}
+}
+
+#endif
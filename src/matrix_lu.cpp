@@ -0,0 +1,124 @@
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include <cmath>
+#include <stdexcept>
+#include <utility>
+
+namespace ZMathLib_Graphics {
+LUDecomposition Matrix::lu() const
+{
+	if (width != height)
+		throw std::invalid_argument("LU decomposition requires square matrix");
+	unsigned int n = width;
+	LUDecomposition ret{ Matrix(*this), std::vector<unsigned int>(n), 1, false };
+	MATHTYPE *a = ret.lu._array;
+	size_t const s = ret.lu._stride;
+	for (unsigned int i = 0; i < n; ++i)
+		ret.pivots[i] = i;
+	for (unsigned int k = 0; k < n; ++k) {
+		// partial pivoting: bring the largest remaining entry of column k onto the diagonal
+		unsigned int pivot = k;
+		MATHTYPE pivotMagnitude = std::fabs(a[k * s + k]);
+		for (unsigned int y = k + 1; y < n; ++y) {
+			if (std::fabs(a[y * s + k]) > pivotMagnitude) {
+				pivot = y;
+				pivotMagnitude = std::fabs(a[y * s + k]);
+			}
+		}
+		if (pivotMagnitude == 0) {
+			ret.singular = true;
+			continue;
+		}
+		if (pivot != k) {
+			for (unsigned int x = 0; x < n; ++x)
+				std::swap(a[k * s + x], a[pivot * s + x]);
+			std::swap(ret.pivots[k], ret.pivots[pivot]);
+			ret.sign = -ret.sign;
+		}
+		// eliminate below the pivot, row by row so the inner loop is contiguous
+		MATHTYPE const *pivotRow = a + k * s;
+		MATHTYPE inversePivot = 1 / pivotRow[k];
+		for (unsigned int y = k + 1; y < n; ++y) {
+			MATHTYPE *row = a + y * s;
+			MATHTYPE factor = row[k] * inversePivot;
+			row[k] = factor;
+			if (factor == 0)
+				continue;
+			for (unsigned int x = k + 1; x < n; ++x)
+				row[x] -= factor * pivotRow[x];
+		}
+	}
+	return ret;
+}
+
+MATHTYPE LUDecomposition::determinant() const
+{
+	if (singular)
+		return 0;
+	MATHTYPE ret = sign;
+	MATHTYPE const *a = lu.data();
+	for (unsigned int i = 0; i < lu.width; ++i)
+		ret *= a[i * lu.stride() + i];
+	return ret;
+}
+
+Matrix LUDecomposition::solve(Matrix const &b) const
+{
+	unsigned int n = lu.width;
+	if (b.height != n)
+		throw std::invalid_argument("LUDecomposition::solve requires B.height == A.height");
+	if (singular)
+		throw std::invalid_argument("LUDecomposition::solve requires a non-singular matrix");
+	unsigned int columns = b.width;
+	MATHTYPE const *a = lu.data();
+	size_t const s = lu.stride();
+	MATHTYPE const *src = b.data();
+	size_t const srcStride = b.stride();
+	Matrix ret(columns, n);
+	MATHTYPE *x = ret.data();
+	// every right-hand side is solved at once, one row operation at a time
+	for (unsigned int y = 0; y < n; ++y)
+		for (unsigned int c = 0; c < columns; ++c)
+			x[y * columns + c] = src[pivots[y] * srcStride + c];
+	// L y = Pb
+	for (unsigned int y = 1; y < n; ++y) {
+		MATHTYPE *row = x + y * columns;
+		for (unsigned int k = 0; k < y; ++k) {
+			MATHTYPE factor = a[y * s + k];
+			if (factor == 0)
+				continue;
+			MATHTYPE const *solved = x + k * columns;
+			for (unsigned int c = 0; c < columns; ++c)
+				row[c] -= factor * solved[c];
+		}
+	}
+	// U x = y
+	for (unsigned int y = n; y-- > 0;) {
+		MATHTYPE *row = x + y * columns;
+		for (unsigned int k = y + 1; k < n; ++k) {
+			MATHTYPE factor = a[y * s + k];
+			if (factor == 0)
+				continue;
+			MATHTYPE const *solved = x + k * columns;
+			for (unsigned int c = 0; c < columns; ++c)
+				row[c] -= factor * solved[c];
+		}
+		MATHTYPE inverseDiagonal = 1 / a[y * s + y];
+		for (unsigned int c = 0; c < columns; ++c)
+			row[c] *= inverseDiagonal;
+	}
+	return ret;
+}
+
+Matrix LUDecomposition::inverse() const
+{
+	return solve(Matrix::Identity(lu.width));
+}
+
+Matrix Matrix::solve(Matrix const &a, Matrix const &b)
+{
+	if (a.height != b.height)
+		throw std::invalid_argument("Matrix::solve(A, B) requires A.height == B.height");
+	return a.lu().solve(b);
+}
+}
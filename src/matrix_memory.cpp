@@ -0,0 +1,135 @@
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include "matrix_memory.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory_resource>
+
+namespace ZMathLib_Graphics {
+namespace {
+// one thread_local so each call looks up the thread's block once
+struct ThreadState {
+	std::pmr::memory_resource *resource = nullptr;
+	AllocationStats stats;
+};
+thread_local ThreadState state;
+
+constexpr size_t CELL_ALIGNMENT = alignof(std::max_align_t);
+
+// offset of the first address at or after data + offset that is a multiple of alignment
+size_t aligned_offset(std::byte const *data, size_t offset, size_t alignment)
+{
+	uintptr_t address = reinterpret_cast<uintptr_t>(data) + offset;
+	return offset + ((alignment - address % alignment) % alignment);
+}
+}
+
+AllocationStats allocation_stats()
+{
+	return state.stats;
+}
+void reset_allocation_stats()
+{
+	AllocationStats &stats = state.stats;
+	size_t live = stats.live_bytes;
+	stats = AllocationStats();
+	stats.live_bytes = live;
+	stats.peak_live_bytes = live;
+}
+
+std::pmr::memory_resource *matrix_resource()
+{
+	std::pmr::memory_resource *resource = state.resource;
+	return resource ? resource : std::pmr::get_default_resource();
+}
+
+ScopedMatrixResource::ScopedMatrixResource(std::pmr::memory_resource *resource) : _previous(state.resource)
+{
+	state.resource = resource;
+}
+ScopedMatrixResource::~ScopedMatrixResource()
+{
+	state.resource = _previous;
+}
+
+MATHTYPE *Matrix::allocate_cells(size_t count, size_t rowAlignment) const
+{
+	size_t bytes = count * sizeof(MATHTYPE);
+	MATHTYPE *cells = static_cast<MATHTYPE *>(_resource->allocate(bytes, std::max(CELL_ALIGNMENT, rowAlignment)));
+	AllocationStats &stats = state.stats;
+	++stats.allocations;
+	stats.bytes += bytes;
+	stats.live_bytes += bytes;
+	stats.peak_live_bytes = std::max(stats.peak_live_bytes, stats.live_bytes);
+	return cells;
+}
+void Matrix::release_cells()
+{
+	if (_array == nullptr)
+		return;
+	size_t bytes = height * _stride * sizeof(MATHTYPE);
+	_resource->deallocate(_array, bytes, std::max(CELL_ALIGNMENT, _rowAlignment));
+	_array = nullptr;
+	AllocationStats &stats = state.stats;
+	++stats.deallocations;
+	// a buffer allocated on another thread can be released on this one
+	stats.live_bytes -= std::min(stats.live_bytes, bytes);
+}
+
+ArenaResource::ArenaResource(size_t chunkSize, std::pmr::memory_resource *upstream)
+	: _upstream(upstream), _chunkSize(chunkSize)
+{
+}
+ArenaResource::~ArenaResource()
+{
+	for (Chunk const &chunk : _chunks)
+		_upstream->deallocate(chunk.data, chunk.size, alignof(std::max_align_t));
+}
+void ArenaResource::reset()
+{
+	_current = 0;
+	_offset = 0;
+	_used = 0;
+}
+size_t ArenaResource::used() const
+{
+	return _used;
+}
+size_t ArenaResource::capacity() const
+{
+	size_t ret = 0;
+	for (Chunk const &chunk : _chunks)
+		ret += chunk.size;
+	return ret;
+}
+
+void *ArenaResource::do_allocate(size_t bytes, size_t alignment)
+{
+	// first chunk from the current one with room, chunks kept from previous frames are reused in order
+	for (; _current < _chunks.size(); ++_current, _offset = 0) {
+		Chunk const &chunk = _chunks[_current];
+		size_t start = aligned_offset(chunk.data, _offset, alignment);
+		if (start + bytes <= chunk.size) {
+			_offset = start + bytes;
+			_used += bytes;
+			return chunk.data + start;
+		}
+	}
+	size_t size = std::max(_chunkSize, bytes + alignment);
+	std::byte *data = static_cast<std::byte *>(_upstream->allocate(size, alignof(std::max_align_t)));
+	_chunks.push_back(Chunk{ data, size });
+	_current = _chunks.size() - 1;
+	size_t start = aligned_offset(data, 0, alignment);
+	_offset = start + bytes;
+	_used += bytes;
+	return data + start;
+}
+void ArenaResource::do_deallocate(void *, size_t, size_t)
+{
+}
+bool ArenaResource::do_is_equal(std::pmr::memory_resource const &other) const noexcept
+{
+	return this == &other;
+}
+}
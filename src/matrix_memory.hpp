@@ -0,0 +1,88 @@
+#ifndef MATRIX_MEMORY_HPP
+#define MATRIX_MEMORY_HPP
+
+#include <cstddef>
+#include <memory_resource>
+#include <vector>
+
+// Where Matrix buffers come from. Every Matrix allocates its cells from the calling thread's matrix resource,
+// std::pmr::get_default_resource() (plain operator new) unless a ScopedMatrixResource overrides it, and gives
+// them back to the resource they came from. Any std::pmr::memory_resource works, e.g.
+//
+//	ArenaResource frameArena;                          // bump allocator, everything released by reset()
+//	std::pmr::unsynchronized_pool_resource smallPool;  // size classes, suits many small matrices
+//
+//	{
+//		ScopedMatrixResource scope(&frameArena);
+//		Matrix mvp = projection * view * model;        // temporaries and result come from the arena
+//		...
+//	}
+//	frameArena.reset();
+//
+// Copies are allocated from the current resource. A move takes the buffer along with its resource, except
+// move assignment into a matrix from another resource, which copies the cells instead, so a long-lived matrix
+// never ends up pointing into an arena.
+
+namespace ZMathLib_Graphics {
+// Matrix buffer allocations made by the calling thread, whatever resource they came from
+struct AllocationStats {
+	unsigned long allocations = 0;
+	unsigned long deallocations = 0;
+	// total allocated since the last reset
+	size_t bytes = 0;
+	// currently allocated, and the most that was at once
+	size_t live_bytes = 0;
+	size_t peak_live_bytes = 0;
+};
+AllocationStats allocation_stats();
+// Zeroes the counters, live_bytes is kept so it stays accurate, peak_live_bytes restarts from it
+void reset_allocation_stats();
+
+// The calling thread's resource for new Matrix buffers
+std::pmr::memory_resource *matrix_resource();
+
+// Makes `resource` the calling thread's matrix resource until destroyed, scopes nest.
+// The resource has to outlive every Matrix allocated from it.
+struct ScopedMatrixResource {
+	explicit ScopedMatrixResource(std::pmr::memory_resource *resource);
+	~ScopedMatrixResource();
+	ScopedMatrixResource(ScopedMatrixResource const &) = delete;
+	ScopedMatrixResource &operator=(ScopedMatrixResource const &) = delete;
+private:
+	std::pmr::memory_resource *_previous;
+};
+
+// Bump allocator for a frame's worth of temporaries. Allocating is a pointer bump, deallocating does nothing,
+// and reset() releases everything at once while keeping the chunks for the next frame.
+// Not thread-safe, give each thread its own arena.
+struct ArenaResource : std::pmr::memory_resource {
+	explicit ArenaResource(size_t chunkSize = size_t(1) << 20,
+		std::pmr::memory_resource *upstream = std::pmr::get_default_resource());
+	~ArenaResource();
+	ArenaResource(ArenaResource const &) = delete;
+	ArenaResource &operator=(ArenaResource const &) = delete;
+
+	// Invalidates every allocation, matrices from this arena must not be used afterwards (destroying them is fine)
+	void reset();
+	// bytes handed out since the last reset, and bytes held from upstream
+	size_t used() const;
+	size_t capacity() const;
+private:
+	struct Chunk {
+		std::byte *data;
+		size_t size;
+	};
+	std::pmr::memory_resource *_upstream;
+	size_t _chunkSize;
+	std::vector<Chunk> _chunks;
+	size_t _current = 0;
+	size_t _offset = 0;
+	size_t _used = 0;
+
+	void *do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void *ptr, size_t bytes, size_t alignment) override;
+	bool do_is_equal(std::pmr::memory_resource const &other) const noexcept override;
+};
+}
+
+#endif
@@ -1,6 +1,7 @@
 #include "mathtype.hpp"
 #include "matrix.hpp"
 #include <stdexcept>
+#include <utility>
 
 namespace ZMathLib_Graphics {
 // Maps each row to a new row, through func()
@@ -12,7 +13,7 @@ void Matrix::map_rows(Matrix (*func)(unsigned int yRow, Matrix row))
 		if (transformed.height != 1)
 			throw std::invalid_argument("Matrix.map_rows function returned non-row Matrix");
 		for (unsigned int columnIdx = 0; columnIdx < width; ++columnIdx)
-			_array[rowIdx * width + columnIdx] = transformed._array[columnIdx];
+			_array[rowIdx * _stride + columnIdx] = transformed._array[columnIdx];
 	}
 }
 // Maps each column to a new column, through func()
@@ -24,7 +25,7 @@ void Matrix::map_columns(Matrix (*func)(unsigned int xColumn, Matrix column))
 		if (transformed.width != 1)
 			throw std::invalid_argument("Matrix.map_columns function returned non-column Matrix");
 		for (unsigned int rowIdx = 0; rowIdx < height; ++rowIdx)
-			_array[rowIdx * width + columnIdx] = transformed._array[rowIdx];
+			_array[rowIdx * _stride + columnIdx] = transformed._array[rowIdx * transformed._stride];
 	}
 }
 // Maps each cell to a new cell, through func()
@@ -32,74 +33,97 @@ void Matrix::map_cells(MATHTYPE (*func)(unsigned int xColumn, unsigned int yRow,
 {
 	for (unsigned int rowIdx = 0; rowIdx < height; ++rowIdx) {
 		for (unsigned int columnIdx = 0; columnIdx < width; ++columnIdx) {
-			MATHTYPE &cell = _array[rowIdx * width + columnIdx];
+			MATHTYPE &cell = _array[rowIdx * _stride + columnIdx];
 			cell = func(columnIdx, rowIdx, cell);
 		}
 	}
 }
 
 // Maps each row to a new row, through func(), returns a new Matrix
-Matrix Matrix::mapped_rows(Matrix (*func)(unsigned int yRow, Matrix row)) const
+Matrix Matrix::mapped_rows(Matrix (*func)(unsigned int yRow, Matrix row)) const &
 {
 	Matrix ret(*this);
 	ret.map_rows(func);
 	return ret;
 }
+Matrix Matrix::mapped_rows(Matrix (*func)(unsigned int yRow, Matrix row)) &&
+{
+	map_rows(func);
+	return std::move(*this);
+}
 
 // Maps each column to a new column, through func(), returns a new Matrix
-Matrix Matrix::mapped_columns(Matrix (*func)(unsigned int xColumn, Matrix column)) const
+Matrix Matrix::mapped_columns(Matrix (*func)(unsigned int xColumn, Matrix column)) const &
 {
 	Matrix ret(*this);
 	ret.map_columns(func);
 	return ret;
 }
+Matrix Matrix::mapped_columns(Matrix (*func)(unsigned int xColumn, Matrix column)) &&
+{
+	map_columns(func);
+	return std::move(*this);
+}
 // Maps each column to a new column, through func(), returns a new Matrix
-Matrix Matrix::mapped_cells(MATHTYPE (*func)(unsigned int xColumn, unsigned int yRow, MATHTYPE cell)) const
+Matrix Matrix::mapped_cells(MATHTYPE (*func)(unsigned int xColumn, unsigned int yRow, MATHTYPE cell)) const &
 {
 	Matrix ret(*this);
 	ret.map_cells(func);
 	return ret;
 }
+Matrix Matrix::mapped_cells(MATHTYPE (*func)(unsigned int xColumn, unsigned int yRow, MATHTYPE cell)) &&
+{
+	map_cells(func);
+	return std::move(*this);
+}
 
 
 // Takes in a matrix dimensions CxR and produces a matrix 1xR, applying func() on each row of the matrix.
 void Matrix::reduce_rows(MATHTYPE (*func)(unsigned int yRow, Matrix row))
 {
-	MATHTYPE *newArray = new MATHTYPE[1 * height];
+	// a padded column of single cells would be mostly padding, reductions are unpadded
+	MATHTYPE *newArray = allocate_cells(1 * height, 0);
 	for (unsigned int rowIdx = 0; rowIdx < height; ++rowIdx) {
 		Matrix row = get_row(rowIdx);
 		MATHTYPE value = func(rowIdx, row);
 		newArray[rowIdx] = value;
 	}
-	delete [] _array;
+	release_cells();
 	_array = newArray;
 	width = 1;
+	_stride = 1;
+	_rowAlignment = 0;
 }
 // Takes in a matrix dimensions CxR and produces a matrix Cx1, applying func() on each column of the matrix.
 void Matrix::reduce_columns(MATHTYPE (*func)(unsigned int xColumn, Matrix column))
 {
-	MATHTYPE *newArray = new MATHTYPE[width * 1];
+	MATHTYPE *newArray = allocate_cells(width * 1, 0);
 	for (unsigned int columnIdx = 0; columnIdx < width; ++columnIdx) {
 		Matrix column = get_column(columnIdx);
 		MATHTYPE value = func(columnIdx, column);
 		newArray[columnIdx] = value;
 	}
-	delete [] _array;
+	release_cells();
 	_array = newArray;
 	height = 1;
+	_stride = width;
+	_rowAlignment = 0;
 }
 // Takes in a matrix dimensions CxR and produces a matrix 1xR, applying func() on each row of the matrix. Returns a new Matrix.
 Matrix Matrix::reduced_rows(MATHTYPE (*func)(unsigned int yRow, Matrix row)) const
 {
-	Matrix ret(*this);
-	ret.reduce_rows(func);
+	// build the 1xR result directly rather than copying the whole matrix first
+	Matrix ret(1, height);
+	for (unsigned int rowIdx = 0; rowIdx < height; ++rowIdx)
+		ret._array[rowIdx] = func(rowIdx, get_row(rowIdx));
 	return ret;
 }
 // Takes in a matrix dimensions CxR and produces a matrix Cx1, applying func() on each column of the matrix. Returns a new Matrix.
 Matrix Matrix::reduced_columns(MATHTYPE (*func)(unsigned int xColumn, Matrix column)) const
 {
-	Matrix ret(*this);
-	ret.reduce_columns(func);
+	Matrix ret(width, 1);
+	for (unsigned int columnIdx = 0; columnIdx < width; ++columnIdx)
+		ret._array[columnIdx] = func(columnIdx, get_column(columnIdx));
 	return ret;
 }
 }
@@ -0,0 +1,297 @@
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include "matrix_kernels.hpp"
+#include "vector.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+// Householder QR, blocked: PANEL columns at a time are factored one reflector after another, then the
+// panel's reflectors, gathered as I - V T V^T (the compact WY form), update the columns right of the panel
+// with two gemm calls instead of PANEL passes over them. Row-major columns are strided, so each panel is
+// factored transposed, every reflector and every column it updates being a contiguous row.
+//
+// Least squares factors A with B's columns appended, which the reflectors update like any other column, so
+// Q^T B comes out of the factorization: by the gemm calls when A is wider than a panel, and within the
+// transposed panel otherwise. Tall-skinny A (Nx3, Nx4) is then a single pass of contiguous dot products
+// with one square root per column, rather than a rotation (and a square root) per cell.
+
+namespace ZMathLib_Graphics {
+namespace {
+// Columns per panel. Below this width the whole matrix is one panel and the gemm update never runs.
+constexpr size_t PANEL = 32;
+
+// Buffers reused by every factorization and least squares solve on a thread. They only grow, so fitting
+// problems of the same size again allocates nothing.
+struct Workspace {
+	// the transposed panel, V and V^T W for the trailing update, T
+	std::vector<MATHTYPE> panel, v, w, t;
+	// lstsq: A and B side by side being factored, the taus
+	std::vector<MATHTYPE> a, tau;
+};
+thread_local Workspace threadWorkspace;
+
+// The thread's workspace, taken out for one call and handed back when it returns or throws. Transposes and
+// products in between run parallel_for, so a solve started on this thread before then (from a range the
+// caller's own parallel_for runs here) gets empty buffers, not the ones this call still points into.
+struct ScopedWorkspace : Workspace {
+	ScopedWorkspace() : Workspace(std::exchange(threadWorkspace, {})) {}
+	~ScopedWorkspace() { threadWorkspace = std::move(static_cast<Workspace &>(*this)); }
+	ScopedWorkspace(ScopedWorkspace const &) = delete;
+	ScopedWorkspace &operator=(ScopedWorkspace const &) = delete;
+};
+
+MATHTYPE *reserve(std::vector<MATHTYPE> &buffer, size_t cells)
+{
+	if (buffer.size() < cells)
+		buffer.resize(cells);
+	return buffer.data();
+}
+
+// Turns x (n cells) into the reflector H = I - tau v v^T with H x = (beta, 0, ...): x[0] becomes beta and
+// x[1...] becomes v[1...], v[0] being 1. Returns tau, 0 when x is already (x[0], 0, ...).
+MATHTYPE householder(MATHTYPE *x, size_t n)
+{
+	MATHTYPE sigma = n > 1 ? Kernels::dot(x + 1, x + 1, n - 1) : 0;
+	if (sigma == 0)
+		return 0;
+	MATHTYPE alpha = x[0];
+	// beta takes the sign away from alpha, so alpha - beta never cancels
+	MATHTYPE beta = -std::copysign(std::sqrt(alpha * alpha + sigma), alpha);
+	Kernels::scale_row(x + 1, 1 / (alpha - beta), n - 1);
+	x[0] = beta;
+	return (beta - alpha) / beta;
+}
+
+// QR of a panel held transposed: nb rows of `rows` cells, row j being column j of the panel. The rows up
+// to `cols` after those are columns only updated by the reflectors.
+void factor_panel(size_t nb, size_t cols, size_t rows, MATHTYPE *panel, MATHTYPE *tau)
+{
+	for (size_t j = 0; j < nb; ++j) {
+		MATHTYPE *v = panel + j * rows + j;
+		size_t length = rows - j;
+		tau[j] = householder(v, length);
+		if (tau[j] == 0)
+			continue;
+		for (size_t i = j + 1; i < cols; ++i) {
+			MATHTYPE *column = panel + i * rows + j;
+			MATHTYPE w = tau[j] * (column[0] + Kernels::dot(v + 1, column + 1, length - 1));
+			column[0] -= w;
+			Kernels::axpy_row(column + 1, -w, v + 1, length - 1);
+		}
+	}
+}
+
+// The first n columns of a (m x n + extra, m >= n) = their QR, with R on and above the diagonal and the
+// reflectors below it. The extra columns = Q^T times them.
+void factor(size_t m, size_t n, size_t extra, MATHTYPE *a, size_t lda, MATHTYPE *tau, Workspace &ws)
+{
+	for (size_t k = 0; k < n; k += PANEL) {
+		size_t nb = std::min(PANEL, n - k), rows = m - k, trailing = n + extra - k - nb;
+		// the last panel updates what is left to its right itself
+		size_t cols = k + nb == n ? nb + extra : nb;
+		MATHTYPE *corner = a + k * lda + k;
+		MATHTYPE *panel = reserve(ws.panel, cols * rows);
+		Kernels::transpose(rows, cols, panel, rows, corner, lda);
+		factor_panel(nb, cols, rows, panel, tau + k);
+		Kernels::transpose(cols, rows, corner, lda, panel, rows);
+		// nothing right of the panel, or the panel updated it already
+		if (cols > nb || trailing == 0)
+			continue;
+
+		// the panel becomes V^T, each reflector with its leading 1 and the zeros before it
+		for (size_t j = 0; j < nb; ++j) {
+			std::fill_n(panel + j * rows, j, MATHTYPE(0));
+			panel[j * rows + j] = 1;
+		}
+		// T, upper triangular with H_k ... H_k+nb-1 = I - V T V^T, a column at a time:
+		// T[0:j, j] = -tau_j T[0:j, 0:j] V[:, 0:j]^T v_j
+		MATHTYPE *t = reserve(ws.t, nb * nb);
+		for (size_t j = 0; j < nb; ++j) {
+			MATHTYPE const *vj = panel + j * rows;
+			t[j * nb + j] = tau[k + j];
+			for (size_t i = 0; i < j; ++i)
+				t[i * nb + j] = -tau[k + j] * Kernels::dot(panel + i * rows + j, vj + j, rows - j);
+			// top down, row i only reads the rows below it, not yet overwritten
+			for (size_t i = 0; i < j; ++i) {
+				MATHTYPE sum = 0;
+				for (size_t l = i; l < j; ++l)
+					sum += t[i * nb + l] * t[l * nb + j];
+				t[i * nb + j] = sum;
+			}
+		}
+		// trailing columns C = Q^T C = C - V T^T V^T C
+		MATHTYPE *c = corner + nb;
+		MATHTYPE *w = reserve(ws.w, nb * trailing);
+		Kernels::gemm(nb, trailing, rows, 1, panel, rows, c, lda, 0, w, trailing);
+		// W = T^T W in place, bottom up, row i only reads the rows above it
+		for (size_t i = nb; i-- > 0;) {
+			MATHTYPE *row = w + i * trailing;
+			Kernels::scale_row(row, t[i * nb + i], trailing);
+			for (size_t l = 0; l < i; ++l)
+				Kernels::axpy_row(row, t[l * nb + i], w + l * trailing, trailing);
+		}
+		MATHTYPE *v = reserve(ws.v, rows * nb);
+		Kernels::transpose(nb, rows, v, nb, panel, rows);
+		Kernels::gemm(rows, trailing, nb, -1, v, nb, w, trailing, 1, c, lda);
+	}
+}
+
+// b rows k... (p cells each) = H_k b, with v_k below the diagonal of column k of a
+void apply_reflector(size_t m, MATHTYPE const *a, size_t lda, size_t k, MATHTYPE tau, MATHTYPE *b, size_t ldb, size_t p,
+	Workspace &ws)
+{
+	if (tau == 0)
+		return;
+	MATHTYPE *w = reserve(ws.w, p);
+	std::copy_n(b + k * ldb, p, w);
+	for (size_t i = k + 1; i < m; ++i)
+		Kernels::axpy_row(w, a[i * lda + k], b + i * ldb, p);
+	Kernels::scale_row(w, tau, p);
+	Kernels::axpy_row(b + k * ldb, -1, w, p);
+	for (size_t i = k + 1; i < m; ++i)
+		Kernels::axpy_row(b + i * ldb, -a[i * lda + k], w, p);
+}
+
+// b (n x p) = R^-1 b, R the upper triangle of a
+void solve_r(size_t n, MATHTYPE const *a, size_t lda, MATHTYPE *b, size_t ldb, size_t p)
+{
+	for (size_t i = 0; i < n; ++i)
+		if (a[i * lda + i] == 0)
+			throw std::invalid_argument("Least squares requires A of full column rank");
+	for (size_t y = n; y-- > 0;) {
+		MATHTYPE *row = b + y * ldb;
+		for (size_t k = y + 1; k < n; ++k)
+			Kernels::axpy_row(row, -a[y * lda + k], b + k * ldb, p);
+		Kernels::scale_row(row, 1 / a[y * lda + y], p);
+	}
+}
+
+// x (n x p) = the X minimizing |A X - B|, A and B (m x n and m x p, m >= n) filled in side by side in
+// ws.a, m x (n + p)
+void least_squares(size_t m, size_t n, size_t p, MATHTYPE *x, size_t ldx, Workspace &ws)
+{
+	MATHTYPE *a = ws.a.data(), *tau = reserve(ws.tau, n);
+	size_t lda = n + p;
+	factor(m, n, p, a, lda, tau, ws);
+	solve_r(n, a, lda, a + n, lda, p);
+	for (size_t y = 0; y < n; ++y)
+		std::copy_n(a + y * lda + n, p, x + y * ldx);
+}
+
+void check_least_squares(unsigned int width, unsigned int height)
+{
+	if (height < width)
+		throw std::invalid_argument("Least squares requires A at least as tall as it is wide");
+}
+}
+
+QRDecomposition Matrix::qr() const
+{
+	check_least_squares(width, height);
+	QRDecomposition ret{ Matrix(*this), std::vector<MATHTYPE>(width) };
+	ScopedWorkspace ws;
+	factor(height, width, 0, ret.qr.data(), ret.qr.stride(), ret.tau.data(), ws);
+	return ret;
+}
+
+Matrix QRDecomposition::q() const
+{
+	size_t m = qr.height, n = qr.width;
+	Matrix ret(n, m);
+	for (unsigned int i = 0; i < n; ++i)
+		ret(i, i) = 1;
+	// Q = H_0 ... H_n-1 applied to the first n columns of I, last reflector first
+	ScopedWorkspace ws;
+	for (size_t k = n; k-- > 0;)
+		apply_reflector(m, qr.data(), qr.stride(), k, tau[k], ret.data(), ret.stride(), n, ws);
+	return ret;
+}
+Matrix QRDecomposition::r() const
+{
+	Matrix ret(qr.width, qr.width);
+	for (unsigned int y = 0; y < qr.width; ++y)
+		for (unsigned int x = y; x < qr.width; ++x)
+			ret(x, y) = qr(x, y);
+	return ret;
+}
+Matrix QRDecomposition::solve(Matrix const &b) const
+{
+	size_t m = qr.height, n = qr.width, p = b.width;
+	if (b.height != m)
+		throw std::invalid_argument("QRDecomposition::solve requires B.height == A.height");
+	Matrix rhs(b);
+	ScopedWorkspace ws;
+	for (size_t k = 0; k < n; ++k)
+		apply_reflector(m, qr.data(), qr.stride(), k, tau[k], rhs.data(), rhs.stride(), p, ws);
+	solve_r(n, qr.data(), qr.stride(), rhs.data(), rhs.stride(), p);
+	Matrix ret(b.width, qr.width);
+	for (unsigned int y = 0; y < n; ++y)
+		std::copy_n(rhs.data() + y * rhs.stride(), p, ret.data() + y * ret.stride());
+	return ret;
+}
+
+void Matrix::lstsq(MatrixConstView a, MatrixConstView b, MatrixView x)
+{
+	check_least_squares(a.width, a.height);
+	if (b.height != a.height)
+		throw std::invalid_argument("Matrix::lstsq requires B.height == A.height");
+	if (x.width != b.width || x.height != a.width)
+		throw std::invalid_argument("Matrix::lstsq requires X to be A.width x B.width");
+	size_t m = a.height, n = a.width, p = b.width;
+	ScopedWorkspace ws;
+	MATHTYPE *cells = reserve(ws.a, m * (n + p));
+	for (size_t y = 0; y < m; ++y) {
+		std::copy_n(a.data + y * a.stride, n, cells + y * (n + p));
+		std::copy_n(b.data + y * b.stride, p, cells + y * (n + p) + n);
+	}
+	least_squares(m, n, p, x.data, x.stride, ws);
+}
+Matrix Matrix::lstsq(Matrix const &a, Matrix const &b)
+{
+	Matrix ret(b.width, a.width);
+	lstsq(a.view(), b.view(), ret.view());
+	return ret;
+}
+Vec3 Matrix::lstsq(std::span<Vec3 const> rows, std::span<MATHTYPE const> b)
+{
+	if (rows.size() != b.size())
+		throw std::invalid_argument("Matrix::lstsq requires as many rows as right-hand sides");
+	check_least_squares(3, (unsigned int) std::min<size_t>(rows.size(), 3));
+	ScopedWorkspace ws;
+	MATHTYPE *cells = reserve(ws.a, rows.size() * 4);
+	for (size_t y = 0; y < rows.size(); ++y) {
+		MATHTYPE *row = cells + y * 4;
+		row[0] = rows[y].x;
+		row[1] = rows[y].y;
+		row[2] = rows[y].z;
+		row[3] = b[y];
+	}
+	MATHTYPE x[3];
+	least_squares(rows.size(), 3, 1, x, 1, ws);
+	return Vec3(x[0], x[1], x[2]);
+}
+Vec4 Matrix::lstsq(std::span<Vec4 const> rows, std::span<MATHTYPE const> b)
+{
+	if (rows.size() != b.size())
+		throw std::invalid_argument("Matrix::lstsq requires as many rows as right-hand sides");
+	check_least_squares(4, (unsigned int) std::min<size_t>(rows.size(), 4));
+	ScopedWorkspace ws;
+	MATHTYPE *cells = reserve(ws.a, rows.size() * 5);
+	for (size_t y = 0; y < rows.size(); ++y) {
+		MATHTYPE *row = cells + y * 5;
+		row[0] = rows[y].x;
+		row[1] = rows[y].y;
+		row[2] = rows[y].z;
+		row[3] = rows[y].w;
+		row[4] = b[y];
+	}
+	MATHTYPE x[4];
+	least_squares(rows.size(), 4, 1, x, 1, ws);
+	return Vec4(x[0], x[1], x[2], x[3]);
+}
+}
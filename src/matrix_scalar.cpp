@@ -1,21 +1,26 @@
 #include "mathtype.hpp"
 #include "matrix.hpp"
+#include "matrix_kernels.hpp"
+#include <utility>
 
-#define MTX_OP(op) Matrix Matrix::operator op(MATHTYPE other) const \
+#define MTX_OP(op, kernel) Matrix Matrix::operator op(MATHTYPE other) const & \
 { \
-	Matrix ret(*this); \
-	for (unsigned int x = 0; x < ret.width; ++x) \
-		for (unsigned int y = 0; y < ret.height; ++y) \
-			ret._array[y * ret.width + x] op##= other; \
+	Matrix ret(width, height, Uninitialized(), _rowAlignment); \
+	Kernels::kernel(height, width, ret._array, ret._stride, _array, _stride, other); \
 	return ret; \
+} \
+Matrix Matrix::operator op(MATHTYPE other) && \
+{ \
+	Kernels::kernel(height, width, _array, _stride, _array, _stride, other); \
+	return std::move(*this); \
 }
 namespace ZMathLib_Graphics {
-MTX_OP(+)
-MTX_OP(-)
-MTX_OP(*)
-MTX_OP(/)
+MTX_OP(+, add_scalar)
+MTX_OP(-, sub_scalar)
+MTX_OP(*, mul_scalar)
+MTX_OP(/, div_scalar)
 }
 ZMathLib_Graphics::Matrix operator*(MATHTYPE other, ZMathLib_Graphics::Matrix mtx)
 {
-	return mtx * other;
+	return std::move(mtx) * other;
 }
@@ -0,0 +1,121 @@
+#include "mathtype.hpp"
+#include "matrix_kernels.hpp"
+#include <algorithm>
+#include <cstddef>
+
+// Strassen-Winograd: a product of 2 x 2 block matrices in 7 block products and 15 block sums instead of
+// 8 products, recursively, so n^2.81 multiply-adds instead of n^3. Blocks below the crossover go to the
+// blocked gemm, which is faster there, sums included.
+//
+// Each level works in C's four quadrants plus two temporaries, X (m/2 x max(k/2, n/2)) for sums of A's blocks
+// and the first product, and Y (k/2 x n/2) for sums of B's blocks, following the schedule of Boyer, Dumas,
+// Pernet and Zhou, "Memory efficient scheduling of Strassen-Winograd's matrix multiplication algorithm"
+// (ISSAC 2009). The levels below take their temporaries from the rest of the same workspace, so the whole
+// product needs the one allocation, about (m * max(k, n) + k * n) / 3 cells.
+//
+// Odd sides are peeled: the even part recurses and the last row, column and rank-1 update go to gemm.
+
+namespace ZMathLib_Graphics::Kernels {
+namespace {
+bool is_leaf(size_t m, size_t n, size_t k, size_t crossover)
+{
+	return std::min({ m, n, k }) <= std::max<size_t>(crossover, 1);
+}
+
+// C (m x n) = A (m x k) * B (k x n) for even m, n and k
+void strassen_even(size_t m, size_t n, size_t k,
+	MATHTYPE const *a, size_t lda,
+	MATHTYPE const *b, size_t ldb,
+	MATHTYPE *c, size_t ldc,
+	size_t crossover, MATHTYPE *workspace);
+
+// C = A * B for any sizes, recursing on the even part
+void multiply(size_t m, size_t n, size_t k,
+	MATHTYPE const *a, size_t lda,
+	MATHTYPE const *b, size_t ldb,
+	MATHTYPE *c, size_t ldc,
+	size_t crossover, MATHTYPE *workspace)
+{
+	if (is_leaf(m, n, k, crossover)) {
+		gemm(m, n, k, 1, a, lda, b, ldb, 0, c, ldc);
+		return;
+	}
+	size_t m0 = m & ~size_t(1), n0 = n & ~size_t(1), k0 = k & ~size_t(1);
+	strassen_even(m0, n0, k0, a, lda, b, ldb, c, ldc, crossover, workspace);
+	if (k0 != k)
+		gemm(m0, n0, 1, 1, a + k0, lda, b + k0 * ldb, ldb, 1, c, ldc);
+	if (n0 != n)
+		gemm(m0, 1, k, 1, a, lda, b + n0, ldb, 0, c + n0, ldc);
+	if (m0 != m)
+		gemm(1, n, k, 1, a + m0 * lda, lda, b, ldb, 0, c + m0 * ldc, ldc);
+}
+
+void strassen_even(size_t m, size_t n, size_t k,
+	MATHTYPE const *a, size_t lda,
+	MATHTYPE const *b, size_t ldb,
+	MATHTYPE *c, size_t ldc,
+	size_t crossover, MATHTYPE *workspace)
+{
+	size_t hm = m / 2, hn = n / 2, hk = k / 2;
+	MATHTYPE const *a11 = a, *a12 = a + hk, *a21 = a + hm * lda, *a22 = a21 + hk;
+	MATHTYPE const *b11 = b, *b12 = b + hn, *b21 = b + hk * ldb, *b22 = b21 + hn;
+	MATHTYPE *c11 = c, *c12 = c + hn, *c21 = c + hm * ldc, *c22 = c21 + hn;
+	size_t ldx = std::max(hk, hn), ldy = hn;
+	MATHTYPE *x = workspace, *y = x + hm * ldx, *rest = y + hk * ldy;
+
+	// S3 = A11 - A21, T3 = B22 - B12, P7 = S3 * T3 in C21
+	sub(hm, hk, x, ldx, a11, lda, a21, lda);
+	sub(hk, hn, y, ldy, b22, ldb, b12, ldb);
+	multiply(hm, hn, hk, x, ldx, y, ldy, c21, ldc, crossover, rest);
+	// S1 = A21 + A22, T1 = B12 - B11, P5 = S1 * T1 in C22
+	add(hm, hk, x, ldx, a21, lda, a22, lda);
+	sub(hk, hn, y, ldy, b12, ldb, b11, ldb);
+	multiply(hm, hn, hk, x, ldx, y, ldy, c22, ldc, crossover, rest);
+	// S2 = S1 - A11, T2 = B22 - T1, P6 = S2 * T2 in C12
+	sub(hm, hk, x, ldx, x, ldx, a11, lda);
+	sub(hk, hn, y, ldy, b22, ldb, y, ldy);
+	multiply(hm, hn, hk, x, ldx, y, ldy, c12, ldc, crossover, rest);
+	// S4 = A12 - S2, P3 = S4 * B22 in C11
+	sub(hm, hk, x, ldx, a12, lda, x, ldx);
+	multiply(hm, hn, hk, x, ldx, b22, ldb, c11, ldc, crossover, rest);
+	// P1 = A11 * B11 in X
+	multiply(hm, hn, hk, a11, lda, b11, ldb, x, ldx, crossover, rest);
+	// U2 = P1 + P6, U3 = U2 + P7, U4 = U2 + P5, U7 = U3 + P5 (C22 done), U5 = U4 + P3 (C12 done)
+	add(hm, hn, c12, ldc, x, ldx, c12, ldc);
+	add(hm, hn, c21, ldc, c12, ldc, c21, ldc);
+	add(hm, hn, c12, ldc, c12, ldc, c22, ldc);
+	add(hm, hn, c22, ldc, c21, ldc, c22, ldc);
+	add(hm, hn, c12, ldc, c12, ldc, c11, ldc);
+	// T4 = T2 - B21, P4 = A22 * T4 in C11, U6 = U3 - P4 (C21 done)
+	sub(hk, hn, y, ldy, y, ldy, b21, ldb);
+	multiply(hm, hn, hk, a22, lda, y, ldy, c11, ldc, crossover, rest);
+	sub(hm, hn, c21, ldc, c21, ldc, c11, ldc);
+	// P2 = A12 * B21 in C11, U1 = P1 + P2 (C11 done)
+	multiply(hm, hn, hk, a12, lda, b21, ldb, c11, ldc, crossover, rest);
+	add(hm, hn, c11, ldc, x, ldx, c11, ldc);
+}
+}
+
+size_t strassen_workspace(size_t m, size_t n, size_t k, size_t crossover)
+{
+	size_t cells = 0;
+	while (!is_leaf(m, n, k, crossover)) {
+		m /= 2;
+		n /= 2;
+		k /= 2;
+		cells += m * std::max(k, n) + k * n;
+	}
+	return cells;
+}
+
+void strassen(size_t m, size_t n, size_t k,
+	MATHTYPE const *a, size_t lda,
+	MATHTYPE const *b, size_t ldb,
+	MATHTYPE *c, size_t ldc,
+	size_t crossover, MATHTYPE *workspace)
+{
+	if (m == 0 || n == 0)
+		return;
+	multiply(m, n, k, a, lda, b, ldb, c, ldc, crossover, workspace);
+}
+}
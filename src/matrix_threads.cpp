@@ -0,0 +1,310 @@
+#include "matrix_threads.hpp"
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Work-stealing pool. Each worker owns a deque of ranges, plus one shared deque for threads outside the pool.
+// A thread running a range longer than the grain splits it in half, pushes the upper half onto its own deque
+// and carries on with the lower, down to the grain. Owners pop the newest (smallest, cache-warm) range from
+// the back, thieves take the oldest (largest) from the front and split it in turn.
+
+namespace ZMathLib_Graphics {
+namespace {
+struct Job {
+	Job(void (*body)(void *, size_t, size_t), void *context, size_t grain) : body(body), context(context), grain(grain) {}
+
+	void (*body)(void *, size_t, size_t);
+	void *context;
+	size_t grain;
+	// items not yet run, the job is done at 0
+	std::atomic<size_t> remaining = 0;
+	std::atomic<bool> failed = false;
+	std::exception_ptr error = nullptr;
+	// The waiting thread sleeps on `changed` until the job is done or one of its ranges is queued, so it can
+	// help with that. done is set under the lock, so once the waiter sees it nobody touches the job again.
+	std::mutex mutex;
+	std::condition_variable changed;
+	bool done = false;
+	size_t queued = 0;
+};
+
+struct Task {
+	Job *job;
+	size_t begin, end;
+};
+
+struct alignas(64) Queue {
+	std::mutex mutex;
+	std::deque<Task> tasks;
+};
+
+struct ThreadPool {
+	explicit ThreadPool(unsigned int threads);
+	~ThreadPool();
+
+	unsigned int threads() const
+	{
+		return _threads;
+	}
+	void run(Job &job, size_t count);
+private:
+	unsigned int _threads;
+	// one per worker, the last is shared by threads outside the pool
+	std::unique_ptr<Queue[]> _queues;
+	std::vector<std::thread> _workers;
+	std::atomic<size_t> _queued = 0;
+	std::mutex _sleepMutex;
+	std::condition_variable _wake;
+	bool _stop = false;
+
+	size_t own_queue() const;
+	void push(size_t queue, Task task);
+	bool try_pop(size_t queue, Task &task);
+	bool try_steal(size_t thief, Task &task);
+	bool try_take(Job const &job, Task &task);
+	bool run_one(size_t queue);
+	void execute(size_t queue, Task task);
+	void work(size_t queue);
+};
+
+// the pool the current thread works for, and its queue there
+thread_local ThreadPool const *workerPool = nullptr;
+thread_local size_t workerQueue = 0;
+
+ThreadPool::ThreadPool(unsigned int threads) : _threads(threads), _queues(new Queue[threads])
+{
+	for (size_t i = 0; i + 1 < threads; ++i)
+		_workers.emplace_back([this, i] { work(i); });
+}
+ThreadPool::~ThreadPool()
+{
+	{
+		std::lock_guard lock(_sleepMutex);
+		_stop = true;
+	}
+	_wake.notify_all();
+	for (std::thread &worker : _workers)
+		worker.join();
+}
+
+size_t ThreadPool::own_queue() const
+{
+	return workerPool == this ? workerQueue : _threads - 1;
+}
+void ThreadPool::push(size_t queue, Task task)
+{
+	{
+		std::lock_guard lock(_queues[queue].mutex);
+		_queues[queue].tasks.push_back(task);
+	}
+	_queued.fetch_add(1);
+	// taking the lock orders this with a worker between checking _queued and going to sleep
+	{
+		std::lock_guard lock(_sleepMutex);
+	}
+	_wake.notify_one();
+}
+bool ThreadPool::try_pop(size_t queue, Task &task)
+{
+	std::lock_guard lock(_queues[queue].mutex);
+	if (_queues[queue].tasks.empty())
+		return false;
+	task = _queues[queue].tasks.back();
+	_queues[queue].tasks.pop_back();
+	_queued.fetch_sub(1);
+	return true;
+}
+bool ThreadPool::try_steal(size_t thief, Task &task)
+{
+	for (size_t i = 1; i < _threads; ++i) {
+		Queue &victim = _queues[(thief + i) % _threads];
+		std::lock_guard lock(victim.mutex);
+		if (victim.tasks.empty())
+			continue;
+		task = victim.tasks.front();
+		victim.tasks.pop_front();
+		_queued.fetch_sub(1);
+		return true;
+	}
+	return false;
+}
+// Any range of job, newest first on each queue. Linear, but queues hold a few ranges per thread.
+bool ThreadPool::try_take(Job const &job, Task &task)
+{
+	for (size_t i = 0; i < _threads; ++i) {
+		Queue &queue = _queues[i];
+		std::lock_guard lock(queue.mutex);
+		auto found = std::find_if(queue.tasks.rbegin(), queue.tasks.rend(), [&](Task const &queued) {
+			return queued.job == &job;
+		});
+		if (found == queue.tasks.rend())
+			continue;
+		task = *found;
+		queue.tasks.erase(std::next(found).base());
+		_queued.fetch_sub(1);
+		return true;
+	}
+	return false;
+}
+bool ThreadPool::run_one(size_t queue)
+{
+	Task task;
+	if (!try_pop(queue, task) && !try_steal(queue, task))
+		return false;
+	execute(queue, task);
+	return true;
+}
+void ThreadPool::execute(size_t queue, Task task)
+{
+	Job &job = *task.job;
+	while (task.end - task.begin > job.grain) {
+		size_t middle = task.begin + (task.end - task.begin) / 2;
+		push(queue, Task{ &job, middle, task.end });
+		task.end = middle;
+		{
+			std::lock_guard lock(job.mutex);
+			++job.queued;
+		}
+		job.changed.notify_one();
+	}
+	// once a range has thrown, the rest are skipped but still counted off
+	if (!job.failed.load(std::memory_order_relaxed)) {
+		try {
+			job.body(job.context, task.begin, task.end);
+		} catch (...) {
+			if (!job.failed.exchange(true))
+				job.error = std::current_exception();
+		}
+	}
+	size_t const items = task.end - task.begin;
+	if (job.remaining.fetch_sub(items, std::memory_order_acq_rel) == items) {
+		std::lock_guard lock(job.mutex);
+		job.done = true;
+		job.changed.notify_one();
+	}
+}
+void ThreadPool::work(size_t queue)
+{
+	workerPool = this;
+	workerQueue = queue;
+	for (;;) {
+		if (run_one(queue))
+			continue;
+		std::unique_lock lock(_sleepMutex);
+		_wake.wait(lock, [this] { return _stop || _queued.load() > 0; });
+		if (_stop)
+			return;
+	}
+}
+
+void ThreadPool::run(Job &job, size_t count)
+{
+	size_t queue = own_queue();
+	job.remaining.store(count);
+	execute(queue, Task{ &job, 0, count });
+	// Help with this job's own ranges until the last is done, never another job's: a range of unrelated work
+	// run here would see this thread's state (its matrix resource, workspaces the caller holds across this
+	// call) in the middle of the caller using it. With none left to take, sleep until another is queued or
+	// the ranges other threads took are done.
+	Task task;
+	size_t seen = 0;
+	for (;;) {
+		if (try_take(job, task)) {
+			execute(queue, task);
+			continue;
+		}
+		std::unique_lock lock(job.mutex);
+		job.changed.wait(lock, [&] { return job.done || job.queued != seen; });
+		if (job.done)
+			return;
+		seen = job.queued;
+	}
+}
+
+// Read once, hardware_concurrency() isn't cheap enough to ask on every operation
+unsigned int default_thread_count()
+{
+	static unsigned int const ret = [] {
+		if (char const *env = std::getenv("ZMATH_THREADS")) {
+			int threads = std::atoi(env);
+			if (threads > 0)
+				return (unsigned int) threads;
+		}
+		return std::max(1u, std::thread::hardware_concurrency());
+	}();
+	return ret;
+}
+
+std::mutex poolMutex;
+std::atomic<ThreadPool *> currentPool = nullptr;
+// written under poolMutex, read without it by planned_threads()
+std::atomic<unsigned int> requestedThreads = 0;
+
+ThreadPool &pool()
+{
+	ThreadPool *ret = currentPool.load(std::memory_order_acquire);
+	if (ret != nullptr)
+		return *ret;
+	std::lock_guard lock(poolMutex);
+	ret = currentPool.load(std::memory_order_relaxed);
+	if (ret == nullptr) {
+		unsigned int requested = requestedThreads.load(std::memory_order_relaxed);
+		ret = new ThreadPool(requested ? requested : default_thread_count());
+		currentPool.store(ret, std::memory_order_release);
+	}
+	return *ret;
+}
+// Threads of the pool, or of the one the next operation would start, without starting it
+unsigned int planned_threads()
+{
+	if (ThreadPool *current = currentPool.load(std::memory_order_acquire))
+		return current->threads();
+	unsigned int requested = requestedThreads.load(std::memory_order_relaxed);
+	return requested ? requested : default_thread_count();
+}
+}
+
+void set_thread_count(unsigned int count)
+{
+	std::lock_guard lock(poolMutex);
+	requestedThreads.store(count, std::memory_order_relaxed);
+	// joins the old workers, the next operation starts a pool of the new size
+	delete currentPool.exchange(nullptr);
+}
+unsigned int thread_count()
+{
+	return planned_threads();
+}
+
+void parallel_for(size_t count, size_t grain, void (*body)(void *, size_t, size_t), void *context)
+{
+	if (count == 0)
+		return;
+	// work that won't be split runs here without looking at the pool
+	grain = std::max(grain, size_t(1));
+	if (count <= grain) {
+		body(context, 0, count);
+		return;
+	}
+	unsigned int const threads = planned_threads();
+	// a few ranges per thread leaves room to balance uneven ones without splitting any finer than that
+	grain = std::max(grain, count / (threads * 4));
+	if (threads == 1 || count <= grain) {
+		body(context, 0, count);
+		return;
+	}
+	Job job(body, context, grain);
+	pool().run(job, count);
+	if (job.error)
+		std::rethrow_exception(job.error);
+}
+}
@@ -0,0 +1,42 @@
+#ifndef MATRIX_THREADS_HPP
+#define MATRIX_THREADS_HPP
+
+#include <cstddef>
+#include <type_traits>
+
+// Threads behind the large Matrix operations. Multiplies, elementwise and scalar operators, transposes and
+// map_cells_parallel() split their work into ranges of rows or tiles that a shared work-stealing pool runs
+// across cores. The calling thread takes part and returns once every range is done, so results are ready
+// exactly as with the single-threaded code. Work too small to be worth waking a thread for runs on the
+// calling thread alone.
+//
+// The pool starts the first time work is split, with ZMATH_THREADS threads from the environment, or one per
+// hardware thread. Work runs on pool threads, so per-thread state (the matrix resource, allocation_stats()) is
+// theirs, not the caller's, for anything allocated inside it. A thread waiting on parallel_for() only runs
+// ranges of the call it waits on, never unrelated work, so state it holds across the call isn't touched by
+// anyone else's body.
+// Nested calls are safe: the inner call waits on its own ranges the same way.
+
+namespace ZMathLib_Graphics {
+// Threads used by one operation, the calling thread included. 0 goes back to the default.
+// Don't call while Matrix operations are running on other threads.
+void set_thread_count(unsigned int count);
+unsigned int thread_count();
+
+// Calls body(begin, end) over disjoint ranges covering [0, count), concurrently. Ranges are at least `grain`
+// long (the last aside), and grow for large counts so there are a few per thread. The first exception thrown
+// by body is rethrown here once every range has finished or been skipped.
+void parallel_for(size_t count, size_t grain, void (*body)(void *context, size_t begin, size_t end), void *context);
+
+template <typename F>
+requires std::is_invocable_v<F &, size_t, size_t>
+void parallel_for(size_t count, size_t grain, F &&body)
+{
+	using Body = std::remove_reference_t<F>;
+	parallel_for(count, grain, [](void *context, size_t begin, size_t end) {
+		(*static_cast<Body *>(context))(begin, end);
+	}, const_cast<void *>(static_cast<void const *>(&body)));
+}
+}
+
+#endif
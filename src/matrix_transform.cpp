@@ -0,0 +1,157 @@
+#include "mathtype.hpp"
+#include "matrix_kernels.hpp"
+#include <cstddef>
+#include <cstring>
+
+// Batched matrix * vector kernels over packed xyz / xyzw arrays (the layout of a span of Vec3 / Vec4).
+// The matrix is hoisted into locals once. Each batch is deinterleaved into one lane array per component,
+// transformed with fixed trip count loops the compiler turns into full-width vector code, and interleaved back.
+// Compiled for SSE2/AVX2/AVX-512 and picked from CPUID on first use, like the elementwise kernels.
+
+namespace ZMathLib_Graphics::Kernels {
+namespace {
+// vectors per batch, enough to fill an AVX-512 register per component in float
+constexpr size_t BATCH = 16;
+
+// Applies a matrix to `count` vectors of Dim packed components.
+// Point: the vectors get an implicit w = 1, m is (Dim + 1) x (Dim + 1) and only its first Dim rows are used,
+// unless Project, which also computes w from the last row and divides by it.
+// Without Point, m is Dim x Dim. out may alias in.
+template <unsigned int Dim, bool Point, bool Project>
+inline void transform_batched(MATHTYPE const *m, MATHTYPE const *in, MATHTYPE *out, size_t count)
+{
+	constexpr unsigned int Cols = Point ? Dim + 1 : Dim;
+	constexpr unsigned int Rows = Project ? Dim + 1 : Dim;
+	MATHTYPE coeff[Rows][Cols];
+	for (unsigned int r = 0; r < Rows; ++r)
+		for (unsigned int c = 0; c < Cols; ++c)
+			coeff[r][c] = m[r * Cols + c];
+
+	size_t i = 0;
+	for (; i + BATCH <= count; i += BATCH) {
+		MATHTYPE lane[Dim][BATCH];
+		for (size_t b = 0; b < BATCH; ++b)
+			for (unsigned int d = 0; d < Dim; ++d)
+				lane[d][b] = in[(i + b) * Dim + d];
+		MATHTYPE res[Rows][BATCH];
+		for (unsigned int r = 0; r < Rows; ++r) {
+			for (size_t b = 0; b < BATCH; ++b)
+				res[r][b] = Point ? coeff[r][Dim] : MATHTYPE(0);
+			for (unsigned int c = 0; c < Dim; ++c)
+				for (size_t b = 0; b < BATCH; ++b)
+					res[r][b] += coeff[r][c] * lane[c][b];
+		}
+		if constexpr (Project) {
+			for (size_t b = 0; b < BATCH; ++b) {
+				MATHTYPE invW = 1 / res[Dim][b];
+				for (unsigned int d = 0; d < Dim; ++d)
+					res[d][b] *= invW;
+			}
+		}
+		for (size_t b = 0; b < BATCH; ++b)
+			for (unsigned int d = 0; d < Dim; ++d)
+				out[(i + b) * Dim + d] = res[d][b];
+	}
+	for (; i < count; ++i) {
+		MATHTYPE v[Dim], res[Rows];
+		for (unsigned int d = 0; d < Dim; ++d)
+			v[d] = in[i * Dim + d];
+		for (unsigned int r = 0; r < Rows; ++r) {
+			res[r] = Point ? coeff[r][Dim] : MATHTYPE(0);
+			for (unsigned int c = 0; c < Dim; ++c)
+				res[r] += coeff[r][c] * v[c];
+		}
+		MATHTYPE invW = Project ? 1 / res[Rows - 1] : MATHTYPE(1);
+		for (unsigned int d = 0; d < Dim; ++d)
+			out[i * Dim + d] = Project ? res[d] * invW : res[d];
+	}
+}
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+typedef MATHTYPE Vector4 __attribute__((vector_size(4 * sizeof(MATHTYPE))));
+
+// xyzw already fills a vector, so a Vec4 is transformed as a weighted sum of the matrix columns instead
+inline void transform4_columns(MATHTYPE const *m, MATHTYPE const *in, MATHTYPE *out, size_t count)
+{
+	Vector4 column[4];
+	for (unsigned int c = 0; c < 4; ++c)
+		for (unsigned int r = 0; r < 4; ++r)
+			column[c][r] = m[r * 4 + c];
+	for (size_t i = 0; i < count; ++i) {
+		Vector4 v;
+		std::memcpy(&v, in + i * 4, sizeof(Vector4));
+		Vector4 res = column[0] * v[0] + column[1] * v[1] + column[2] * v[2] + column[3] * v[3];
+		std::memcpy(out + i * 4, &res, sizeof(Vector4));
+	}
+}
+#endif
+
+using TransformFunction = void (*)(MATHTYPE const *, MATHTYPE const *, MATHTYPE *, size_t);
+
+struct TransformKernels {
+	TransformFunction transform3;
+	TransformFunction transform4;
+	TransformFunction transform_affine3;
+	TransformFunction transform_projective3;
+};
+
+#define TRANSFORM_ISA(isa, isaTarget) \
+__attribute__((target(isaTarget), flatten)) \
+void transform3_##isa(MATHTYPE const *m, MATHTYPE const *in, MATHTYPE *out, size_t n) { transform_batched<3, false, false>(m, in, out, n); } \
+__attribute__((target(isaTarget), flatten)) \
+void transform4_##isa(MATHTYPE const *m, MATHTYPE const *in, MATHTYPE *out, size_t n) { transform4_columns(m, in, out, n); } \
+__attribute__((target(isaTarget), flatten)) \
+void transform_affine3_##isa(MATHTYPE const *m, MATHTYPE const *in, MATHTYPE *out, size_t n) { transform_batched<3, true, false>(m, in, out, n); } \
+__attribute__((target(isaTarget), flatten)) \
+void transform_projective3_##isa(MATHTYPE const *m, MATHTYPE const *in, MATHTYPE *out, size_t n) { transform_batched<3, true, true>(m, in, out, n); }
+
+#define TRANSFORM_TABLE(isa) \
+	TransformKernels{ transform3_##isa, transform4_##isa, transform_affine3_##isa, transform_projective3_##isa }
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+TRANSFORM_ISA(sse2, "sse2")
+TRANSFORM_ISA(avx2, "avx2,fma")
+TRANSFORM_ISA(avx512, "avx512f,fma")
+#endif
+
+TransformKernels select_transform()
+{
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("fma"))
+		return TRANSFORM_TABLE(avx512);
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma"))
+		return TRANSFORM_TABLE(avx2);
+	if (__builtin_cpu_supports("sse2"))
+		return TRANSFORM_TABLE(sse2);
+#endif
+	return TransformKernels{
+		transform_batched<3, false, false>, transform_batched<4, false, false>,
+		transform_batched<3, true, false>, transform_batched<3, true, true>
+	};
+}
+
+TransformKernels const &transform_kernels()
+{
+	static TransformKernels const kernels = select_transform();
+	return kernels;
+}
+}
+
+void transform3(MATHTYPE const *m, MATHTYPE const *in, MATHTYPE *out, size_t count)
+{
+	transform_kernels().transform3(m, in, out, count);
+}
+void transform4(MATHTYPE const *m, MATHTYPE const *in, MATHTYPE *out, size_t count)
+{
+	transform_kernels().transform4(m, in, out, count);
+}
+void transform_affine3(MATHTYPE const *m, MATHTYPE const *in, MATHTYPE *out, size_t count)
+{
+	transform_kernels().transform_affine3(m, in, out, count);
+}
+void transform_projective3(MATHTYPE const *m, MATHTYPE const *in, MATHTYPE *out, size_t count)
+{
+	transform_kernels().transform_projective3(m, in, out, count);
+}
+}
@@ -0,0 +1,91 @@
+#include "mathtype.hpp"
+#include "matrix_kernels.hpp"
+#include "matrix_threads.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <utility>
+
+// Blocked transposes. A naive transpose walks one side column-wise across the whole matrix, touching a new
+// cache line and, past a thousand or so cells a row, a new page for every cell. Going TILE x TILE tile by
+// tile, a tile's rows on both sides stay in L1 and in the TLB until every cell on them has been moved.
+
+namespace ZMathLib_Graphics::Kernels {
+namespace {
+// 32 rows of 32 cells: 8KiB of floats on each side, and 64 pages at most. Measured against 8 to 64 and
+// against a second level of 256 x 256 blocks, which didn't help.
+constexpr size_t TILE = 32;
+// cells below which a second thread costs more than it saves
+constexpr size_t PARALLEL_CELLS = size_t(1) << 15;
+
+// out = transpose of the rows x cols tile at in, written row by row. Out of place this beats going through a
+// buffer, which only adds copies.
+inline void transpose_tile(size_t rows, size_t cols, MATHTYPE *out, size_t ldo, MATHTYPE const *in, size_t ldi)
+{
+	for (size_t x = 0; x < cols; ++x)
+		for (size_t y = 0; y < rows; ++y)
+			out[x * ldo + y] = in[y * ldi + x];
+}
+// buffer (TILE cells a row) = transpose of the rows x cols tile at in
+inline void gather_transposed(size_t rows, size_t cols, MATHTYPE *buffer, MATHTYPE const *in, size_t ldi)
+{
+	for (size_t y = 0; y < rows; ++y)
+		for (size_t x = 0; x < cols; ++x)
+			buffer[x * TILE + y] = in[y * ldi + x];
+}
+// the rows x cols tile at out = buffer
+inline void scatter_rows(size_t rows, size_t cols, MATHTYPE *out, size_t ldo, MATHTYPE const *buffer)
+{
+	for (size_t y = 0; y < rows; ++y)
+		std::copy_n(buffer + y * TILE, cols, out + y * ldo);
+}
+// Swaps the rows x cols tile at a with the cols x rows tile at b, each becoming the transpose of the other.
+// Both are read into buffers before either is written, so the writes land on lines that were just loaded,
+// about three times faster than swapping cell by cell, which keeps both tiles' lines contending for L1.
+inline void swap_tiles(size_t rows, size_t cols, MATHTYPE *a, MATHTYPE *b, size_t ld)
+{
+	MATHTYPE aTransposed[TILE * TILE], bTransposed[TILE * TILE];
+	gather_transposed(rows, cols, aTransposed, a, ld);
+	gather_transposed(cols, rows, bTransposed, b, ld);
+	scatter_rows(cols, rows, b, ld, aTransposed);
+	scatter_rows(rows, cols, a, ld, bTransposed);
+}
+}
+
+void transpose(size_t rows, size_t cols, MATHTYPE *out, size_t ldo, MATHTYPE const *in, size_t ldi)
+{
+	// each range of tile columns of `in` is a range of tile rows of `out`, written by one thread
+	size_t tileColumns = (cols + TILE - 1) / TILE;
+	parallel_for(tileColumns, std::max<size_t>(1, PARALLEL_CELLS / (TILE * std::max<size_t>(rows, 1))),
+		[&](size_t begin, size_t end) {
+			for (size_t tx = begin * TILE; tx < std::min(cols, end * TILE); tx += TILE)
+				for (size_t ty = 0; ty < rows; ty += TILE)
+					transpose_tile(std::min(TILE, rows - ty), std::min(TILE, cols - tx),
+						out + tx * ldo + ty, ldo, in + ty * ldi + tx, ldi);
+		});
+}
+
+void transpose_square(size_t n, MATHTYPE *data, size_t ld)
+{
+	// within one tile everything is in L1 already, swap the triangles directly
+	if (n <= TILE) {
+		for (size_t y = 0; y < n; ++y)
+			for (size_t x = y + 1; x < n; ++x)
+				std::swap(data[y * ld + x], data[x * ld + y]);
+		return;
+	}
+	// tile row i swaps its tiles right of the diagonal with the mirrored ones below it, so every pair of
+	// tiles belongs to exactly one tile row and tile rows can run on separate threads
+	size_t tiles = (n + TILE - 1) / TILE;
+	parallel_for(tiles, std::max<size_t>(1, PARALLEL_CELLS / (TILE * std::max<size_t>(n, 1))),
+		[&](size_t begin, size_t end) {
+			for (size_t ty = begin * TILE; ty < std::min(n, end * TILE); ty += TILE) {
+				size_t height = std::min(TILE, n - ty);
+				MATHTYPE diagonal[TILE * TILE];
+				gather_transposed(height, height, diagonal, data + ty * ld + ty, ld);
+				scatter_rows(height, height, data + ty * ld + ty, ld, diagonal);
+				for (size_t tx = ty + TILE; tx < n; tx += TILE)
+					swap_tiles(height, std::min(TILE, n - tx), data + ty * ld + tx, data + tx * ld + ty, ld);
+			}
+		});
+}
+}
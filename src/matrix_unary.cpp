@@ -1,6 +1,9 @@
 #include "mathtype.hpp"
 #include "matrix.hpp"
+#include "matrix_kernels.hpp"
+#include "static_matrix.hpp"
 #include "vector.hpp"
+#include <algorithm>
 #include <stdexcept>
 #include <utility>
 
@@ -9,74 +12,109 @@ MATHTYPE Matrix::determinant() const
 {
 	if (width != height)
 		throw std::invalid_argument("Determinant requires square matrix");
-	// slight optimization!
-	//if (*this == Matrix::Identity(width))
-	//	return 1;
 	if (width == 1)
 		return _array[0];
 	if (width == 2)
-		return (_array[0 * 2 + 0] * _array[1 * 2 + 1]) - (_array[0 * 2 + 1] * _array[1 * 2 + 0]);
-	int sign = 1;
-	MATHTYPE ret = 0;
-	for (unsigned int x = 0; x < width; ++x) {
-		MATHTYPE multiplier = sign * _array[x];
-		sign = -sign;
-		if (multiplier == 0)
-			continue;
-		Matrix sub(width - 1, height - 1);
-		unsigned int i = 0;
-		for (unsigned int sy = 1; sy < height; ++sy) {
-			for (unsigned int sx = 0; sx < width; ++sx) {
-				if (sx == x) continue;
-				sub._array[i] = _array[sy * height + sx];
-				++i;
-			}
-		}
-		ret += multiplier * sub.determinant();
+		return StaticMatrix<2, 2>(*this).determinant();
+	if (width == 3)
+		return StaticMatrix<3, 3>(*this).determinant();
+	if (width == 4)
+		return StaticMatrix<4, 4>(*this).determinant();
+	return lu().determinant();
+}
+void Matrix::invert()
+{
+	*this = inverted();
+}
+Matrix Matrix::inverted() const
+{
+	if (width != height)
+		throw std::invalid_argument("Matrix::inverted() requires square matrix");
+	switch (width) {
+	case 1: return StaticMatrix<1, 1>(*this).inverted().to_matrix();
+	case 2: return StaticMatrix<2, 2>(*this).inverted().to_matrix();
+	case 3: return StaticMatrix<3, 3>(*this).inverted().to_matrix();
+	case 4: return StaticMatrix<4, 4>(*this).inverted().to_matrix();
 	}
-	return ret;
+	LUDecomposition factors = lu();
+	if (factors.singular)
+		throw std::invalid_argument("Matrix::inverted() requires a non-singular matrix");
+	return factors.inverse();
+}
+void Matrix::invert_affine()
+{
+	*this = inverted_affine();
 }
-Matrix Matrix::operator+() const
+Matrix Matrix::inverted_affine() const
+{
+	if (width == 3 && height == 3)
+		return StaticMatrix<3, 3>(*this).inverted_affine().to_matrix();
+	if (width == 4 && height == 4)
+		return StaticMatrix<4, 4>(*this).inverted_affine().to_matrix();
+	throw std::invalid_argument("Matrix::inverted_affine() expects a 3x3 or 4x4 Matrix");
+}
+Matrix Matrix::operator+() const &
 {
 	return Matrix(*this);
 }
+Matrix Matrix::operator+() &&
+{
+	return std::move(*this);
+}
 
-Matrix Matrix::operator-() const
+Matrix Matrix::operator-() const &
 {
 	return *this * -1;
 }
+Matrix Matrix::operator-() &&
+{
+	return std::move(*this) * -1;
+}
 void Matrix::transpose()
 {
-	MATHTYPE *newArray = new MATHTYPE[height * width];
-	for (unsigned int x = 0; x < width; ++x)
-		for (unsigned int y = 0; y < height; ++y)
-			newArray[x * height + y] = _array[y * width + x];
-	delete [] _array;
+	if (width == height) {
+		Kernels::transpose_square(width, _array, _stride);
+		return;
+	}
+	// the new rows are a different length, so they get a new (padded) buffer
+	size_t newStride = padded_stride(height, _rowAlignment);
+	MATHTYPE *newArray = allocate_cells(width * newStride, _rowAlignment);
+	Kernels::transpose(height, width, newArray, newStride, _array, _stride);
+	if (newStride != height)
+		for (unsigned int x = 0; x < width; ++x)
+			std::fill(newArray + x * newStride + height, newArray + (x + 1) * newStride, MATHTYPE(0));
+	release_cells();
 	_array = newArray;
+	_stride = newStride;
 	std::swap(width, height);
 }
-Matrix Matrix::transposed() const
+Matrix Matrix::transposed() const &
 {
-	Matrix ret(*this);
-	ret.transpose();
+	Matrix ret(height, width, Uninitialized(), _rowAlignment);
+	Kernels::transpose(height, width, ret._array, ret._stride, _array, _stride);
 	return ret;
 }
+Matrix Matrix::transposed() &&
+{
+	transpose();
+	return std::move(*this);
+}
 Vec2 Matrix::to_vec2() const
 {
 	if ((width == 1 && height == 2) || (width == 2 && height == 1))
-		return Vec2(_array[0], _array[1]);
+		return Vec2(vector_cell(0), vector_cell(1));
 	throw std::invalid_argument("Matrix::to_vec2() expects Matrix 1x2 or 2x1");
 }
 Vec3 Matrix::to_vec3() const
 {
 	if ((width == 1 && height == 3) || (width == 3 && height == 1))
-		return Vec3(_array[0], _array[1], _array[2]);
+		return Vec3(vector_cell(0), vector_cell(1), vector_cell(2));
 	throw std::invalid_argument("Matrix::to_vec3() expects Matrix 1x3 or 3x1");
 }
 Vec4 Matrix::to_vec4() const
 {
 	if ((width == 1 && height == 4) || (width == 4 && height == 1))
-		return Vec4(_array[0], _array[1], _array[2], _array[3]);
+		return Vec4(vector_cell(0), vector_cell(1), vector_cell(2), vector_cell(3));
 	throw std::invalid_argument("Matrix::to_vec4() expects Matrix 1x4 or 4x1");
 }
 }
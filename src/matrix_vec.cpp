@@ -1,17 +1,100 @@
 #include "vector.hpp"
 #include "matrix.hpp"
+#include "matrix_kernels.hpp"
+#include <stdexcept>
 
 using namespace ZMathLib_Graphics;
 
+// the batched kernels read spans of vectors as packed component arrays
+static_assert(sizeof(Vec3) == 3 * sizeof(MATHTYPE), "Vec3 must be 3 packed MATHTYPEs");
+static_assert(sizeof(Vec4) == 4 * sizeof(MATHTYPE), "Vec4 must be 4 packed MATHTYPEs");
+
+// The kernels take the matrix packed, rows with padding are copied into `packed` (width * height cells) first
+static MATHTYPE const *packed_cells(Matrix const &mtx, MATHTYPE *packed)
+{
+	if (mtx.stride() == mtx.width)
+		return mtx.data();
+	for (unsigned int y = 0; y < mtx.height; ++y)
+		for (unsigned int x = 0; x < mtx.width; ++x)
+			packed[y * mtx.width + x] = mtx.data()[y * mtx.stride() + x];
+	return packed;
+}
+
 Vec2 Matrix::operator*(Vec2 const &other) const
 {
-	return ((*this) * other.to_column()).to_vec2();
+	if (width != 2 || height != 2)
+		throw std::invalid_argument("Matrix * Vec2 operation requires a 2x2 Matrix");
+	MATHTYPE buffer[4];
+	MATHTYPE const *m = packed_cells(*this, buffer);
+	return Vec2(m[0] * other.x + m[1] * other.y,
+		m[2] * other.x + m[3] * other.y);
 }
 Vec3 Matrix::operator*(Vec3 const &other) const
 {
-	return ((*this) * other.to_column()).to_vec3();
+	if (width != 3 || height != 3)
+		throw std::invalid_argument("Matrix * Vec3 operation requires a 3x3 Matrix");
+	MATHTYPE buffer[9];
+	MATHTYPE const *m = packed_cells(*this, buffer);
+	return Vec3(m[0] * other.x + m[1] * other.y + m[2] * other.z,
+		m[3] * other.x + m[4] * other.y + m[5] * other.z,
+		m[6] * other.x + m[7] * other.y + m[8] * other.z);
 }
 Vec4 Matrix::operator*(Vec4 const &other) const
 {
-	return ((*this) * other.to_column()).to_vec4();
+	if (width != 4 || height != 4)
+		throw std::invalid_argument("Matrix * Vec4 operation requires a 4x4 Matrix");
+	MATHTYPE buffer[16];
+	MATHTYPE const *m = packed_cells(*this, buffer);
+	return Vec4(m[0] * other.x + m[1] * other.y + m[2] * other.z + m[3] * other.w,
+		m[4] * other.x + m[5] * other.y + m[6] * other.z + m[7] * other.w,
+		m[8] * other.x + m[9] * other.y + m[10] * other.z + m[11] * other.w,
+		m[12] * other.x + m[13] * other.y + m[14] * other.z + m[15] * other.w);
+}
+
+void Matrix::transform(std::span<Vec3 const> in, std::span<Vec3> out) const
+{
+	if (width != 3 || height != 3)
+		throw std::invalid_argument("Matrix::transform(Vec3) requires a 3x3 Matrix");
+	if (in.size() != out.size())
+		throw std::invalid_argument("Matrix::transform() requires in and out spans of equal size");
+	MATHTYPE buffer[9];
+	Kernels::transform3(packed_cells(*this, buffer), reinterpret_cast<MATHTYPE const *>(in.data()), reinterpret_cast<MATHTYPE *>(out.data()), in.size());
+}
+void Matrix::transform(std::span<Vec4 const> in, std::span<Vec4> out) const
+{
+	if (width != 4 || height != 4)
+		throw std::invalid_argument("Matrix::transform(Vec4) requires a 4x4 Matrix");
+	if (in.size() != out.size())
+		throw std::invalid_argument("Matrix::transform() requires in and out spans of equal size");
+	MATHTYPE buffer[16];
+	Kernels::transform4(packed_cells(*this, buffer), reinterpret_cast<MATHTYPE const *>(in.data()), reinterpret_cast<MATHTYPE *>(out.data()), in.size());
+}
+void Matrix::transform_points(std::span<Vec3 const> in, std::span<Vec3> out) const
+{
+	if (width != 4 || height != 4)
+		throw std::invalid_argument("Matrix::transform_points() requires a 4x4 Matrix");
+	if (in.size() != out.size())
+		throw std::invalid_argument("Matrix::transform_points() requires in and out spans of equal size");
+	MATHTYPE buffer[16];
+	MATHTYPE const *m = packed_cells(*this, buffer);
+	bool affine = m[12] == 0 && m[13] == 0 && m[14] == 0 && m[15] == 1;
+	if (affine)
+		Kernels::transform_affine3(m, reinterpret_cast<MATHTYPE const *>(in.data()), reinterpret_cast<MATHTYPE *>(out.data()), in.size());
+	else
+		Kernels::transform_projective3(m, reinterpret_cast<MATHTYPE const *>(in.data()), reinterpret_cast<MATHTYPE *>(out.data()), in.size());
+}
+void Matrix::transform_directions(std::span<Vec3 const> in, std::span<Vec3> out) const
+{
+	if (width != 4 || height != 4)
+		throw std::invalid_argument("Matrix::transform_directions() requires a 4x4 Matrix");
+	if (in.size() != out.size())
+		throw std::invalid_argument("Matrix::transform_directions() requires in and out spans of equal size");
+	MATHTYPE buffer[16];
+	MATHTYPE const *m = packed_cells(*this, buffer);
+	MATHTYPE linear[9] = {
+		m[0], m[1], m[2],
+		m[4], m[5], m[6],
+		m[8], m[9], m[10],
+	};
+	Kernels::transform3(linear, reinterpret_cast<MATHTYPE const *>(in.data()), reinterpret_cast<MATHTYPE *>(out.data()), in.size());
 }
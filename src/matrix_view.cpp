@@ -0,0 +1,160 @@
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include "matrix_kernels.hpp"
+#include "matrix_view.hpp"
+#include <cstring>
+#include <stdexcept>
+
+namespace ZMathLib_Graphics {
+template <typename T>
+BasicStridedView<T> BasicMatrixView<T>::row(unsigned int yRow) const
+{
+	if (yRow >= height)
+		throw std::out_of_range("Row index exceeded height of matrix view");
+	return BasicStridedView<T>(data + yRow * stride, width, 1);
+}
+template <typename T>
+BasicStridedView<T> BasicMatrixView<T>::column(unsigned int xColumn) const
+{
+	if (xColumn >= width)
+		throw std::out_of_range("Column index exceeded width of matrix view");
+	return BasicStridedView<T>(data + xColumn, height, stride);
+}
+template <typename T>
+BasicMatrixView<T> BasicMatrixView<T>::submatrix(unsigned int x, unsigned int y, unsigned int w, unsigned int h) const
+{
+	// empty like a Matrix can't be
+	if (w == 0)
+		throw std::out_of_range("Expected width > 0 for submatrix");
+	if (h == 0)
+		throw std::out_of_range("Expected height > 0 for submatrix");
+	if (x > width || w > width - x || y > height || h > height - y)
+		throw std::out_of_range("Submatrix exceeded the bounds of matrix view");
+	return BasicMatrixView(data + y * stride + x, w, h, stride);
+}
+
+static void check_same_size(MatrixConstView a, MatrixConstView b, char const *what)
+{
+	if (a.width != b.width || a.height != b.height)
+		throw std::invalid_argument(what);
+}
+
+template <typename T>
+BasicMatrixView<T> const &BasicMatrixView<T>::operator+=(MatrixConstView other) const requires (!std::is_const_v<T>)
+{
+	check_same_size(*this, other, "MatrixView += MatrixView operation requires views of equal width and height");
+	Kernels::add(height, width, data, stride, data, stride, other.data, other.stride);
+	return *this;
+}
+template <typename T>
+BasicMatrixView<T> const &BasicMatrixView<T>::operator-=(MatrixConstView other) const requires (!std::is_const_v<T>)
+{
+	check_same_size(*this, other, "MatrixView -= MatrixView operation requires views of equal width and height");
+	Kernels::sub(height, width, data, stride, data, stride, other.data, other.stride);
+	return *this;
+}
+template <typename T>
+BasicMatrixView<T> const &BasicMatrixView<T>::operator+=(MATHTYPE other) const requires (!std::is_const_v<T>)
+{
+	Kernels::add_scalar(height, width, data, stride, data, stride, other);
+	return *this;
+}
+template <typename T>
+BasicMatrixView<T> const &BasicMatrixView<T>::operator-=(MATHTYPE other) const requires (!std::is_const_v<T>)
+{
+	Kernels::sub_scalar(height, width, data, stride, data, stride, other);
+	return *this;
+}
+template <typename T>
+BasicMatrixView<T> const &BasicMatrixView<T>::operator*=(MATHTYPE other) const requires (!std::is_const_v<T>)
+{
+	Kernels::mul_scalar(height, width, data, stride, data, stride, other);
+	return *this;
+}
+template <typename T>
+BasicMatrixView<T> const &BasicMatrixView<T>::operator/=(MATHTYPE other) const requires (!std::is_const_v<T>)
+{
+	Kernels::div_scalar(height, width, data, stride, data, stride, other);
+	return *this;
+}
+
+template struct BasicMatrixView<MATHTYPE>;
+template struct BasicMatrixView<MATHTYPE const>;
+
+Matrix::Matrix(MatrixConstView view) : Matrix(view.width, view.height, Uninitialized())
+{
+	if (view.contiguous()) {
+		std::memcpy(_array, view.data, sizeof(MATHTYPE) * width * height);
+		return;
+	}
+	for (unsigned int y = 0; y < height; ++y)
+		std::memcpy(_array + y * _stride, view.data + y * view.stride, sizeof(MATHTYPE) * width);
+}
+
+MatrixView Matrix::view()
+{
+	return MatrixView(_array, width, height, _stride);
+}
+MatrixConstView Matrix::view() const
+{
+	return MatrixConstView(_array, width, height, _stride);
+}
+Matrix::operator MatrixView() &
+{
+	return view();
+}
+Matrix::operator MatrixConstView() const
+{
+	return view();
+}
+StridedView Matrix::row(unsigned int yRow)
+{
+	return view().row(yRow);
+}
+StridedConstView Matrix::row(unsigned int yRow) const
+{
+	return view().row(yRow);
+}
+StridedView Matrix::column(unsigned int xColumn)
+{
+	return view().column(xColumn);
+}
+StridedConstView Matrix::column(unsigned int xColumn) const
+{
+	return view().column(xColumn);
+}
+MatrixView Matrix::submatrix(unsigned int x, unsigned int y, unsigned int w, unsigned int h)
+{
+	return view().submatrix(x, y, w, h);
+}
+MatrixConstView Matrix::submatrix(unsigned int x, unsigned int y, unsigned int w, unsigned int h) const
+{
+	return view().submatrix(x, y, w, h);
+}
+
+Matrix operator+(MatrixConstView a, MatrixConstView b)
+{
+	check_same_size(a, b, "Matrix + Matrix operation requires matrices of equal width and height");
+	Matrix ret(a.width, a.height, Matrix::Uninitialized());
+	Kernels::add(a.height, a.width, ret._array, ret._stride, a.data, a.stride, b.data, b.stride);
+	return ret;
+}
+Matrix operator-(MatrixConstView a, MatrixConstView b)
+{
+	check_same_size(a, b, "Matrix - Matrix operation requires matrices of equal width and height");
+	Matrix ret(a.width, a.height, Matrix::Uninitialized());
+	Kernels::sub(a.height, a.width, ret._array, ret._stride, a.data, a.stride, b.data, b.stride);
+	return ret;
+}
+Matrix operator*(MatrixConstView a, MatrixConstView b)
+{
+	if (a.width != b.height)
+		throw std::invalid_argument("Matrix A * Matrix B operation requires that A.width == B.height");
+	Matrix ret(b.width, a.height, Matrix::Uninitialized());
+	Kernels::gemm(a.height, b.width, a.width, 1,
+		a.data, a.stride,
+		b.data, b.stride,
+		0, ret._array, ret._stride);
+	return ret;
+}
+}
@@ -0,0 +1,148 @@
+#ifndef MATRIX_VIEW_HPP
+#define MATRIX_VIEW_HPP
+
+#include "mathtype.hpp"
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+namespace ZMathLib_Graphics {
+struct Matrix;
+
+// Non-owning view of `size` cells, cell i is at data[i * stride].
+// A row of a Matrix is viewed with stride 1, a column with the stride of a row, no copy either way.
+// T is MATHTYPE for a mutable view, MATHTYPE const for a read-only one.
+template <typename T>
+struct BasicStridedView {
+	T *data;
+	size_t size;
+	size_t stride;
+
+	// Keeps the view's start and an index rather than a moving pointer: stepping a pointer by stride past the
+	// last cell of a column would leave the buffer, which isn't valid even without a dereference
+	struct iterator {
+		using iterator_category = std::random_access_iterator_tag;
+		using value_type = std::remove_const_t<T>;
+		using difference_type = std::ptrdiff_t;
+		using pointer = T *;
+		using reference = T &;
+
+		T *data;
+		difference_type index;
+		size_t stride;
+
+		T &operator*() const { return data[index * (difference_type) stride]; }
+		T &operator[](difference_type n) const { return data[(index + n) * (difference_type) stride]; }
+		iterator &operator++() { ++index; return *this; }
+		iterator operator++(int) { iterator ret = *this; ++index; return ret; }
+		iterator &operator--() { --index; return *this; }
+		iterator operator--(int) { iterator ret = *this; --index; return ret; }
+		iterator &operator+=(difference_type n) { index += n; return *this; }
+		iterator &operator-=(difference_type n) { index -= n; return *this; }
+		iterator operator+(difference_type n) const { return iterator{ data, index + n, stride }; }
+		iterator operator-(difference_type n) const { return iterator{ data, index - n, stride }; }
+		friend iterator operator+(difference_type n, iterator const &it) { return it + n; }
+		difference_type operator-(iterator const &other) const { return index - other.index; }
+		bool operator==(iterator const &other) const { return index == other.index; }
+		auto operator<=>(iterator const &other) const { return index <=> other.index; }
+	};
+
+	BasicStridedView(T *data, size_t size, size_t stride=1)
+		: data(data), size(size), stride(stride) {}
+	// Mutable views convert to read-only ones
+	template <typename U>
+	requires (std::is_const_v<T> && std::same_as<U, std::remove_const_t<T>>)
+	BasicStridedView(BasicStridedView<U> const &other)
+		: data(other.data), size(other.size), stride(other.stride) {}
+
+	// Range checked only when built with ZMATH_BOUNDS_CHECKS, like Matrix::operator()
+	T &operator[](size_t index) const
+	{
+#ifdef ZMATH_BOUNDS_CHECKS
+		if (index >= size)
+			throw std::out_of_range("index exceeded size of strided view");
+#endif
+		return data[index * stride];
+	}
+	iterator begin() const
+	{
+		return iterator{ data, 0, stride };
+	}
+	iterator end() const
+	{
+		return iterator{ data, (std::ptrdiff_t) size, stride };
+	}
+};
+using StridedView = BasicStridedView<MATHTYPE>;
+using StridedConstView = BasicStridedView<MATHTYPE const>;
+
+// Non-owning view of a width x height block of a row-major buffer, cell (x, y) is at data[y * stride + x].
+// stride is the distance in cells between the starts of two rows, width for a whole Matrix and more for a
+// submatrix. Views never allocate, rows are contiguous and columns are strided by `stride`.
+// T is MATHTYPE for a mutable view, MATHTYPE const for a read-only one.
+template <typename T>
+struct BasicMatrixView {
+	T *data;
+	unsigned int width, height;
+	size_t stride;
+
+	BasicMatrixView(T *data, unsigned int width, unsigned int height)
+		: data(data), width(width), height(height), stride(width) {}
+	BasicMatrixView(T *data, unsigned int width, unsigned int height, size_t stride)
+		: data(data), width(width), height(height), stride(stride) {}
+	// Mutable views convert to read-only ones
+	template <typename U>
+	requires (std::is_const_v<T> && std::same_as<U, std::remove_const_t<T>>)
+	BasicMatrixView(BasicMatrixView<U> const &other)
+		: data(other.data), width(other.width), height(other.height), stride(other.stride) {}
+
+	// Range checked only when built with ZMATH_BOUNDS_CHECKS, like Matrix::operator()
+	T &operator()(unsigned int xColumn, unsigned int yRow) const
+	{
+#ifdef ZMATH_BOUNDS_CHECKS
+		if (xColumn >= width)
+			throw std::out_of_range("Column index exceeded width of matrix view");
+		if (yRow >= height)
+			throw std::out_of_range("Row index exceeded height of matrix view");
+#endif
+		return data[yRow * stride + xColumn];
+	}
+	// Rows and columns throw std::out_of_range past the edge of the view
+	BasicStridedView<T> row(unsigned int yRow) const;
+	BasicStridedView<T> column(unsigned int xColumn) const;
+	// w x h block with its top-left cell at (x, y), throws std::out_of_range if it doesn't fit in this view or
+	// w or h is 0
+	BasicMatrixView submatrix(unsigned int x, unsigned int y, unsigned int w, unsigned int h) const;
+	// rows are back to back, so the view can be handled as one run of width * height cells
+	bool contiguous() const
+	{
+		return stride == width || height <= 1;
+	}
+
+	// In-place elementwise operations on the viewed cells. other must be the same size (std::invalid_argument
+	// otherwise), and may be the same block as this view but not partially overlap it.
+	BasicMatrixView const &operator+=(BasicMatrixView<MATHTYPE const> other) const requires (!std::is_const_v<T>);
+	BasicMatrixView const &operator-=(BasicMatrixView<MATHTYPE const> other) const requires (!std::is_const_v<T>);
+	BasicMatrixView const &operator+=(MATHTYPE other) const requires (!std::is_const_v<T>);
+	BasicMatrixView const &operator-=(MATHTYPE other) const requires (!std::is_const_v<T>);
+	BasicMatrixView const &operator*=(MATHTYPE other) const requires (!std::is_const_v<T>);
+	BasicMatrixView const &operator/=(MATHTYPE other) const requires (!std::is_const_v<T>);
+
+	// Arithmetic on views, e.g. blocks of a larger matrix, into a new Matrix. Either side may also be a Matrix.
+	// Only found through argument-dependent lookup, so they don't hide the global scalar * vector operators
+	friend Matrix operator+(BasicMatrixView<MATHTYPE const> a, BasicMatrixView<MATHTYPE const> b);
+	friend Matrix operator-(BasicMatrixView<MATHTYPE const> a, BasicMatrixView<MATHTYPE const> b);
+	friend Matrix operator*(BasicMatrixView<MATHTYPE const> a, BasicMatrixView<MATHTYPE const> b);
+};
+using MatrixView = BasicMatrixView<MATHTYPE>;
+using MatrixConstView = BasicMatrixView<MATHTYPE const>;
+
+// defined in matrix_view.cpp
+extern template struct BasicMatrixView<MATHTYPE>;
+extern template struct BasicMatrixView<MATHTYPE const>;
+}
+
+#endif
@@ -0,0 +1,512 @@
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include "matrix_kernels.hpp"
+#include "matrix_threads.hpp"
+#include "packed_matrix.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ZMathLib_Graphics {
+namespace {
+// first cell of row y of a packed lower triangle
+inline size_t triangle_row(size_t y)
+{
+	return y * (y + 1) / 2;
+}
+
+void check_size(unsigned int size)
+{
+	if (size == 0)
+		throw std::invalid_argument("Expected size > 0 for packed matrix constructor");
+}
+void check_square(MatrixConstView dense)
+{
+	if (dense.width != dense.height)
+		throw std::invalid_argument("Packed matrices require a square matrix to convert from");
+}
+void check_index(unsigned int size, unsigned int xColumn, unsigned int yRow)
+{
+	if (xColumn >= size)
+		throw std::out_of_range("Column index exceeded width of matrix");
+	if (yRow >= size)
+		throw std::out_of_range("Row index exceeded height of matrix");
+}
+void check_vectors(char const *name, unsigned int size, std::span<MATHTYPE const> x, std::span<MATHTYPE> y)
+{
+	if (x.size() != size || y.size() != size)
+		throw std::invalid_argument(std::string(name) + "::multiply() requires x and y of size cells");
+	if (Kernels::overlaps(x, y))
+		throw std::invalid_argument(std::string(name) + "::multiply() requires x and y not to overlap");
+}
+
+void zero_rows(size_t rows, size_t cols, MATHTYPE *out, size_t ldo)
+{
+	for (size_t y = 0; y < rows; ++y)
+		std::fill_n(out + y * ldo, cols, MATHTYPE(0));
+}
+
+// checks that packed * dense is defined and allocates its result
+template <typename Packed>
+Matrix product_result(Packed const &packed, Matrix const &dense)
+{
+	if (packed.size != dense.height)
+		throw std::invalid_argument("Packed matrix A * Matrix B operation requires that A.size == B.height");
+	return Matrix(dense.width, packed.size);
+}
+}
+
+TriangularMatrix::TriangularMatrix(unsigned int size, Part part)
+	: size(size), _part(part)
+{
+	check_size(size);
+	_cells.assign(triangle_row(size), 0);
+}
+TriangularMatrix::TriangularMatrix(MatrixConstView dense, Part part)
+	: TriangularMatrix(dense.width, part)
+{
+	check_square(dense);
+	for (unsigned int r = 0; r < size; ++r) {
+		MATHTYPE *row = _cells.data() + triangle_row(r);
+		if (part == Lower) {
+			std::copy_n(dense.data + r * dense.stride, r + 1, row);
+		} else {
+			// column r of the upper triangle
+			for (unsigned int y = 0; y <= r; ++y)
+				row[y] = dense(r, y);
+		}
+	}
+}
+
+TriangularMatrix::Part TriangularMatrix::part() const
+{
+	return _part;
+}
+bool TriangularMatrix::stored(unsigned int xColumn, unsigned int yRow) const
+{
+	return _part == Lower ? xColumn <= yRow : xColumn >= yRow;
+}
+size_t TriangularMatrix::index(unsigned int xColumn, unsigned int yRow) const
+{
+	return _part == Lower ? triangle_row(yRow) + xColumn : triangle_row(xColumn) + yRow;
+}
+MATHTYPE TriangularMatrix::get(unsigned int xColumn, unsigned int yRow) const
+{
+	check_index(size, xColumn, yRow);
+	return stored(xColumn, yRow) ? _cells[index(xColumn, yRow)] : MATHTYPE(0);
+}
+void TriangularMatrix::set(unsigned int xColumn, unsigned int yRow, MATHTYPE newValue)
+{
+	check_index(size, xColumn, yRow);
+	if (!stored(xColumn, yRow))
+		throw std::out_of_range("Cell is outside of the triangle stored by TriangularMatrix");
+	_cells[index(xColumn, yRow)] = newValue;
+}
+std::span<MATHTYPE const> TriangularMatrix::cells() const
+{
+	return _cells;
+}
+std::span<MATHTYPE> TriangularMatrix::cells()
+{
+	return _cells;
+}
+
+Matrix TriangularMatrix::to_dense() const
+{
+	Matrix ret(size, size);
+	MATHTYPE *out = ret.data();
+	size_t ld = ret.stride();
+	for (unsigned int r = 0; r < size; ++r) {
+		MATHTYPE const *row = _cells.data() + triangle_row(r);
+		if (_part == Lower) {
+			std::copy_n(row, r + 1, out + r * ld);
+		} else {
+			for (unsigned int y = 0; y <= r; ++y)
+				out[y * ld + r] = row[y];
+		}
+	}
+	return ret;
+}
+
+TriangularMatrix TriangularMatrix::transposed() const &
+{
+	return TriangularMatrix(*this).transposed();
+}
+TriangularMatrix TriangularMatrix::transposed() &&
+{
+	_part = _part == Lower ? Upper : Lower;
+	return std::move(*this);
+}
+
+void TriangularMatrix::multiply_rows(MATHTYPE const *in, size_t ldi, size_t cols, MATHTYPE *out, size_t ldo) const
+{
+	MATHTYPE const *cells = _cells.data();
+	if (_part == Upper) {
+		// stored by columns, so scattered: column r adds its cells times row r of in to the rows above
+		zero_rows(size, cols, out, ldo);
+		for (size_t r = 0; r < size; ++r) {
+			MATHTYPE const *column = cells + triangle_row(r);
+			if (cols == 1) {
+				MATHTYPE value = in[r * ldi];
+				for (size_t y = 0; y <= r; ++y)
+					out[y * ldo] += column[y] * value;
+			} else {
+				for (size_t y = 0; y <= r; ++y)
+					Kernels::axpy_row(out + y * ldo, column[y], in + r * ldi, cols);
+			}
+		}
+		return;
+	}
+	// rows are independent, spread over the pool
+	parallel_for(size, std::max<size_t>(1, Kernels::PARALLEL_WORK / std::max<size_t>(1, size * cols / 2)),
+		[&](size_t begin, size_t end) {
+			for (size_t y = begin; y < end; ++y) {
+				MATHTYPE const *row = cells + triangle_row(y);
+				MATHTYPE *outRow = out + y * ldo;
+				if (cols == 1) {
+					MATHTYPE sum = 0;
+					for (size_t x = 0; x <= y; ++x)
+						sum += row[x] * in[x * ldi];
+					*outRow = sum;
+					continue;
+				}
+				std::fill_n(outRow, cols, MATHTYPE(0));
+				for (size_t x = 0; x <= y; ++x)
+					Kernels::axpy_row(outRow, row[x], in + x * ldi, cols);
+			}
+		});
+}
+Matrix TriangularMatrix::operator*(Matrix const &dense) const
+{
+	Matrix ret = product_result(*this, dense);
+	multiply_rows(dense.data(), dense.stride(), dense.width, ret.data(), ret.stride());
+	return ret;
+}
+void TriangularMatrix::multiply(std::span<MATHTYPE const> x, std::span<MATHTYPE> y) const
+{
+	check_vectors("TriangularMatrix", size, x, y);
+	multiply_rows(x.data(), 1, 1, y.data(), 1);
+}
+
+Matrix TriangularMatrix::solve(Matrix const &b) const
+{
+	if (b.height != size)
+		throw std::invalid_argument("TriangularMatrix::solve requires B.height == T.size");
+	for (unsigned int i = 0; i < size; ++i)
+		if (_cells[triangle_row(i) + i] == 0)
+			throw std::invalid_argument("TriangularMatrix::solve requires a non-singular matrix");
+	Matrix ret(b);
+	MATHTYPE *x = ret.data();
+	size_t ld = ret.stride(), columns = ret.width;
+	MATHTYPE const *cells = _cells.data();
+	if (_part == Lower) {
+		// forward substitution, row y of L against the rows already solved
+		for (size_t y = 0; y < size; ++y) {
+			MATHTYPE const *row = cells + triangle_row(y);
+			MATHTYPE *solving = x + y * ld;
+			for (size_t k = 0; k < y; ++k)
+				if (row[k] != 0)
+					Kernels::axpy_row(solving, -row[k], x + k * ld, columns);
+			Kernels::scale_row(solving, 1 / row[y], columns);
+		}
+	} else {
+		// back substitution by columns, the way U is stored: once row r is solved, column r of U is
+		// taken out of every row above it
+		for (size_t r = size; r-- > 0;) {
+			MATHTYPE const *column = cells + triangle_row(r);
+			MATHTYPE *solved = x + r * ld;
+			Kernels::scale_row(solved, 1 / column[r], columns);
+			for (size_t y = 0; y < r; ++y)
+				if (column[y] != 0)
+					Kernels::axpy_row(x + y * ld, -column[y], solved, columns);
+		}
+	}
+	return ret;
+}
+
+SymmetricMatrix::SymmetricMatrix(unsigned int size)
+	: size(size)
+{
+	check_size(size);
+	_cells.assign(triangle_row(size), 0);
+}
+SymmetricMatrix::SymmetricMatrix(MatrixConstView dense)
+	: SymmetricMatrix(dense.width)
+{
+	check_square(dense);
+	for (unsigned int y = 0; y < size; ++y)
+		std::copy_n(dense.data + y * dense.stride, y + 1, _cells.data() + triangle_row(y));
+}
+
+MATHTYPE SymmetricMatrix::get(unsigned int xColumn, unsigned int yRow) const
+{
+	check_index(size, xColumn, yRow);
+	return xColumn <= yRow ? _cells[triangle_row(yRow) + xColumn] : _cells[triangle_row(xColumn) + yRow];
+}
+void SymmetricMatrix::set(unsigned int xColumn, unsigned int yRow, MATHTYPE newValue)
+{
+	check_index(size, xColumn, yRow);
+	(xColumn <= yRow ? _cells[triangle_row(yRow) + xColumn] : _cells[triangle_row(xColumn) + yRow]) = newValue;
+}
+std::span<MATHTYPE const> SymmetricMatrix::cells() const
+{
+	return _cells;
+}
+std::span<MATHTYPE> SymmetricMatrix::cells()
+{
+	return _cells;
+}
+Matrix SymmetricMatrix::to_dense() const
+{
+	Matrix ret(size, size);
+	MATHTYPE *out = ret.data();
+	size_t ld = ret.stride();
+	for (unsigned int y = 0; y < size; ++y) {
+		MATHTYPE const *row = _cells.data() + triangle_row(y);
+		std::copy_n(row, y + 1, out + y * ld);
+		for (unsigned int x = 0; x < y; ++x)
+			out[x * ld + y] = row[x];
+	}
+	return ret;
+}
+SymmetricMatrix SymmetricMatrix::transposed() const
+{
+	return *this;
+}
+
+void SymmetricMatrix::multiply_rows(MATHTYPE const *in, size_t ldi, size_t cols, MATHTYPE *out, size_t ldo) const
+{
+	// row r of the lower triangle is also column r of the upper one: its cells add to out row r, and times in
+	// row r to the rows above
+	zero_rows(size, cols, out, ldo);
+	for (size_t r = 0; r < size; ++r) {
+		MATHTYPE const *row = _cells.data() + triangle_row(r);
+		MATHTYPE const *inRow = in + r * ldi;
+		MATHTYPE *outRow = out + r * ldo;
+		if (cols == 1) {
+			MATHTYPE value = *inRow, sum = row[r] * value;
+			for (size_t x = 0; x < r; ++x) {
+				sum += row[x] * in[x * ldi];
+				out[x * ldo] += row[x] * value;
+			}
+			*outRow += sum;
+			continue;
+		}
+		for (size_t x = 0; x < r; ++x) {
+			Kernels::axpy_row(outRow, row[x], in + x * ldi, cols);
+			Kernels::axpy_row(out + x * ldo, row[x], inRow, cols);
+		}
+		Kernels::axpy_row(outRow, row[r], inRow, cols);
+	}
+}
+Matrix SymmetricMatrix::operator*(Matrix const &dense) const
+{
+	Matrix ret = product_result(*this, dense);
+	multiply_rows(dense.data(), dense.stride(), dense.width, ret.data(), ret.stride());
+	return ret;
+}
+void SymmetricMatrix::multiply(std::span<MATHTYPE const> x, std::span<MATHTYPE> y) const
+{
+	check_vectors("SymmetricMatrix", size, x, y);
+	multiply_rows(x.data(), 1, 1, y.data(), 1);
+}
+
+TriangularMatrix SymmetricMatrix::cholesky() const
+{
+	// row by row, both rows of each dot product contiguous in the packed storage
+	TriangularMatrix ret(size, TriangularMatrix::Lower);
+	MATHTYPE *l = ret.cells().data();
+	for (size_t i = 0; i < size; ++i) {
+		MATHTYPE const *a = _cells.data() + triangle_row(i);
+		MATHTYPE *row = l + triangle_row(i);
+		for (size_t j = 0; j <= i; ++j) {
+			MATHTYPE const *other = l + triangle_row(j);
+			MATHTYPE sum = a[j] - Kernels::dot(row, other, j);
+			if (j < i) {
+				row[j] = sum / other[j];
+			} else {
+				if (!(sum > 0))
+					throw std::invalid_argument("SymmetricMatrix::cholesky requires a positive definite matrix");
+				row[i] = std::sqrt(sum);
+			}
+		}
+	}
+	return ret;
+}
+Matrix SymmetricMatrix::solve(Matrix const &b) const
+{
+	if (b.height != size)
+		throw std::invalid_argument("SymmetricMatrix::solve requires B.height == S.size");
+	// L L^T X = B: L Y = B, then L^T X = Y
+	TriangularMatrix l = cholesky();
+	Matrix y = l.solve(b);
+	return std::move(l).transposed().solve(y);
+}
+
+BandedMatrix::BandedMatrix(unsigned int size, unsigned int lower, unsigned int upper)
+	: size(size), lower(lower), upper(upper)
+{
+	check_size(size);
+	if (lower >= size || upper >= size)
+		throw std::invalid_argument("BandedMatrix requires fewer diagonals than its size on either side");
+	_cells.assign(size * row_length(), 0);
+}
+BandedMatrix::BandedMatrix(MatrixConstView dense, unsigned int lower, unsigned int upper)
+	: BandedMatrix(dense.width, lower, upper)
+{
+	check_square(dense);
+	for (unsigned int y = 0; y < size; ++y) {
+		unsigned int first = y > lower ? y - lower : 0, last = std::min(size - 1, y + upper);
+		std::copy_n(dense.data + y * dense.stride + first, last - first + 1,
+			_cells.data() + y * row_length() + (first + lower - y));
+	}
+}
+
+size_t BandedMatrix::row_length() const
+{
+	return size_t(lower) + upper + 1;
+}
+bool BandedMatrix::stored(unsigned int xColumn, unsigned int yRow) const
+{
+	return xColumn <= yRow ? yRow - xColumn <= lower : xColumn - yRow <= upper;
+}
+MATHTYPE BandedMatrix::get(unsigned int xColumn, unsigned int yRow) const
+{
+	check_index(size, xColumn, yRow);
+	return stored(xColumn, yRow) ? _cells[yRow * row_length() + (xColumn + lower - yRow)] : MATHTYPE(0);
+}
+void BandedMatrix::set(unsigned int xColumn, unsigned int yRow, MATHTYPE newValue)
+{
+	check_index(size, xColumn, yRow);
+	if (!stored(xColumn, yRow))
+		throw std::out_of_range("Cell is outside of the band stored by BandedMatrix");
+	_cells[yRow * row_length() + (xColumn + lower - yRow)] = newValue;
+}
+std::span<MATHTYPE const> BandedMatrix::cells() const
+{
+	return _cells;
+}
+std::span<MATHTYPE> BandedMatrix::cells()
+{
+	return _cells;
+}
+Matrix BandedMatrix::to_dense() const
+{
+	Matrix ret(size, size);
+	MATHTYPE *out = ret.data();
+	size_t ld = ret.stride();
+	for (unsigned int y = 0; y < size; ++y) {
+		unsigned int first = y > lower ? y - lower : 0, last = std::min(size - 1, y + upper);
+		std::copy_n(_cells.data() + y * row_length() + (first + lower - y), last - first + 1, out + y * ld + first);
+	}
+	return ret;
+}
+BandedMatrix BandedMatrix::transposed() const
+{
+	BandedMatrix ret(size, upper, lower);
+	for (unsigned int y = 0; y < size; ++y) {
+		unsigned int first = y > lower ? y - lower : 0, last = std::min(size - 1, y + upper);
+		MATHTYPE const *row = _cells.data() + y * row_length();
+		// (x, y) goes to (y, x), row x of the transpose
+		for (unsigned int x = first; x <= last; ++x)
+			ret._cells[x * ret.row_length() + (y + ret.lower - x)] = row[x + lower - y];
+	}
+	return ret;
+}
+
+void BandedMatrix::multiply_rows(MATHTYPE const *in, size_t ldi, size_t cols, MATHTYPE *out, size_t ldo) const
+{
+	parallel_for(size, std::max<size_t>(1, Kernels::PARALLEL_WORK / std::max<size_t>(1, row_length() * cols)),
+		[&](size_t begin, size_t end) {
+			for (size_t y = begin; y < end; ++y) {
+				size_t first = y > lower ? y - lower : 0, last = std::min<size_t>(size - 1, y + upper);
+				// slot s of the row is column y - lower + s
+				MATHTYPE const *row = _cells.data() + y * row_length() + lower - y;
+				MATHTYPE *outRow = out + y * ldo;
+				if (cols == 1) {
+					MATHTYPE sum = 0;
+					for (size_t x = first; x <= last; ++x)
+						sum += row[x] * in[x * ldi];
+					*outRow = sum;
+					continue;
+				}
+				std::fill_n(outRow, cols, MATHTYPE(0));
+				for (size_t x = first; x <= last; ++x)
+					Kernels::axpy_row(outRow, row[x], in + x * ldi, cols);
+			}
+		});
+}
+Matrix BandedMatrix::operator*(Matrix const &dense) const
+{
+	Matrix ret = product_result(*this, dense);
+	multiply_rows(dense.data(), dense.stride(), dense.width, ret.data(), ret.stride());
+	return ret;
+}
+void BandedMatrix::multiply(std::span<MATHTYPE const> x, std::span<MATHTYPE> y) const
+{
+	check_vectors("BandedMatrix", size, x, y);
+	multiply_rows(x.data(), 1, 1, y.data(), 1);
+}
+
+Matrix BandedMatrix::solve(Matrix const &b) const
+{
+	if (b.height != size)
+		throw std::invalid_argument("BandedMatrix::solve requires B.height == A.size");
+	// Rows of the factorization hold columns y - lower to y + lower + upper, the room row swaps need.
+	// Column c of row r is at r * width + (c + lower - r), as in the band itself.
+	size_t const width = size_t(2) * lower + upper + 1, n = size;
+	std::vector<MATHTYPE> lu(n * width, 0);
+	for (size_t y = 0; y < n; ++y)
+		std::copy_n(_cells.data() + y * row_length(), row_length(), lu.data() + y * width);
+	auto cell = [&](size_t c, size_t r) -> MATHTYPE & { return lu[r * width + (c + lower - r)]; };
+	std::vector<size_t> pivots(n);
+	for (size_t k = 0; k < n; ++k) {
+		size_t lastRow = std::min(n - 1, k + lower), lastColumn = std::min(n - 1, k + lower + upper);
+		size_t pivot = k;
+		for (size_t r = k + 1; r <= lastRow; ++r)
+			if (std::fabs(cell(k, r)) > std::fabs(cell(k, pivot)))
+				pivot = r;
+		if (cell(k, pivot) == 0)
+			throw std::invalid_argument("BandedMatrix::solve requires a non-singular matrix");
+		pivots[k] = pivot;
+		// columns left of k hold the multipliers of earlier steps and stay with their position
+		if (pivot != k)
+			for (size_t c = k; c <= lastColumn; ++c)
+				std::swap(cell(c, k), cell(c, pivot));
+		MATHTYPE inversePivot = 1 / cell(k, k);
+		for (size_t r = k + 1; r <= lastRow; ++r) {
+			MATHTYPE factor = cell(k, r) * inversePivot;
+			cell(k, r) = factor;
+			if (factor == 0)
+				continue;
+			for (size_t c = k + 1; c <= lastColumn; ++c)
+				cell(c, r) -= factor * cell(c, k);
+		}
+	}
+
+	Matrix ret(b);
+	MATHTYPE *x = ret.data();
+	size_t ld = ret.stride(), columns = ret.width;
+	// the same row swaps and eliminations on B, then U X = Y
+	for (size_t k = 0; k < n; ++k) {
+		if (pivots[k] != k)
+			std::swap_ranges(x + k * ld, x + k * ld + columns, x + pivots[k] * ld);
+		for (size_t r = k + 1; r <= std::min(n - 1, k + lower); ++r)
+			if (cell(k, r) != 0)
+				Kernels::axpy_row(x + r * ld, -cell(k, r), x + k * ld, columns);
+	}
+	for (size_t y = n; y-- > 0;) {
+		MATHTYPE *solving = x + y * ld;
+		for (size_t c = y + 1; c <= std::min(n - 1, y + lower + upper); ++c)
+			if (cell(c, y) != 0)
+				Kernels::axpy_row(solving, -cell(c, y), x + c * ld, columns);
+		Kernels::scale_row(solving, 1 / cell(y, y), columns);
+	}
+	return ret;
+}
+}
@@ -1,9 +1,15 @@
 #include "quaternion.hpp"
 #include "mathtype.hpp"
 #include "matrix.hpp"
+#include "matrix_kernels.hpp"
 #include "vector.hpp"
+#include <cmath>
+#include <stdexcept>
 using namespace ZMathLib_Graphics;
 
+// the span overloads hand Quaternion arrays to the kernels as packed rijk
+static_assert(sizeof(Quaternion) == 4 * sizeof(MATHTYPE), "Quaternion must be 4 packed MATHTYPEs");
+
 Quaternion Quaternion::Zero()
 {
 	return Quaternion(0, 0, 0, 0);
@@ -28,6 +34,148 @@ Quaternion Quaternion::K()
 {
 	return Quaternion(0, 0, 0, 1);
 }
+Quaternion Quaternion::from_axis_angle(Vec3 const &axis, MATHTYPE angle)
+{
+	MATHTYPE length = axis.length();
+	// a zero axis (parallel vectors' cross product) has no direction to rotate about
+	if (length == 0)
+		return R();
+	MATHTYPE s = std::sin(angle / 2) / length;
+	return Quaternion(std::cos(angle / 2), axis.x * s, axis.y * s, axis.z * s);
+}
+Quaternion Quaternion::from_euler(MATHTYPE x, MATHTYPE y, MATHTYPE z)
+{
+	// qz * qy * qx multiplied out
+	MATHTYPE cx = std::cos(x / 2), sx = std::sin(x / 2);
+	MATHTYPE cy = std::cos(y / 2), sy = std::sin(y / 2);
+	MATHTYPE cz = std::cos(z / 2), sz = std::sin(z / 2);
+	return Quaternion(
+		cx * cy * cz + sx * sy * sz,
+		sx * cy * cz - cx * sy * sz,
+		cx * sy * cz + sx * cy * sz,
+		cx * cy * sz - sx * sy * cz
+	);
+}
+Quaternion Quaternion::from_matrix(Matrix const &mtx)
+{
+	if (!((mtx.width == 3 && mtx.height == 3) || (mtx.width == 4 && mtx.height == 4)))
+		throw std::invalid_argument("Quaternion::from_matrix() expects a 3x3 or 4x4 Matrix");
+	MATHTYPE const *d = mtx.data();
+	size_t w = mtx.stride();
+	// m(row, column)
+	auto m = [d, w](unsigned int row, unsigned int column) { return d[row * w + column]; };
+	// Shepperd's method: solve for the largest component first so the square root and division stay well conditioned
+	MATHTYPE trace = m(0, 0) + m(1, 1) + m(2, 2);
+	if (trace > 0) {
+		MATHTYPE s = std::sqrt(trace + 1) * 2;
+		return Quaternion(s / 4, (m(2, 1) - m(1, 2)) / s, (m(0, 2) - m(2, 0)) / s, (m(1, 0) - m(0, 1)) / s);
+	}
+	if (m(0, 0) > m(1, 1) && m(0, 0) > m(2, 2)) {
+		MATHTYPE s = std::sqrt(1 + m(0, 0) - m(1, 1) - m(2, 2)) * 2;
+		return Quaternion((m(2, 1) - m(1, 2)) / s, s / 4, (m(0, 1) + m(1, 0)) / s, (m(0, 2) + m(2, 0)) / s);
+	}
+	if (m(1, 1) > m(2, 2)) {
+		MATHTYPE s = std::sqrt(1 + m(1, 1) - m(0, 0) - m(2, 2)) * 2;
+		return Quaternion((m(0, 2) - m(2, 0)) / s, (m(0, 1) + m(1, 0)) / s, s / 4, (m(1, 2) + m(2, 1)) / s);
+	}
+	MATHTYPE s = std::sqrt(1 + m(2, 2) - m(0, 0) - m(1, 1)) * 2;
+	return Quaternion((m(1, 0) - m(0, 1)) / s, (m(0, 2) + m(2, 0)) / s, (m(1, 2) + m(2, 1)) / s, s / 4);
+}
+
+// Row-major 3x3 rotation matrix of a unit quaternion
+static void rotation_cells(Vec4 const &q, MATHTYPE *out, unsigned int stride)
+{
+	MATHTYPE w = q.x, x = q.y, y = q.z, z = q.w;
+	out[0 * stride + 0] = 1 - 2 * (y * y + z * z);
+	out[0 * stride + 1] = 2 * (x * y - w * z);
+	out[0 * stride + 2] = 2 * (x * z + w * y);
+	out[1 * stride + 0] = 2 * (x * y + w * z);
+	out[1 * stride + 1] = 1 - 2 * (x * x + z * z);
+	out[1 * stride + 2] = 2 * (y * z - w * x);
+	out[2 * stride + 0] = 2 * (x * z - w * y);
+	out[2 * stride + 1] = 2 * (y * z + w * x);
+	out[2 * stride + 2] = 1 - 2 * (x * x + y * y);
+}
+Matrix Quaternion::to_matrix3() const
+{
+	Matrix ret(3, 3);
+	rotation_cells(_vec, ret.data(), 3);
+	return ret;
+}
+Matrix Quaternion::to_matrix4() const
+{
+	Matrix ret(4, 4);
+	rotation_cells(_vec, ret.data(), 4);
+	ret.data()[15] = 1;
+	return ret;
+}
+
+Vec3 Quaternion::rotate(Vec3 const &vec) const
+{
+	// v' = v + w t + u x t, with t = 2 u x v and u the vector part
+	MATHTYPE w = _vec.x, ux = _vec.y, uy = _vec.z, uz = _vec.w;
+	MATHTYPE tx = 2 * (uy * vec.z - uz * vec.y);
+	MATHTYPE ty = 2 * (uz * vec.x - ux * vec.z);
+	MATHTYPE tz = 2 * (ux * vec.y - uy * vec.x);
+	return Vec3(
+		vec.x + w * tx + (uy * tz - uz * ty),
+		vec.y + w * ty + (uz * tx - ux * tz),
+		vec.z + w * tz + (ux * ty - uy * tx)
+	);
+}
+void Quaternion::rotate(std::span<Vec3 const> in, std::span<Vec3> out) const
+{
+	if (in.size() != out.size())
+		throw std::invalid_argument("Quaternion::rotate() requires in and out spans of equal size");
+	// over many vectors the 9 multiply-adds of the matrix form beat the two cross products,
+	// so build it once and reuse the batched Matrix::transform kernel
+	MATHTYPE m[9];
+	rotation_cells(_vec, m, 3);
+	Kernels::transform3(m, reinterpret_cast<MATHTYPE const *>(in.data()), reinterpret_cast<MATHTYPE *>(out.data()), in.size());
+}
+
+Quaternion Quaternion::nlerp(Quaternion const &to, MATHTYPE t) const
+{
+	// flipping the sign of `to` when the dot product is negative takes the shortest arc
+	MATHTYPE cosine = _vec.dot(to._vec);
+	return Quaternion(_vec * (1 - t) + to._vec * std::copysign(t, cosine)).normalized();
+}
+Quaternion Quaternion::slerp(Quaternion const &to, MATHTYPE t) const
+{
+	MATHTYPE cosine = _vec.dot(to._vec);
+	// sin(theta) vanishes as the quaternions get close, where nlerp is just as accurate
+	if (std::abs(cosine) > MATHTYPE(0.9995))
+		return nlerp(to, t);
+	MATHTYPE theta = std::acos(std::abs(cosine));
+	MATHTYPE invSin = 1 / std::sin(theta);
+	MATHTYPE w0 = std::sin((1 - t) * theta) * invSin;
+	MATHTYPE w1 = std::copysign(std::sin(t * theta) * invSin, cosine);
+	return Quaternion(_vec * w0 + to._vec * w1);
+}
+Quaternion Quaternion::slerp_fast(Quaternion const &to, MATHTYPE t) const
+{
+	MATHTYPE cosine = _vec.dot(to._vec);
+	MATHTYPE w0 = Kernels::slerp_weight(1 - t, std::abs(cosine));
+	MATHTYPE w1 = std::copysign(Kernels::slerp_weight(t, std::abs(cosine)), cosine);
+	return Quaternion(_vec * w0 + to._vec * w1);
+}
+void Quaternion::nlerp(std::span<Quaternion const> from, std::span<Quaternion const> to,
+	std::span<MATHTYPE const> t, std::span<Quaternion> out)
+{
+	if (from.size() != to.size() || from.size() != t.size() || from.size() != out.size())
+		throw std::invalid_argument("Quaternion::nlerp() requires from, to, t and out spans of equal size");
+	Kernels::nlerp(reinterpret_cast<MATHTYPE const *>(from.data()), reinterpret_cast<MATHTYPE const *>(to.data()),
+		t.data(), reinterpret_cast<MATHTYPE *>(out.data()), out.size());
+}
+void Quaternion::slerp_fast(std::span<Quaternion const> from, std::span<Quaternion const> to,
+	std::span<MATHTYPE const> t, std::span<Quaternion> out)
+{
+	if (from.size() != to.size() || from.size() != t.size() || from.size() != out.size())
+		throw std::invalid_argument("Quaternion::slerp_fast() requires from, to, t and out spans of equal size");
+	Kernels::slerp_fast(reinterpret_cast<MATHTYPE const *>(from.data()), reinterpret_cast<MATHTYPE const *>(to.data()),
+		t.data(), reinterpret_cast<MATHTYPE *>(out.data()), out.size());
+}
+
 Matrix Quaternion::to_row() const
 {
 	return _vec.to_row();
@@ -0,0 +1,337 @@
+#include "mathtype.hpp"
+#include "matrix.hpp"
+#include "matrix_kernels.hpp"
+#include "matrix_threads.hpp"
+#include "sparse_matrix.hpp"
+#include "vector.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <optional>
+#include <span>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+namespace ZMathLib_Graphics {
+namespace {
+void check_size(unsigned int w, unsigned int h)
+{
+	if (w == 0)
+		throw std::invalid_argument("Expected width > 0 for sparse matrix constructor");
+	if (h == 0)
+		throw std::invalid_argument("Expected height > 0 for sparse matrix constructor");
+}
+
+// rows [begin, end) of a CSR product, out rows zeroed first
+template <size_t COLS>
+void csr_rows(size_t const *offsets, unsigned int const *indices, MATHTYPE const *values, size_t begin, size_t end,
+	MATHTYPE const *in, size_t ldi, size_t cols, MATHTYPE *out, size_t ldo)
+{
+	for (size_t y = begin; y < end; ++y) {
+		MATHTYPE *outRow = out + y * ldo;
+		if (COLS == 1) {
+			// one accumulator per row instead of a load and store per cell
+			MATHTYPE sum = 0;
+			for (size_t i = offsets[y]; i < offsets[y + 1]; ++i)
+				sum += values[i] * in[indices[i] * ldi];
+			*outRow = sum;
+			continue;
+		}
+		std::fill_n(outRow, COLS ? COLS : cols, MATHTYPE(0));
+		for (size_t i = offsets[y]; i < offsets[y + 1]; ++i)
+			Kernels::axpy_row<COLS>(outRow, values[i], in + indices[i] * ldi, cols);
+	}
+}
+
+// a whole CSC product, scattering each column into the rows it has cells in
+template <size_t COLS>
+void csc_columns(size_t outerSize, size_t height, size_t const *offsets, unsigned int const *indices,
+	MATHTYPE const *values, MATHTYPE const *in, size_t ldi, size_t cols, MATHTYPE *out, size_t ldo)
+{
+	for (size_t y = 0; y < height; ++y)
+		std::fill_n(out + y * ldo, COLS ? COLS : cols, MATHTYPE(0));
+	for (size_t x = 0; x < outerSize; ++x)
+		for (size_t i = offsets[x]; i < offsets[x + 1]; ++i)
+			Kernels::axpy_row<COLS>(out + indices[i] * ldo, values[i], in + x * ldi, cols);
+}
+}
+
+SparseMatrix::SparseMatrix(unsigned int w, unsigned int h, Format format)
+	: width(w), height(h), _format(format)
+{
+	check_size(w, h);
+	_offsets.assign(size_t(outer_size()) + 1, 0);
+}
+
+SparseMatrix::SparseMatrix(MatrixConstView dense, Format format, MATHTYPE tolerance)
+	: SparseMatrix(dense.width, dense.height, format)
+{
+	// kept unless within tolerance of 0, NaN included
+	auto kept = [&](MATHTYPE cell) { return !(std::abs(cell) <= tolerance); };
+	// count each outer's cells, then fill, walking the dense rows in order both times so the inner
+	// indices come out sorted
+	for (unsigned int y = 0; y < height; ++y)
+		for (unsigned int x = 0; x < width; ++x)
+			if (kept(dense(x, y)))
+				++_offsets[(format == CSR ? y : x) + 1];
+	std::partial_sum(_offsets.begin(), _offsets.end(), _offsets.begin());
+	_indices.resize(_offsets.back());
+	_values.resize(_offsets.back());
+	std::vector<size_t> next(_offsets.begin(), _offsets.end() - 1);
+	for (unsigned int y = 0; y < height; ++y)
+		for (unsigned int x = 0; x < width; ++x) {
+			MATHTYPE cell = dense(x, y);
+			if (!kept(cell))
+				continue;
+			size_t i = next[format == CSR ? y : x]++;
+			_indices[i] = format == CSR ? x : y;
+			_values[i] = cell;
+		}
+}
+
+SparseMatrix SparseMatrix::from_triplets(unsigned int w, unsigned int h, std::span<Triplet const> triplets, Format format)
+{
+	SparseMatrix ret(w, h, format);
+	for (Triplet const &triplet : triplets) {
+		if (triplet.xColumn >= w)
+			throw std::out_of_range("Triplet column exceeded width of sparse matrix");
+		if (triplet.yRow >= h)
+			throw std::out_of_range("Triplet row exceeded height of sparse matrix");
+		++ret._offsets[(format == CSR ? triplet.yRow : triplet.xColumn) + 1];
+	}
+	std::partial_sum(ret._offsets.begin(), ret._offsets.end(), ret._offsets.begin());
+	// bucket by outer index, then sort each bucket and sum duplicates, compacting as we go
+	std::vector<std::pair<unsigned int, MATHTYPE>> cells(triplets.size());
+	std::vector<size_t> next(ret._offsets.begin(), ret._offsets.end() - 1);
+	for (Triplet const &triplet : triplets) {
+		bool csr = format == CSR;
+		cells[next[csr ? triplet.yRow : triplet.xColumn]++] = { csr ? triplet.xColumn : triplet.yRow, triplet.value };
+	}
+	ret._indices.reserve(cells.size());
+	ret._values.reserve(cells.size());
+	for (unsigned int outer = 0; outer < ret.outer_size(); ++outer) {
+		auto first = cells.begin() + ret._offsets[outer], last = cells.begin() + ret._offsets[outer + 1];
+		std::stable_sort(first, last, [](auto const &a, auto const &b) { return a.first < b.first; });
+		ret._offsets[outer] = ret._indices.size();
+		for (auto cell = first; cell != last; ++cell) {
+			if (cell != first && cell->first == ret._indices.back()) {
+				ret._values.back() += cell->second;
+			} else {
+				ret._indices.push_back(cell->first);
+				ret._values.push_back(cell->second);
+			}
+		}
+	}
+	ret._offsets.back() = ret._indices.size();
+	return ret;
+}
+
+unsigned int SparseMatrix::outer_size() const
+{
+	return _format == CSR ? height : width;
+}
+SparseMatrix::Format SparseMatrix::format() const
+{
+	return _format;
+}
+size_t SparseMatrix::nonzeros() const
+{
+	return _values.size();
+}
+std::span<size_t const> SparseMatrix::offsets() const
+{
+	return _offsets;
+}
+std::span<unsigned int const> SparseMatrix::indices() const
+{
+	return _indices;
+}
+std::span<MATHTYPE const> SparseMatrix::values() const
+{
+	return _values;
+}
+std::span<MATHTYPE> SparseMatrix::values()
+{
+	return _values;
+}
+
+MATHTYPE SparseMatrix::get(unsigned int xColumn, unsigned int yRow) const
+{
+	if (xColumn >= width)
+		throw std::out_of_range("Column index exceeded width of sparse matrix");
+	if (yRow >= height)
+		throw std::out_of_range("Row index exceeded height of sparse matrix");
+	unsigned int outer = _format == CSR ? yRow : xColumn, inner = _format == CSR ? xColumn : yRow;
+	auto first = _indices.begin() + _offsets[outer], last = _indices.begin() + _offsets[outer + 1];
+	auto found = std::lower_bound(first, last, inner);
+	return found != last && *found == inner ? _values[found - _indices.begin()] : MATHTYPE(0);
+}
+
+Matrix SparseMatrix::to_dense() const
+{
+	Matrix ret(width, height);
+	MatrixView cells = ret.view();
+	for (unsigned int outer = 0; outer < outer_size(); ++outer)
+		for (size_t i = _offsets[outer]; i < _offsets[outer + 1]; ++i) {
+			if (_format == CSR)
+				cells(_indices[i], outer) = _values[i];
+			else
+				cells(outer, _indices[i]) = _values[i];
+		}
+	return ret;
+}
+
+SparseMatrix SparseMatrix::to_format(Format format) const
+{
+	if (format == _format)
+		return *this;
+	// counting sort by inner index, walking the outer indices in order so they come out sorted per bucket
+	SparseMatrix ret(width, height, format);
+	for (unsigned int inner : _indices)
+		++ret._offsets[inner + 1];
+	std::partial_sum(ret._offsets.begin(), ret._offsets.end(), ret._offsets.begin());
+	ret._indices.resize(_indices.size());
+	ret._values.resize(_values.size());
+	std::vector<size_t> next(ret._offsets.begin(), ret._offsets.end() - 1);
+	for (unsigned int outer = 0; outer < outer_size(); ++outer)
+		for (size_t i = _offsets[outer]; i < _offsets[outer + 1]; ++i) {
+			size_t j = next[_indices[i]]++;
+			ret._indices[j] = outer;
+			ret._values[j] = _values[i];
+		}
+	return ret;
+}
+
+SparseMatrix SparseMatrix::transposed() const &
+{
+	return SparseMatrix(*this).transposed();
+}
+SparseMatrix SparseMatrix::transposed() &&
+{
+	std::swap(width, height);
+	_format = _format == CSR ? CSC : CSR;
+	return std::move(*this);
+}
+
+SparseMatrix SparseMatrix::operator+(SparseMatrix const &other) const
+{
+	if (width != other.width || height != other.height)
+		throw std::invalid_argument("SparseMatrix + SparseMatrix operation requires matrices of equal width and height");
+	std::optional<SparseMatrix> converted;
+	if (other._format != _format)
+		converted = other.to_format(_format);
+	SparseMatrix const &rhs = converted ? *converted : other;
+	SparseMatrix ret(width, height, _format);
+	ret._indices.reserve(_indices.size() + rhs._indices.size());
+	ret._values.reserve(_values.size() + rhs._values.size());
+	// merge each pair of sorted outers
+	for (unsigned int outer = 0; outer < outer_size(); ++outer) {
+		size_t i = _offsets[outer], iEnd = _offsets[outer + 1];
+		size_t j = rhs._offsets[outer], jEnd = rhs._offsets[outer + 1];
+		while (i < iEnd || j < jEnd) {
+			if (j == jEnd || (i < iEnd && _indices[i] < rhs._indices[j])) {
+				ret._indices.push_back(_indices[i]);
+				ret._values.push_back(_values[i++]);
+			} else if (i == iEnd || rhs._indices[j] < _indices[i]) {
+				ret._indices.push_back(rhs._indices[j]);
+				ret._values.push_back(rhs._values[j++]);
+			} else {
+				ret._indices.push_back(_indices[i]);
+				ret._values.push_back(_values[i++] + rhs._values[j++]);
+			}
+		}
+		ret._offsets[outer + 1] = ret._indices.size();
+	}
+	return ret;
+}
+SparseMatrix SparseMatrix::operator-(SparseMatrix const &other) const
+{
+	if (width != other.width || height != other.height)
+		throw std::invalid_argument("SparseMatrix - SparseMatrix operation requires matrices of equal width and height");
+	return *this + -other;
+}
+SparseMatrix SparseMatrix::operator-() const
+{
+	SparseMatrix ret(*this);
+	for (MATHTYPE &value : ret._values)
+		value = -value;
+	return ret;
+}
+SparseMatrix SparseMatrix::operator*(MATHTYPE other) const
+{
+	SparseMatrix ret(*this);
+	for (MATHTYPE &value : ret._values)
+		value *= other;
+	return ret;
+}
+SparseMatrix SparseMatrix::operator/(MATHTYPE other) const
+{
+	SparseMatrix ret(*this);
+	for (MATHTYPE &value : ret._values)
+		value /= other;
+	return ret;
+}
+
+void SparseMatrix::multiply_rows(MATHTYPE const *in, size_t ldi, size_t cols, MATHTYPE *out, size_t ldo) const
+{
+	// with the common widths fixed at compile time the inner loops unroll
+	auto run = [&]<size_t COLS>() {
+		if (_format == CSC) {
+			csc_columns<COLS>(width, height, _offsets.data(), _indices.data(), _values.data(), in, ldi, cols, out, ldo);
+			return;
+		}
+		size_t rowWork = std::max<size_t>(1, _values.size() * cols / height);
+		parallel_for(height, std::max<size_t>(1, Kernels::PARALLEL_WORK / rowWork), [&](size_t begin, size_t end) {
+			csr_rows<COLS>(_offsets.data(), _indices.data(), _values.data(), begin, end, in, ldi, cols, out, ldo);
+		});
+	};
+	switch (cols) {
+	case 1: run.template operator()<1>(); break;
+	case 3: run.template operator()<3>(); break;
+	case 4: run.template operator()<4>(); break;
+	default: run.template operator()<0>(); break;
+	}
+}
+
+void SparseMatrix::multiply(std::span<MATHTYPE const> x, std::span<MATHTYPE> y) const
+{
+	if (x.size() != width || y.size() != height)
+		throw std::invalid_argument("SparseMatrix::multiply() requires x of width cells and y of height cells");
+	if (Kernels::overlaps(x, y))
+		throw std::invalid_argument("SparseMatrix::multiply() requires x and y not to overlap");
+	multiply_rows(x.data(), 1, 1, y.data(), 1);
+}
+Matrix SparseMatrix::operator*(Matrix const &dense) const
+{
+	if (width != dense.height)
+		throw std::invalid_argument("SparseMatrix A * Matrix B operation requires that A.width == B.height");
+	Matrix ret(dense.width, height);
+	MatrixConstView in = dense.view();
+	MatrixView out = ret.view();
+	multiply_rows(in.data, in.stride, in.width, out.data, out.stride);
+	return ret;
+}
+void SparseMatrix::multiply(std::span<Vec3 const> in, std::span<Vec3> out) const
+{
+	if (in.size() != width || out.size() != height)
+		throw std::invalid_argument("SparseMatrix::multiply() requires width vectors in and height vectors out");
+	if (Kernels::overlaps(in, out))
+		throw std::invalid_argument("SparseMatrix::multiply() requires in and out not to overlap");
+	multiply_rows(&in.data()->x, 3, 3, &out.data()->x, 3);
+}
+void SparseMatrix::multiply(std::span<Vec4 const> in, std::span<Vec4> out) const
+{
+	if (in.size() != width || out.size() != height)
+		throw std::invalid_argument("SparseMatrix::multiply() requires width vectors in and height vectors out");
+	if (Kernels::overlaps(in, out))
+		throw std::invalid_argument("SparseMatrix::multiply() requires in and out not to overlap");
+	multiply_rows(&in.data()->x, 4, 4, &out.data()->x, 4);
+}
+}
+
+ZMathLib_Graphics::SparseMatrix operator*(MATHTYPE other, ZMathLib_Graphics::SparseMatrix const &mtx)
+{
+	return mtx * other;
+}
@@ -0,0 +1,107 @@
+#ifndef SPARSE_MATRIX_HPP
+#define SPARSE_MATRIX_HPP
+
+#include "mathtype.hpp"
+#include "matrix_view.hpp"
+#include <cstddef>
+#include <span>
+#include <vector>
+
+// Compressed sparse matrices, for matrices that are nearly all zeros (constraints, adjacency, Laplacians).
+// Only the stored cells take memory and time: n nonzeros cost n values, n indices and one offset per row
+// (or column), and products do n multiply-adds instead of width * height.
+//
+// CSR keeps each row's cells together: the cells of row y are indices()/values() from offsets()[y] to
+// offsets()[y + 1], indices() holding their columns in increasing order. CSC is the same by columns.
+// Products with CSR matrices run rows on the thread pool (see matrix_threads.hpp). CSC products scatter into
+// the result and stay on the calling thread, so convert with to_format() before multiplying repeatedly.
+
+namespace ZMathLib_Graphics {
+struct Matrix;
+struct Vec3;
+struct Vec4;
+
+struct SparseMatrix {
+	enum Format { CSR, CSC };
+	// One cell for from_triplets()
+	struct Triplet {
+		unsigned int xColumn, yRow;
+		MATHTYPE value;
+	};
+
+	unsigned int width, height;
+
+	// w x h of zeros, nothing stored
+	SparseMatrix(unsigned int w, unsigned int h, Format format=CSR);
+	// The cells of dense whose magnitude is above tolerance
+	explicit SparseMatrix(MatrixConstView dense, Format format=CSR, MATHTYPE tolerance=0);
+	// A w x h matrix of the given cells, in any order, with duplicates summed.
+	// Throws std::out_of_range for cells outside of w x h.
+	static SparseMatrix from_triplets(unsigned int w, unsigned int h, std::span<Triplet const> triplets, Format format=CSR);
+
+	Format format() const;
+	// Cells stored, zeros produced by arithmetic on stored cells included
+	size_t nonzeros() const;
+	std::span<size_t const> offsets() const;
+	std::span<unsigned int const> indices() const;
+	std::span<MATHTYPE const> values() const;
+	// The stored values can change in place, the cells they are at can't
+	std::span<MATHTYPE> values();
+
+	// Throws std::out_of_range unless (xColumn, yRow) is inside the matrix, 0 for cells not stored
+	MATHTYPE get(unsigned int xColumn, unsigned int yRow) const;
+	Matrix to_dense() const;
+	// The same matrix in the other format, or a copy
+	SparseMatrix to_format(Format format) const;
+	// The CSR storage of a matrix is the CSC storage of its transpose, so the transpose flips the format and
+	// keeps the arrays: copied here, moved on an rvalue. to_format() on the result gets the original format back.
+	SparseMatrix transposed() const &;
+	SparseMatrix transposed() &&;
+
+	// Elementwise, with the left operand's format. Both must be the same size (std::invalid_argument otherwise),
+	// the result stores the cells stored in either.
+	SparseMatrix operator+(SparseMatrix const &other) const;
+	SparseMatrix operator-(SparseMatrix const &other) const;
+	SparseMatrix operator-() const;
+	SparseMatrix operator*(MATHTYPE other) const;
+	SparseMatrix operator/(MATHTYPE other) const;
+	// value = func(xColumn, yRow, value) on every stored cell, the zeros elsewhere stay zeros
+	template <typename F>
+	void map_values(F &&func);
+
+	// y = this * x. x must have width cells and y height cells, and they must not overlap.
+	void multiply(std::span<MATHTYPE const> x, std::span<MATHTYPE> y) const;
+	// this * dense, dense must be width tall
+	Matrix operator*(Matrix const &dense) const;
+	// Every vector component at once: out[y] = sum of get(x, y) * in[x], as if in and out were width x 3 (or 4)
+	// and height x 3 matrices. in must have width vectors and out height vectors, and they must not overlap.
+	void multiply(std::span<Vec3 const> in, std::span<Vec3> out) const;
+	void multiply(std::span<Vec4 const> in, std::span<Vec4> out) const;
+private:
+	Format _format;
+	// one past the last cell of each row (CSR) or column (CSC), after a leading 0
+	std::vector<size_t> _offsets;
+	// column (CSR) or row (CSC) of each stored cell
+	std::vector<unsigned int> _indices;
+	std::vector<MATHTYPE> _values;
+
+	// rows for CSR, columns for CSC
+	unsigned int outer_size() const;
+	// out (height x cols, ldo apart) = this * in (width x cols, ldi apart)
+	void multiply_rows(MATHTYPE const *in, size_t ldi, size_t cols, MATHTYPE *out, size_t ldo) const;
+};
+
+template <typename F>
+void SparseMatrix::map_values(F &&func)
+{
+	for (unsigned int outer = 0; outer < outer_size(); ++outer)
+		for (size_t i = _offsets[outer]; i < _offsets[outer + 1]; ++i) {
+			unsigned int inner = _indices[i];
+			_values[i] = _format == CSR ? func(inner, outer, _values[i]) : func(outer, inner, _values[i]);
+		}
+}
+}
+
+ZMathLib_Graphics::SparseMatrix operator*(MATHTYPE other, ZMathLib_Graphics::SparseMatrix const &mtx);
+
+#endif
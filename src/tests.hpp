@@ -19,12 +19,21 @@
 	{if (!(condition)) \
 		test_fail(#condition __VA_ARGS__);}
 
+#define test_assert_throws(expression, exception) \
+	{bool thrown = false; \
+	try { (void) (expression); } catch (exception const &) { thrown = true; } \
+	if (!thrown) \
+		test_fail(#expression " throws " #exception);}
+
 namespace ZMathLib_Graphics::Tests {
 	void test_all();
 
 	void test_mtx_transforms();
 
 	void test_vec_conversions();
+	void test_vec_soa();
+	void test_quaternion_rotations();
+	void test_quaternion_interp();
 	void test_vec2_conversions();
 	void test_vec3_conversions();
 	void test_vec4_conversions();
@@ -34,12 +43,30 @@ namespace ZMathLib_Graphics::Tests {
 	void test_mtx_apply_ops();
 	void test_mtx_mtx_ops();
 	void test_mtx_vec_ops();
+	void test_mtx_transform();
+	void test_mtx_move_ops();
+	void test_mtx_gemm();
+	void test_mtx_strassen();
+	void test_mtx_lu();
+	void test_mtx_inverse();
+	void test_mtx_views();
+	void test_mtx_expr();
+	void test_mtx_memory();
+	void test_mtx_layout();
+	void test_mtx_threads();
+	void test_mtx_io();
+	void test_mtx_qr();
+	void test_mtx_eigen();
 	void test_mtx_compare_ops();
 	void test_mtx_accesses();
 	void test_mtx_ctors();
 	void test_mtx_constctors();
 	void test_mtx_normal_ctors();
 
+	void test_static_mtx();
+	void test_sparse_mtx();
+	void test_packed_mtx();
+
 	void test_vec4();
 	void test_vec4_unary_ops();
 	void test_vec4_scalar_ops();
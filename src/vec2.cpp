@@ -35,7 +35,7 @@ MATHTYPE Vec2::shortened() const
 	return x;
 }
 
-Vec3 Vec2::extended(float z) const
+Vec3 Vec2::extended(MATHTYPE z) const
 {
 	return Vec3(x, y, z);
 }
@@ -277,16 +277,16 @@ ZMathLib_Graphics::Vec2 operator%(MATHTYPE const a, ZMathLib_Graphics::Vec2 b)
 Matrix Vec2::to_row() const
 {
 	Matrix ret(2, 1);
-	ret.set(0, 0, x);
-	ret.set(1, 0, y);
+	ret(0, 0) = x;
+	ret(1, 0) = y;
 	return ret;
 }
 // Converts Vec2 to a 1x2 matrix
 Matrix Vec2::to_column() const
 {
 	Matrix ret(1, 2);
-	ret.set(0, 0, x);
-	ret.set(0, 1, y);
+	ret(0, 0) = x;
+	ret(0, 1) = y;
 	return ret;
 }
 // Converts Vec2 to a 3x1 matrix, with z as the rightmost component (defaults to z=0)
@@ -308,18 +308,18 @@ ZMathLib_Graphics::Vec3 operator%(MATHTYPE const a, ZMathLib_Graphics::Vec3 b)
 Matrix Vec3::to_row() const
 {
 	Matrix ret(3, 1);
-	ret.set(0, 0, x);
-	ret.set(1, 0, y);
-	ret.set(2, 0, z);
+	ret(0, 0) = x;
+	ret(1, 0) = y;
+	ret(2, 0) = z;
 	return ret;
 }
 // Converts Vec3 to a 1x3 matrix
 Matrix Vec3::to_column() const
 {
 	Matrix ret(1, 3);
-	ret.set(0, 0, x);
-	ret.set(0, 1, y);
-	ret.set(0, 2, z);
+	ret(0, 0) = x;
+	ret(0, 1) = y;
+	ret(0, 2) = z;
 	return ret;
 }
 // Converts Vec3 to a 4x1 matrix, with w as the rightmost component (defaults to w=0)
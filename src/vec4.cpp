@@ -296,20 +296,20 @@ ZMathLib_Graphics::Vec4 operator%(MATHTYPE const a, ZMathLib_Graphics::Vec4 b)
 Matrix Vec4::to_row() const
 {
 	Matrix ret(4, 1);
-	ret.set(0, 0, x);
-	ret.set(1, 0, y);
-	ret.set(2, 0, z);
-	ret.set(3, 0, w);
+	ret(0, 0) = x;
+	ret(1, 0) = y;
+	ret(2, 0) = z;
+	ret(3, 0) = w;
 	return ret;
 }
 // Converts Vec4 to a 1x4 matrix
 Matrix Vec4::to_column() const
 {
 	Matrix ret(1, 4);
-	ret.set(0, 0, x);
-	ret.set(0, 1, y);
-	ret.set(0, 2, z);
-	ret.set(0, 3, w);
+	ret(0, 0) = x;
+	ret(0, 1) = y;
+	ret(0, 2) = z;
+	ret(0, 3) = w;
 	return ret;
 }
 // Drops w, returning just Vec3(x, y, z)
@@ -321,21 +321,21 @@ Vec3 Vec4::shortened() const
 Matrix Vec4::extended_row(MATHTYPE v) const
 {
 	Matrix ret(5, 1);
-	ret.set(0, 0, x);
-	ret.set(1, 0, y);
-	ret.set(2, 0, z);
-	ret.set(3, 0, w);
-	ret.set(4, 0, v);
+	ret(0, 0) = x;
+	ret(1, 0) = y;
+	ret(2, 0) = z;
+	ret(3, 0) = w;
+	ret(4, 0) = v;
 	return ret;
 }
 // Extends Vec4 to Matrix(1, 5) with v
 Matrix Vec4::extended_column(MATHTYPE v) const
 {
 	Matrix ret(1, 5);
-	ret.set(0, 0, x);
-	ret.set(0, 1, y);
-	ret.set(0, 2, z);
-	ret.set(0, 3, w);
-	ret.set(0, 4, v);
+	ret(0, 0) = x;
+	ret(0, 1) = y;
+	ret(0, 2) = z;
+	ret(0, 3) = w;
+	ret(0, 4) = v;
 	return ret;
 }
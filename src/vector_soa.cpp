@@ -0,0 +1,351 @@
+#include "mathtype.hpp"
+#include "vector.hpp"
+#include "vector_soa.hpp"
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <stdexcept>
+
+// The bulk kernels are written once per operation over a Lanes accessor, and instantiated for three layouts:
+//  - separate unit-stride lanes (Vec3SoA / Vec4SoA),
+//  - packed vectors (a span of Vec3 / Vec4), where all components are addressed from one base pointer so the
+//    compiler can see they don't overlap,
+//  - anything else, with a runtime stride.
+// The first two have fixed strides and vectorize. This file is built with -fno-math-errno (see CMakeLists.txt),
+// which std::sqrt needs to become a vector instruction.
+
+// Every iteration only touches vector i of each view, so there are no loop-carried dependencies even when an
+// output is the same view as an input. Saying so lets GCC vectorize without runtime alias checks.
+#if defined(__GNUC__) && !defined(__clang__)
+#define SOA_LOOP _Pragma("GCC ivdep") for
+#else
+#define SOA_LOOP for
+#endif
+
+namespace ZMathLib_Graphics {
+namespace {
+// Component k of vector i is c[k][i * stride], Stride == 0 means the stride is only known at runtime
+template <unsigned int Dim, typename T, size_t Stride>
+struct Lanes {
+	T *c[Dim];
+	size_t stride;
+
+	T &operator()(unsigned int k, size_t i) const
+	{
+		return c[k][i * (Stride ? Stride : stride)];
+	}
+};
+
+template <unsigned int Dim, typename View>
+bool is_packed(View const &view)
+{
+	if (view.stride != Dim)
+		return false;
+	for (unsigned int k = 1; k < Dim; ++k)
+		if (view.component(k) != view.x + k)
+			return false;
+	return true;
+}
+
+template <unsigned int Dim, size_t Stride, typename View>
+auto lanes_of(View const &view)
+{
+	using T = std::remove_pointer_t<decltype(view.x)>;
+	Lanes<Dim, T, Stride> ret;
+	for (unsigned int k = 0; k < Dim; ++k)
+		ret.c[k] = Stride == Dim ? view.x + k : view.component(k);
+	ret.stride = view.stride;
+	return ret;
+}
+
+// Calls body with a Lanes accessor for each view, all of them in the fastest layout they have in common
+template <unsigned int Dim, typename Body, typename... Views>
+void dispatch(Body &&body, Views const &...views)
+{
+	if ((is_packed<Dim>(views) && ...))
+		body(lanes_of<Dim, Dim>(views)...);
+	else if (((views.stride == 1) && ...))
+		body(lanes_of<Dim, 1>(views)...);
+	else
+		body(lanes_of<Dim, 0>(views)...);
+}
+
+template <typename... Sizes>
+void check_sizes(char const *what, size_t size, Sizes... sizes)
+{
+	if (((sizes != size) || ...))
+		throw std::invalid_argument(what);
+}
+
+template <unsigned int Dim, typename View>
+void dot_impl(View const &a, View const &b, std::span<MATHTYPE> out)
+{
+	check_sizes("dot() expects views and output of equal size", a.size, b.size, out.size());
+	MATHTYPE *o = out.data();
+	dispatch<Dim>([&](auto la, auto lb) {
+		SOA_LOOP (size_t i = 0; i < a.size; ++i) {
+			MATHTYPE sum = 0;
+			for (unsigned int k = 0; k < Dim; ++k)
+				sum += la(k, i) * lb(k, i);
+			o[i] = sum;
+		}
+	}, a, b);
+}
+
+template <unsigned int Dim, typename View>
+void length_squared_impl(View const &vecs, std::span<MATHTYPE> out)
+{
+	check_sizes("length_squared() expects a view and output of equal size", vecs.size, out.size());
+	MATHTYPE *o = out.data();
+	dispatch<Dim>([&](auto l) {
+		SOA_LOOP (size_t i = 0; i < vecs.size; ++i) {
+			MATHTYPE sum = 0;
+			for (unsigned int k = 0; k < Dim; ++k)
+				sum += l(k, i) * l(k, i);
+			o[i] = sum;
+		}
+	}, vecs);
+}
+
+template <unsigned int Dim, typename View>
+void length_impl(View const &vecs, std::span<MATHTYPE> out)
+{
+	check_sizes("length() expects a view and output of equal size", vecs.size, out.size());
+	MATHTYPE *o = out.data();
+	dispatch<Dim>([&](auto l) {
+		SOA_LOOP (size_t i = 0; i < vecs.size; ++i) {
+			MATHTYPE sum = 0;
+			for (unsigned int k = 0; k < Dim; ++k)
+				sum += l(k, i) * l(k, i);
+			o[i] = std::sqrt(sum);
+		}
+	}, vecs);
+}
+
+template <unsigned int Dim, typename View>
+void normalize_impl(View const &vecs)
+{
+	dispatch<Dim>([&](auto l) {
+		SOA_LOOP (size_t i = 0; i < vecs.size; ++i) {
+			MATHTYPE sum = 0;
+			for (unsigned int k = 0; k < Dim; ++k)
+				sum += l(k, i) * l(k, i);
+			MATHTYPE invLength = 1 / std::sqrt(sum);
+			for (unsigned int k = 0; k < Dim; ++k)
+				l(k, i) *= invLength;
+		}
+	}, vecs);
+}
+
+template <unsigned int Dim, typename View>
+void clamp_impl(View const &vecs, MATHTYPE const min, MATHTYPE const max)
+{
+	dispatch<Dim>([&](auto l) {
+		SOA_LOOP (size_t i = 0; i < vecs.size; ++i)
+			for (unsigned int k = 0; k < Dim; ++k)
+				l(k, i) = std::clamp(l(k, i), min, max);
+	}, vecs);
+}
+
+template <unsigned int Dim, typename View>
+void limit_length_impl(View const &vecs, MATHTYPE const maxLength, MATHTYPE const minLength)
+{
+	MATHTYPE minTgtLenSqr = minLength * minLength;
+	MATHTYPE maxTgtLenSqr = maxLength * maxLength;
+	dispatch<Dim>([&](auto l) {
+		SOA_LOOP (size_t i = 0; i < vecs.size; ++i) {
+			MATHTYPE lenSqr = 0;
+			for (unsigned int k = 0; k < Dim; ++k)
+				lenSqr += l(k, i) * l(k, i);
+			// same as Vec3::limit_length, with the branches turned into min/max so the loop vectorizes.
+			// A zero vector divides by 1 instead, and stays zero.
+			MATHTYPE target = std::min(std::max(lenSqr, minTgtLenSqr), maxTgtLenSqr);
+			MATHTYPE scaleBy = std::sqrt(target / (lenSqr + MATHTYPE(lenSqr == 0)));
+			for (unsigned int k = 0; k < Dim; ++k)
+				l(k, i) *= scaleBy;
+		}
+	}, vecs);
+}
+}
+
+Vec3SoA::Vec3SoA(size_t size)
+	: x(size), y(size), z(size) {}
+Vec3SoA::Vec3SoA(Vec3ConstView vecs)
+	: x(vecs.size), y(vecs.size), z(vecs.size)
+{
+	for (size_t i = 0; i < vecs.size; ++i) {
+		x[i] = vecs.x[i * vecs.stride];
+		y[i] = vecs.y[i * vecs.stride];
+		z[i] = vecs.z[i * vecs.stride];
+	}
+}
+size_t Vec3SoA::size() const
+{
+	return x.size();
+}
+void Vec3SoA::resize(size_t size)
+{
+	x.resize(size);
+	y.resize(size);
+	z.resize(size);
+}
+void Vec3SoA::push_back(Vec3 const &vec)
+{
+	x.push_back(vec.x);
+	y.push_back(vec.y);
+	z.push_back(vec.z);
+}
+Vec3 Vec3SoA::get(size_t index) const
+{
+	return Vec3(x[index], y[index], z[index]);
+}
+void Vec3SoA::set(size_t index, Vec3 const &vec)
+{
+	x[index] = vec.x;
+	y[index] = vec.y;
+	z[index] = vec.z;
+}
+void Vec3SoA::copy_to(Vec3View out) const
+{
+	check_sizes("Vec3SoA::copy_to() expects a view of equal size", size(), out.size);
+	for (size_t i = 0; i < out.size; ++i) {
+		out.x[i * out.stride] = x[i];
+		out.y[i * out.stride] = y[i];
+		out.z[i * out.stride] = z[i];
+	}
+}
+Vec3SoA::operator Vec3View()
+{
+	return Vec3View(x.data(), y.data(), z.data(), size());
+}
+Vec3SoA::operator Vec3ConstView() const
+{
+	return Vec3ConstView(x.data(), y.data(), z.data(), size());
+}
+
+Vec4SoA::Vec4SoA(size_t size)
+	: x(size), y(size), z(size), w(size) {}
+Vec4SoA::Vec4SoA(Vec4ConstView vecs)
+	: x(vecs.size), y(vecs.size), z(vecs.size), w(vecs.size)
+{
+	for (size_t i = 0; i < vecs.size; ++i) {
+		x[i] = vecs.x[i * vecs.stride];
+		y[i] = vecs.y[i * vecs.stride];
+		z[i] = vecs.z[i * vecs.stride];
+		w[i] = vecs.w[i * vecs.stride];
+	}
+}
+size_t Vec4SoA::size() const
+{
+	return x.size();
+}
+void Vec4SoA::resize(size_t size)
+{
+	x.resize(size);
+	y.resize(size);
+	z.resize(size);
+	w.resize(size);
+}
+void Vec4SoA::push_back(Vec4 const &vec)
+{
+	x.push_back(vec.x);
+	y.push_back(vec.y);
+	z.push_back(vec.z);
+	w.push_back(vec.w);
+}
+Vec4 Vec4SoA::get(size_t index) const
+{
+	return Vec4(x[index], y[index], z[index], w[index]);
+}
+void Vec4SoA::set(size_t index, Vec4 const &vec)
+{
+	x[index] = vec.x;
+	y[index] = vec.y;
+	z[index] = vec.z;
+	w[index] = vec.w;
+}
+void Vec4SoA::copy_to(Vec4View out) const
+{
+	check_sizes("Vec4SoA::copy_to() expects a view of equal size", size(), out.size);
+	for (size_t i = 0; i < out.size; ++i) {
+		out.x[i * out.stride] = x[i];
+		out.y[i * out.stride] = y[i];
+		out.z[i * out.stride] = z[i];
+		out.w[i * out.stride] = w[i];
+	}
+}
+Vec4SoA::operator Vec4View()
+{
+	return Vec4View(x.data(), y.data(), z.data(), w.data(), size());
+}
+Vec4SoA::operator Vec4ConstView() const
+{
+	return Vec4ConstView(x.data(), y.data(), z.data(), w.data(), size());
+}
+
+void dot(Vec3ConstView a, Vec3ConstView b, std::span<MATHTYPE> out)
+{
+	dot_impl<3>(a, b, out);
+}
+void dot(Vec4ConstView a, Vec4ConstView b, std::span<MATHTYPE> out)
+{
+	dot_impl<4>(a, b, out);
+}
+void cross(Vec3ConstView a, Vec3ConstView b, Vec3View out)
+{
+	check_sizes("cross() expects views of equal size", a.size, b.size, out.size);
+	dispatch<3>([&](auto la, auto lb) {
+		// out is written through its own accessor, dispatched on the same layout when it matches
+		dispatch<3>([&](auto lo) {
+			SOA_LOOP (size_t i = 0; i < a.size; ++i) {
+				MATHTYPE cx = la(1, i) * lb(2, i) - la(2, i) * lb(1, i);
+				MATHTYPE cy = la(2, i) * lb(0, i) - la(0, i) * lb(2, i);
+				MATHTYPE cz = la(0, i) * lb(1, i) - la(1, i) * lb(0, i);
+				lo(0, i) = cx;
+				lo(1, i) = cy;
+				lo(2, i) = cz;
+			}
+		}, out);
+	}, a, b);
+}
+void length(Vec3ConstView vecs, std::span<MATHTYPE> out)
+{
+	length_impl<3>(vecs, out);
+}
+void length(Vec4ConstView vecs, std::span<MATHTYPE> out)
+{
+	length_impl<4>(vecs, out);
+}
+void length_squared(Vec3ConstView vecs, std::span<MATHTYPE> out)
+{
+	length_squared_impl<3>(vecs, out);
+}
+void length_squared(Vec4ConstView vecs, std::span<MATHTYPE> out)
+{
+	length_squared_impl<4>(vecs, out);
+}
+void normalize(Vec3View vecs)
+{
+	normalize_impl<3>(vecs);
+}
+void normalize(Vec4View vecs)
+{
+	normalize_impl<4>(vecs);
+}
+void clamp(Vec3View vecs, MATHTYPE const min, MATHTYPE const max)
+{
+	clamp_impl<3>(vecs, min, max);
+}
+void clamp(Vec4View vecs, MATHTYPE const min, MATHTYPE const max)
+{
+	clamp_impl<4>(vecs, min, max);
+}
+void limit_length(Vec3View vecs, MATHTYPE const maxLength, MATHTYPE const minLength)
+{
+	limit_length_impl<3>(vecs, maxLength, minLength);
+}
+void limit_length(Vec4View vecs, MATHTYPE const maxLength, MATHTYPE const minLength)
+{
+	limit_length_impl<4>(vecs, maxLength, minLength);
+}
+}
@@ -0,0 +1,178 @@
+#ifndef VECTOR_SOA_HPP
+#define VECTOR_SOA_HPP
+
+#include "mathtype.hpp"
+#include "vector.hpp"
+#include <concepts>
+#include <cstddef>
+#include <span>
+#include <type_traits>
+#include <vector>
+
+namespace ZMathLib_Graphics {
+// Non-owning view of `size` 3-component vectors, component x of vector i is at x[i * stride] (same for y, z).
+// stride 1 views the separate lanes of a Vec3SoA. A span of Vec3 is viewed in place with stride 3, no copy.
+// T is MATHTYPE for a mutable view, MATHTYPE const for a read-only one.
+template <typename T>
+struct BasicVec3View {
+	using VecType = std::conditional_t<std::is_const_v<T>, Vec3 const, Vec3>;
+
+	T *x, *y, *z;
+	size_t size;
+	size_t stride;
+
+	BasicVec3View(T *x, T *y, T *z, size_t size, size_t stride=1)
+		: x(x), y(y), z(z), size(size), stride(stride) {}
+	// Views an array of Vec3 (std::vector, std::array, span...) in place
+	template <typename Range>
+	requires std::convertible_to<Range &&, std::span<VecType>>
+	BasicVec3View(Range &&vecs)
+	{
+		std::span<VecType> span(vecs);
+		T *base = reinterpret_cast<T *>(span.data());
+		x = base;
+		y = base + 1;
+		z = base + 2;
+		size = span.size();
+		stride = 3;
+	}
+	// Mutable views convert to read-only ones
+	template <typename U>
+	requires (std::is_const_v<T> && std::same_as<U, std::remove_const_t<T>>)
+	BasicVec3View(BasicVec3View<U> const &other)
+		: x(other.x), y(other.y), z(other.z), size(other.size), stride(other.stride) {}
+
+	T *component(unsigned int index) const
+	{
+		return index == 0 ? x : index == 1 ? y : z;
+	}
+	Vec3 get(size_t index) const
+	{
+		return Vec3(x[index * stride], y[index * stride], z[index * stride]);
+	}
+	void set(size_t index, Vec3 const &vec) const requires (!std::is_const_v<T>)
+	{
+		x[index * stride] = vec.x;
+		y[index * stride] = vec.y;
+		z[index * stride] = vec.z;
+	}
+};
+using Vec3View = BasicVec3View<MATHTYPE>;
+using Vec3ConstView = BasicVec3View<MATHTYPE const>;
+
+// Non-owning view of `size` 4-component vectors, see BasicVec3View. A span of Vec4 is viewed with stride 4.
+template <typename T>
+struct BasicVec4View {
+	using VecType = std::conditional_t<std::is_const_v<T>, Vec4 const, Vec4>;
+
+	T *x, *y, *z, *w;
+	size_t size;
+	size_t stride;
+
+	BasicVec4View(T *x, T *y, T *z, T *w, size_t size, size_t stride=1)
+		: x(x), y(y), z(z), w(w), size(size), stride(stride) {}
+	// Views an array of Vec4 (std::vector, std::array, span...) in place
+	template <typename Range>
+	requires std::convertible_to<Range &&, std::span<VecType>>
+	BasicVec4View(Range &&vecs)
+	{
+		std::span<VecType> span(vecs);
+		T *base = reinterpret_cast<T *>(span.data());
+		x = base;
+		y = base + 1;
+		z = base + 2;
+		w = base + 3;
+		size = span.size();
+		stride = 4;
+	}
+	// Mutable views convert to read-only ones
+	template <typename U>
+	requires (std::is_const_v<T> && std::same_as<U, std::remove_const_t<T>>)
+	BasicVec4View(BasicVec4View<U> const &other)
+		: x(other.x), y(other.y), z(other.z), w(other.w), size(other.size), stride(other.stride) {}
+
+	T *component(unsigned int index) const
+	{
+		return index == 0 ? x : index == 1 ? y : index == 2 ? z : w;
+	}
+	Vec4 get(size_t index) const
+	{
+		return Vec4(x[index * stride], y[index * stride], z[index * stride], w[index * stride]);
+	}
+	void set(size_t index, Vec4 const &vec) const requires (!std::is_const_v<T>)
+	{
+		x[index * stride] = vec.x;
+		y[index * stride] = vec.y;
+		z[index * stride] = vec.z;
+		w[index * stride] = vec.w;
+	}
+};
+using Vec4View = BasicVec4View<MATHTYPE>;
+using Vec4ConstView = BasicVec4View<MATHTYPE const>;
+
+// Structure-of-arrays storage for many Vec3, one contiguous lane per component.
+// Pass it wherever a Vec3View / Vec3ConstView is expected.
+struct Vec3SoA {
+	std::vector<MATHTYPE> x, y, z;
+
+	Vec3SoA() = default;
+	// `size` zero vectors
+	explicit Vec3SoA(size_t size);
+	// Copies the vectors into lanes
+	explicit Vec3SoA(Vec3ConstView vecs);
+
+	size_t size() const;
+	void resize(size_t size);
+	void push_back(Vec3 const &vec);
+	Vec3 get(size_t index) const;
+	void set(size_t index, Vec3 const &vec);
+	// Copies the vectors back out, out.size must equal size()
+	void copy_to(Vec3View out) const;
+
+	operator Vec3View();
+	operator Vec3ConstView() const;
+};
+
+// Structure-of-arrays storage for many Vec4, see Vec3SoA
+struct Vec4SoA {
+	std::vector<MATHTYPE> x, y, z, w;
+
+	Vec4SoA() = default;
+	// `size` zero vectors
+	explicit Vec4SoA(size_t size);
+	// Copies the vectors into lanes
+	explicit Vec4SoA(Vec4ConstView vecs);
+
+	size_t size() const;
+	void resize(size_t size);
+	void push_back(Vec4 const &vec);
+	Vec4 get(size_t index) const;
+	void set(size_t index, Vec4 const &vec);
+	// Copies the vectors back out, out.size must equal size()
+	void copy_to(Vec4View out) const;
+
+	operator Vec4View();
+	operator Vec4ConstView() const;
+};
+
+// Bulk versions of the Vec3/Vec4 methods, applied to every vector of a view.
+// An output may be the same view as an input, but not partially overlap it. Views and spans of different sizes throw std::invalid_argument.
+void dot(Vec3ConstView a, Vec3ConstView b, std::span<MATHTYPE> out);
+void dot(Vec4ConstView a, Vec4ConstView b, std::span<MATHTYPE> out);
+// out = a x b
+void cross(Vec3ConstView a, Vec3ConstView b, Vec3View out);
+void length(Vec3ConstView vecs, std::span<MATHTYPE> out);
+void length(Vec4ConstView vecs, std::span<MATHTYPE> out);
+void length_squared(Vec3ConstView vecs, std::span<MATHTYPE> out);
+void length_squared(Vec4ConstView vecs, std::span<MATHTYPE> out);
+void normalize(Vec3View vecs);
+void normalize(Vec4View vecs);
+// Clamps every component to [`min`, `max`]
+void clamp(Vec3View vecs, MATHTYPE const min, MATHTYPE const max);
+void clamp(Vec4View vecs, MATHTYPE const min, MATHTYPE const max);
+// Limits lengths to [`minLength`, `maxLength`]. Note that minLength is the 2nd argument
+void limit_length(Vec3View vecs, MATHTYPE const maxLength, MATHTYPE const minLength=0);
+void limit_length(Vec4View vecs, MATHTYPE const maxLength, MATHTYPE const minLength=0);
+}
+
+#endif